@@ -22,6 +22,8 @@
 #cmakedefine HAVE_STDLIB_H
 #cmakedefine HAVE_STRINGS_H
 #cmakedefine HAVE_STRING_H
+#cmakedefine HAVE_SYS_EPOLL_H
+#cmakedefine HAVE_SYS_MMAN_H
 #cmakedefine HAVE_SYS_SELECT_H
 #cmakedefine HAVE_SYS_SOCKET_H
 #cmakedefine HAVE_SYS_STATVFS_H
@@ -131,6 +133,8 @@
 #cmakedefine HAVE_VFORK
 #cmakedefine HAVE_VPRINTF
 #cmakedefine HAVE_GETIFADDRS
+#cmakedefine HAVE_ZSTD
+#cmakedefine HAVE_LZ4
 #cmakedefine HAVE_WORKING_FORK
 #cmakedefine HAVE_WORKING_VFORK
 #cmakedefine STRERROR_R_CHAR_P
@@ -217,6 +221,8 @@
 #cmakedefine NEED_DLFCN_WRAPPER
 #cmakedefine NEED_ICONV_TRANSLIT
 #cmakedefine QORE_RUNTIME_THREAD_STACK_TRACE
+#cmakedefine QORE_NODE_COALLOC
+#cmakedefine QORE_BIASED_REFS
 
 
 #cmakedefine ZONEINFO_LOCATION "@ZONEINFO_LOCATION@"
@@ -237,6 +237,22 @@ public:
     //! increments the reference count
     DLLEXPORT void ref() const;
 
+    //! returns the reference count
+    /** for nodes with biased reference counts, the references of the owner thread and of all other threads are added
+    */
+    DLLEXPORT int reference_count() const;
+
+    //! returns true if the reference count is 1
+    DLLEXPORT bool is_unique() const;
+
+#ifdef QORE_BIASED_REFS
+    //! releases a node that was queued with its owner thread; not exported in the library
+    /** merges the owner thread's references into the shared reference count and deletes the node if no references
+        remain; must be called in the owner thread or after the owner thread has exited
+    */
+    DLLLOCAL void brcReleaseQueued();
+#endif
+
     //! returns true if the object is reference-counted
     DLLLOCAL bool isReferenceCounted() const { return !there_can_be_only_one; }
 
@@ -332,6 +348,35 @@ protected:
     //! set to one for objects that need custom reference handlers
     bool custom_reference_handlers : 1;
 
+    // the biased reference count members are always present, so the object layout seen by modules does not depend
+    // on QORE_BIASED_REFS, which is only defined in the library's internal configuration
+
+    //! set for nodes whose reference count is biased towards the thread that created them
+    bool biased_refs : 1;
+
+    //! the ID of the thread that owns brc_refs; 0 once the owner's references have been merged into references
+    mutable std::atomic<unsigned> brc_owner;
+
+    //! references held by the owner thread; only updated by the owner thread, so no atomic read-modify-write is needed
+    /** with biased reference counts, the inherited reference count holds the references of all other threads and
+        the QORE_BRC_* flags
+    */
+    mutable std::atomic_int brc_refs;
+
+#ifdef QORE_BIASED_REFS
+    //! initializes the biased reference counts
+    DLLLOCAL void brcInit();
+
+    //! increments the biased reference count
+    DLLLOCAL void brcRef() const;
+
+    //! decrements the biased reference count; returns true if the node must be deleted
+    DLLLOCAL bool brcDeref() const;
+
+    //! merges the owner thread's references into the shared reference count; returns true if the node must be deleted
+    DLLLOCAL bool brcMerge(bool dequeue) const;
+#endif
+
     //! default destructor does nothing
     /**
         The destructor is protected because it should not be called directly, which also means that these objects cannot normally be created on the stack.  They are referenced counted, and the deref() function should be used to decrement the reference count rather than using the delete operator.  Because the QoreObject class at least could throw a Qore Exception when it is deleted, AbstractQoreNode::deref() takes an ExceptionSink pointer argument by default as well.
@@ -35,8 +35,13 @@
 
 #include <qore/AbstractQoreNode.h>
 
+class QoreMemoryMap;
+
 //! holds arbitrary binary data
 /** this class is implemented simply as a pointer and a length indicator
+
+    Objects can also be read-only views of a memory-mapped file, in which case the data is not owned by the object;
+    the data of a view is copied to memory owned by the object before it is modified
  */
 class BinaryNode : public SimpleValueQoreNode {
 private:
@@ -44,6 +49,10 @@ private:
     void *ptr;
     //! size of the memory block owned by the object
     qore_size_t len;
+    //! the memory mapping for views; the data is not owned by the object if this is set
+    /** this member changed the size of the object; added in module API 0.23
+     */
+    QoreMemoryMap* map = nullptr;
 
     // not yet implemented
     DLLLOCAL BinaryNode(const BinaryNode&);
@@ -56,6 +65,12 @@ protected:
     DLLLOCAL void checkOffset(qore_offset_t& offset) const;
     DLLLOCAL void checkOffset(qore_offset_t& offset, qore_offset_t& num) const;
 
+    //! copies the data of a view to memory owned by the object
+    DLLLOCAL void detach();
+
+    //! makes an empty object a view of the given range of a memory mapping
+    DLLLOCAL void setView(QoreMemoryMap* m, const void* p, qore_size_t size);
+
 public:
     //! creates the object
     /** @param p a pointer to the memory, the BinaryNode object takes over ownership of this pointer
@@ -63,6 +78,14 @@ public:
     */
     DLLEXPORT BinaryNode(void *p = 0, qore_size_t size = 0);
 
+    //! creates a read-only view of memory-mapped data; a reference to the mapping is acquired
+    DLLLOCAL BinaryNode(QoreMemoryMap* m, const void* p, qore_size_t size);
+
+    //! returns true if the object is a read-only view of a memory-mapped file
+    /** @since %Qore 0.9
+     */
+    DLLEXPORT bool isView() const;
+
     //! returns false unless perl-boolean-evaluation is enabled, in which case it returns false only when empty
     /** @return false unless perl-boolean-evaluation is enabled, in which case it returns false only when empty
         */
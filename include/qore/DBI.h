@@ -54,6 +54,7 @@
 #define DBI_CAP_HAS_DESCRIBE             (1 << 15) //!< supports the describe API
 #define DBI_CAP_HAS_ARRAY_BIND           (1 << 16) //!< supports binding arrays by value for bulk DML operations
 #define DBI_CAP_HAS_RESULTSET_OUTPUT     (1 << 17) //!< supports the "resultset" placeholder buffer specification
+#define DBI_CAP_HAS_COLUMNAR_FETCH       (1 << 18) //!< fills SQLColumnBlock objects directly when fetching result sets (set automatically by the Qore library)
 
 #define BN_PLACEHOLDER  0
 #define BN_VALUE        1
@@ -94,8 +95,9 @@
 #define QDBI_METHOD_DESCRIBE                 31
 #define QDBI_METHOD_STMT_FREE                32
 #define QDBI_METHOD_STMT_EXEC_DESCRIBE       33
+#define QDBI_METHOD_STMT_FETCH_BLOCK         34
 
-#define QDBI_VALID_CODES 33
+#define QDBI_VALID_CODES 34
 
 /* DBI EVENT Types
    all DBI events must have the following keys:
@@ -113,6 +115,7 @@ class QoreListNode;
 class QoreHashNode;
 class QoreNamespace;
 class SQLStatement;
+class SQLColumnBlock;
 
 // DBI method signatures - note that only get_client_version uses a "const Datasource"
 // the others do not so that automatic reconnects can be supported (which will normally
@@ -263,6 +266,17 @@ typedef QoreHashNode* (*q_dbi_stmt_fetch_row_t)(SQLStatement* stmt, ExceptionSin
 typedef QoreHashNode* (*q_dbi_stmt_fetch_columns_t)(SQLStatement* stmt, int rows, ExceptionSink* xsink);
 typedef QoreListNode* (*q_dbi_stmt_fetch_rows_t)(SQLStatement* stmt, int rows, ExceptionSink* xsink);
 typedef bool (*q_dbi_stmt_next_t)(SQLStatement* stmt, ExceptionSink* xsink);
+
+//! fetch a block of rows into typed column buffers
+/** on the first call for a result set, the block passed is empty and the driver must define the columns with
+    SQLColumnBlock::addColumn(); then the driver appends one value to each column for each row retrieved
+    @param stmt the statement
+    @param block the block to fill
+    @param rows the maximum number of rows to retrieve; if <= 0 then all available rows are retrieved
+    @param xsink if any errors occur, error information should be added to this object
+    @return 0 for OK, -1 for error (exception raised)
+ */
+typedef int (*q_dbi_stmt_fetch_block_t)(SQLStatement* stmt, SQLColumnBlock& block, int rows, ExceptionSink* xsink);
 typedef int (*q_dbi_stmt_close_t)(SQLStatement* stmt, ExceptionSink* xsink);
 
 typedef int (*q_dbi_option_set_t)(Datasource* ds, const char* opt, const QoreValue val, ExceptionSink* xsink);
@@ -331,6 +345,8 @@ public:
    DLLEXPORT void add(int code, q_dbi_stmt_fetch_rows_t method);
    // covers next
    DLLEXPORT void add(int code, q_dbi_stmt_next_t method);
+   // covers fetch_block
+   DLLEXPORT void add(int code, q_dbi_stmt_fetch_block_t method);
 
    // covers set option
    DLLEXPORT void add(int code, q_dbi_option_set_t method);
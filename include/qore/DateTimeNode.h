@@ -83,6 +83,16 @@ protected:
     DLLEXPORT virtual ~DateTimeNode();
 
 public:
+    //! allocates memory for the object from the calling thread's slab cache
+    /** @since %Qore 0.9
+     */
+    DLLEXPORT static void* operator new(size_t size);
+
+    //! returns the object's memory to the calling thread's slab cache
+    /** @since %Qore 0.9
+     */
+    DLLEXPORT static void operator delete(void* p, size_t size);
+
     //! constructor for an empty object
     /**
         @param r sets the "relative" flag for the object
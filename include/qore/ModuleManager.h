@@ -43,10 +43,10 @@
  */
 
 #define QORE_MODULE_API_MAJOR 0  //!< the major number of the Qore module API implemented
-#define QORE_MODULE_API_MINOR 22 //!< the minor number of the Qore module API implemented
+#define QORE_MODULE_API_MINOR 23 //!< the minor number of the Qore module API implemented
 
 #define QORE_MODULE_COMPAT_API_MAJOR 0  //!< the major number of the earliest recommended Qore module API
-#define QORE_MODULE_COMPAT_API_MINOR 22 //!< the minor number of the earliest recommended Qore module API
+#define QORE_MODULE_COMPAT_API_MINOR 23 //!< the minor number of the earliest recommended Qore module API
 
 //! element of qore_mod_api_list;
 struct qore_mod_api_compat_s {
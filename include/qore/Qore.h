@@ -88,6 +88,7 @@ DLLEXPORT extern QoreCounter thread_counter;
 #include <qore/DBI.h>
 #include <qore/Datasource.h>
 #include <qore/SQLStatement.h>
+#include <qore/SQLColumnBlock.h>
 #include <qore/QoreClass.h>
 #include <qore/ScopeGuard.h>
 #include <qore/SystemEnvironment.h>
@@ -481,6 +481,21 @@ public:
    */
    DLLEXPORT BinaryNode *readBinary(qore_offset_t size, int timeout_ms, ExceptionSink *xsink);
 
+   //! returns a read-only view of the file's data without copying it (caller owns the reference count returned)
+   /** The file is mapped into memory on the first call; the mapping is kept until the file is closed, and the views
+       returned keep it valid even after the file is closed.  The file is mapped again if the requested range is past
+       the end of the current mapping.
+
+       @param offset the byte offset of the view in the file
+       @param size the size of the view in bytes; -1 means up to the end of the file
+       @param xsink if an error occurs, the Qore-language exception info will be added here
+
+       @return the view of the file data (caller owns the reference count returned) or 0 if an error occured
+
+       @since %Qore 0.9
+   */
+   DLLEXPORT BinaryNode* mapBinary(qore_offset_t offset, qore_offset_t size, ExceptionSink* xsink);
+
    //! reads data from the file
    /** A Qore-language exception can be thrown if the file is not opened
        @param ptr the destination buffer
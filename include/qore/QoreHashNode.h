@@ -90,6 +90,16 @@ protected:
     DLLEXPORT virtual ~QoreHashNode();
 
 public:
+    //! allocates memory for the object from the calling thread's slab cache
+    /** @since %Qore 0.9
+     */
+    DLLEXPORT static void* operator new(size_t size);
+
+    //! returns the object's memory to the calling thread's slab cache
+    /** @since %Qore 0.9
+     */
+    DLLEXPORT static void operator delete(void* p, size_t size);
+
     //! creates an empty hash
     DLLEXPORT QoreHashNode();
 
@@ -362,6 +362,30 @@ DLLEXPORT BinaryNode* qore_bzip2(void* ptr, unsigned long len, int level, Except
 DLLEXPORT QoreStringNode* qore_bunzip2_to_string(const BinaryNode* bin, const QoreEncoding* enc, ExceptionSink* xsink);
 //! decompresses bzip2 data to a binary
 DLLEXPORT BinaryNode* qore_bunzip2_to_binary(const BinaryNode* bin, ExceptionSink* xsink);
+//! compresses data with zstd; raises a \c MISSING-FEATURE-ERROR exception if zstd is not supported
+/** @since %Qore 0.9.0
+*/
+DLLEXPORT BinaryNode* qore_zstd(const void* ptr, unsigned long len, int level, ExceptionSink* xsink);
+//! decompresses zstd data to a string
+/** @since %Qore 0.9.0
+*/
+DLLEXPORT QoreStringNode* qore_unzstd_to_string(const BinaryNode* bin, const QoreEncoding* enc, ExceptionSink* xsink);
+//! decompresses zstd data to a binary
+/** @since %Qore 0.9.0
+*/
+DLLEXPORT BinaryNode* qore_unzstd_to_binary(const BinaryNode* bin, ExceptionSink* xsink);
+//! compresses data in the lz4 frame format; raises a \c MISSING-FEATURE-ERROR exception if lz4 is not supported
+/** @since %Qore 0.9.0
+*/
+DLLEXPORT BinaryNode* qore_lz4(const void* ptr, unsigned long len, int level, ExceptionSink* xsink);
+//! decompresses lz4 frame data to a string
+/** @since %Qore 0.9.0
+*/
+DLLEXPORT QoreStringNode* qore_unlz4_to_string(const BinaryNode* bin, const QoreEncoding* enc, ExceptionSink* xsink);
+//! decompresses lz4 frame data to a binary
+/** @since %Qore 0.9.0
+*/
+DLLEXPORT BinaryNode* qore_unlz4_to_binary(const BinaryNode* bin, ExceptionSink* xsink);
 
 //! parses a string of base64-encoded data and returns a BinaryNode
 DLLEXPORT BinaryNode* parseBase64(const char* buf, int len, ExceptionSink* xsink);
@@ -417,6 +441,10 @@ DLLEXPORT const char* tz_get_region_name(const AbstractQoreZoneInfo* tz);
 #define QORE_OPT_MD2                     "openssl md2"
 //! option: dss & dss1 algorithms supported (depends on openssl used to compile qore)
 #define QORE_OPT_DSS                     "openssl dss"
+//! option: zstd compression supported (depends on the libraries available when qore was compiled)
+#define QORE_OPT_ZSTD                    "zstd"
+//! option: lz4 compression supported (depends on the libraries available when qore was compiled)
+#define QORE_OPT_LZ4                     "lz4"
 //! option: TermIOS class available
 #define QORE_OPT_TERMIOS                 "termios"
 //! option: file locking
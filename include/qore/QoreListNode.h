@@ -89,6 +89,16 @@ protected:
     DLLLOCAL virtual QoreValue evalImpl(bool& needs_deref, ExceptionSink* xsink) const;
 
 public:
+    //! allocates memory for the object from the calling thread's slab cache
+    /** @since %Qore 0.9
+     */
+    DLLEXPORT static void* operator new(size_t size);
+
+    //! returns the object's memory to the calling thread's slab cache
+    /** @since %Qore 0.9
+     */
+    DLLEXPORT static void operator delete(void* p, size_t size);
+
     //! create an empty list
     DLLEXPORT QoreListNode();
 
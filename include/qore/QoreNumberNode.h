@@ -78,6 +78,16 @@ protected:
     DLLLOCAL QoreNumberNode(struct qore_number_private* p);
 
 public:
+    //! allocates memory for the object from the calling thread's slab cache
+    /** @since %Qore 0.9
+     */
+    DLLEXPORT static void* operator new(size_t size);
+
+    //! returns the object's memory to the calling thread's slab cache
+    /** @since %Qore 0.9
+     */
+    DLLEXPORT static void operator delete(void* p, size_t size);
+
     //! creates a new number value from the node, if not possible then the new number will be assigned 0
     DLLEXPORT QoreNumberNode(const QoreValue n);
 
@@ -48,6 +48,7 @@ class QoreSocketObject : public AbstractPrivateData {
 private:
    friend class my_socket_priv;
    friend struct qore_httpclient_priv;
+   friend class QoreSocketPoller;
 
    DLLLOCAL QoreSocketObject(QoreSocket* s, QoreSSLCertificate* cert = 0, QoreSSLPrivateKey* pk = 0);
 
@@ -65,6 +65,16 @@ protected:
     DLLEXPORT virtual ~QoreStringNode();
 
 public:
+    //! allocates memory for the object from the calling thread's slab cache
+    /** @since %Qore 0.9
+     */
+    DLLEXPORT static void* operator new(size_t size);
+
+    //! returns the object's memory to the calling thread's slab cache
+    /** @since %Qore 0.9
+     */
+    DLLEXPORT static void operator delete(void* p, size_t size);
+
     //! creates an empty string and assigns the default encoding QCS_DEFAULT
     DLLEXPORT QoreStringNode();
 
@@ -0,0 +1,119 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    SQLColumnBlock.h
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#ifndef _QORE_SQLCOLUMNBLOCK_H
+#define _QORE_SQLCOLUMNBLOCK_H
+
+//! storage types for columns in an SQLColumnBlock
+enum sql_column_type_e : unsigned char {
+    SQL_COL_INT = 0,      //!< 64-bit integer values
+    SQL_COL_FLOAT = 1,    //!< double-precision floating-point values
+    SQL_COL_BOOL = 2,     //!< boolean values
+    SQL_COL_DATE = 3,     //!< absolute date/time values stored as epoch offsets with a time zone
+    SQL_COL_STRING = 4,   //!< strings stored in a single buffer per column, all in the column's encoding
+    SQL_COL_ANY = 5,      //!< arbitrary Qore values
+};
+
+//! a block of query results stored in typed column buffers
+/** DBI drivers that register the QDBI_METHOD_STMT_FETCH_BLOCK method fill this object directly from their native
+    result buffers; column values are only converted to Qore values when accessed.
+
+    Drivers must first define all columns with addColumn() and then append exactly one value (or SQL NULL) to each
+    column for each row retrieved.
+
+    @since %Qore 0.9
+ */
+class SQLColumnBlock {
+    friend class QoreSQLColumnBlock;
+
+private:
+    struct sql_column_block_private* priv; // private implementation
+
+    // not implemented
+    DLLLOCAL SQLColumnBlock(const SQLColumnBlock&);
+    DLLLOCAL SQLColumnBlock& operator=(const SQLColumnBlock&);
+
+public:
+    DLLLOCAL SQLColumnBlock();
+
+    //! the block must be cleared with clear() before it is destroyed if it holds any SQL_COL_ANY values
+    DLLLOCAL ~SQLColumnBlock();
+
+    //! defines a new column and returns its index
+    /** @param name the column name
+        @param type the storage type for the column
+        @param enc the encoding for strings in SQL_COL_STRING columns
+        @param xsink if the column name is already defined, a \c DBI-FETCH-BLOCK-ERROR exception is raised here
+
+        @return the index of the new column or -1 if an exception was raised
+     */
+    DLLEXPORT int addColumn(const char* name, sql_column_type_e type, const QoreEncoding* enc, ExceptionSink* xsink);
+
+    //! returns the number of columns defined
+    DLLEXPORT unsigned columnCount() const;
+
+    //! returns the number of rows in the first column
+    DLLEXPORT size_t size() const;
+
+    //! preallocates space for the given number of rows in each column
+    DLLEXPORT void reserve(size_t rows);
+
+    //! appends an SQL NULL value to the given column
+    DLLEXPORT void appendNull(unsigned col);
+
+    //! appends an integer value to an SQL_COL_INT column
+    DLLEXPORT void appendInt(unsigned col, int64 v);
+
+    //! appends a floating-point value to an SQL_COL_FLOAT column
+    DLLEXPORT void appendFloat(unsigned col, double v);
+
+    //! appends a boolean value to an SQL_COL_BOOL column
+    DLLEXPORT void appendBool(unsigned col, bool v);
+
+    //! appends an absolute date/time value to an SQL_COL_DATE column
+    /** @param col the column index
+        @param seconds the number of seconds from January 1, 1970Z
+        @param us the microseconds portion of the time
+        @param zone time zone for the date/time value, 0 = UTC, @see currentTZ()
+     */
+    DLLEXPORT void appendDate(unsigned col, int64 seconds, int us, const AbstractQoreZoneInfo* zone);
+
+    //! appends a string to an SQL_COL_STRING column; the string must be in the column's encoding
+    DLLEXPORT void appendString(unsigned col, const char* str, size_t len);
+
+    //! appends an arbitrary value to an SQL_COL_ANY column; the block takes over the reference to the value
+    DLLEXPORT void appendValue(unsigned col, QoreValue v);
+
+    //! removes all columns and rows from the block
+    DLLEXPORT void clear(ExceptionSink* xsink);
+};
+
+#endif
@@ -131,4 +131,19 @@ DLLEXPORT extern const TypedHashDecl* hashdeclStatementInfo;
 //! NetIfInfo hashdecl
 DLLEXPORT extern const TypedHashDecl* hashdeclNetIfInfo;
 
+//! RegexCacheInfo hashdecl
+DLLEXPORT extern const TypedHashDecl* hashdeclRegexCacheInfo;
+
+//! ThreadListInfo hashdecl
+DLLEXPORT extern const TypedHashDecl* hashdeclThreadListInfo;
+
+//! VariantCacheInfo hashdecl
+DLLEXPORT extern const TypedHashDecl* hashdeclVariantCacheInfo;
+
+//! MemorySizeClassInfo hashdecl
+DLLEXPORT extern const TypedHashDecl* hashdeclMemorySizeClassInfo;
+
+//! MemoryStats hashdecl
+DLLEXPORT extern const TypedHashDecl* hashdeclMemoryStats;
+
 #endif
@@ -39,11 +39,25 @@ public:
    static constexpr const char *ALG_ZLIB = "zlib";
    static constexpr const char *ALG_GZIP = "gzip";
    static constexpr const char *ALG_BZIP2 = "bzip2";
+   static constexpr const char *ALG_ZSTD = "zstd";
+   static constexpr const char *ALG_LZ4 = "lz4";
 
    static constexpr int64 LEVEL_DEFAULT = -1;
 
+   //! option giving the number of zstd compression worker threads
+   static constexpr const char *OPT_WORKERS = "workers";
+   //! option giving a binary zstd dictionary
+   static constexpr const char *OPT_DICTIONARY = "dictionary";
+
    DLLLOCAL static Transform *getCompressor(const QoreStringNode *alg, int64 level, ExceptionSink *xsink);
+   DLLLOCAL static Transform *getCompressor(const QoreStringNode *alg, int64 level, const QoreHashNode *opts, ExceptionSink *xsink);
    DLLLOCAL static Transform *getDecompressor(const QoreStringNode *alg, ExceptionSink *xsink);
+   DLLLOCAL static Transform *getDecompressor(const QoreStringNode *alg, const QoreHashNode *opts, ExceptionSink *xsink);
+
+   //! runs all of the given data through the transformation and returns the complete output
+   /** the transformation is finished after the data has been processed
+    */
+   DLLLOCAL static BinaryNode *transformData(Transform *t, const void *ptr, qore_size_t len, ExceptionSink *xsink);
 };
 
 #endif // _QORE_COMPRESSIONTRANSFORMS_H
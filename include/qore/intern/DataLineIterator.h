@@ -36,6 +36,7 @@
 #include <errno.h>
 
 #include "qore/intern/StringInputStream.h"
+#include "qore/intern/BinaryInputStream.h"
 #include "qore/intern/InputStreamLineIterator.h"
 
 /**
@@ -46,6 +47,19 @@ public:
     DLLLOCAL DataLineIterator(ExceptionSink* xsink, const QoreStringNode* n_str, const QoreStringNode* n_eol = 0, bool n_trim = true) :
         src(0),
         str(n_str->stringRefSelf()),
+        bin(0),
+        enc(n_str->getEncoding()),
+        eol(n_eol ? n_eol->stringRefSelf() : 0),
+        trim(n_trim) {
+        doReset(xsink);
+    }
+
+    //! iterates binary data in place, so views returned by ReadOnlyFile::mapBinary() are not copied
+    DLLLOCAL DataLineIterator(ExceptionSink* xsink, const BinaryNode* n_bin, const QoreEncoding* n_enc, const QoreStringNode* n_eol = 0, bool n_trim = true) :
+        src(0),
+        str(0),
+        bin(static_cast<BinaryNode*>(n_bin->refSelf())),
+        enc(n_enc),
         eol(n_eol ? n_eol->stringRefSelf() : 0),
         trim(n_trim) {
         doReset(xsink);
@@ -53,7 +67,9 @@ public:
 
     DLLLOCAL DataLineIterator(ExceptionSink* xsink, const DataLineIterator& old) :
         src(0),
-        str(old.str->stringRefSelf()),
+        str(old.str ? old.str->stringRefSelf() : 0),
+        bin(old.bin ? static_cast<BinaryNode*>(old.bin->refSelf()) : 0),
+        enc(old.enc),
         eol(old.eol ? old.eol->stringRefSelf() : 0),
         trim(old.trim) {
         doReset(xsink);
@@ -109,15 +125,23 @@ public:
 
 private:
     DLLLOCAL void doReset(ExceptionSink* xsink) {
-        if (!str->getEncoding()->isAsciiCompat())
-            src = new InputStreamLineIterator(xsink, new EncodingConversionInputStream(new StringInputStream(*str), str->getEncoding(), QCS_UTF8, xsink), QCS_UTF8, *eol, trim);
+        InputStream* is;
+        if (bin)
+            is = new BinaryInputStream(static_cast<BinaryNode*>(bin->refSelf()));
+        else
+            is = new StringInputStream(*str);
+
+        if (!enc->isAsciiCompat())
+            src = new InputStreamLineIterator(xsink, new EncodingConversionInputStream(is, enc, QCS_UTF8, xsink), QCS_UTF8, *eol, trim);
         else
-            src = new InputStreamLineIterator(xsink, new StringInputStream(*str), str->getEncoding(), *eol, trim);
+            src = new InputStreamLineIterator(xsink, is, enc, *eol, trim);
     }
 
 private:
     SimpleRefHolder<InputStreamLineIterator> src;
     SimpleRefHolder<QoreStringNode> str;
+    SimpleRefHolder<BinaryNode> bin;
+    const QoreEncoding* enc;
     SimpleRefHolder<QoreStringNode> eol;
     bool trim;
 };
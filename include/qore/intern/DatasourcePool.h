@@ -226,6 +226,10 @@ public:
         return this;
     }
 
+    DLLLOCAL virtual int helperGetCapabilitiesImpl() const {
+        return getCapabilities();
+    }
+
     // implementing DatasourceStatementHelper virtual functions
     DLLLOCAL virtual void helperDestructorImpl(QoreSQLStatement* s, ExceptionSink* xsink) {
         deref(xsink);
@@ -55,11 +55,17 @@ public:
       return helperRefSelfImpl();
    }
 
+   // returns the capabilities of the DBI driver
+   DLLLOCAL int helperGetCapabilities() const {
+      return helperGetCapabilitiesImpl();
+   }
+
    // must dereference the datasource-providing object
    virtual void helperDestructorImpl(QoreSQLStatement* s, ExceptionSink* xsink) = 0;
    virtual Datasource* helperStartActionImpl(ExceptionSink* xsink, bool& new_transaction) = 0;
    virtual Datasource* helperEndActionImpl(char cmd, bool new_transaction, ExceptionSink* xsink) = 0;
    virtual DatasourceStatementHelper* helperRefSelfImpl() = 0;
+   virtual int helperGetCapabilitiesImpl() const = 0;
 
 };
 
@@ -41,6 +41,8 @@ private:
     bool is_declaration;
     bool is_parse_declaration;
 
+    friend class QoreBytecodeCompiler;
+
     DLLLOCAL virtual int execImpl(QoreValue& return_value, ExceptionSink* xsink);
     DLLLOCAL virtual int parseInitImpl(LocalVar* oflag, int pflag = 0);
 
@@ -41,6 +41,7 @@
 #include <vector>
 
 #include "qore/intern/QoreListNodeEvalOptionalRefHolder.h"
+#include "qore/intern/QoreVariantCache.h"
 
 class qore_class_private;
 
@@ -621,6 +622,9 @@ protected:
 
     const QoreTypeInfo* nn_uniqueReturnType = nullptr;
 
+    // runtime variant matches
+    mutable QoreVariantCache vcache;
+
     DLLLOCAL void parseCheckReturnType() {
         if (parse_rt_done)
             return;
@@ -848,6 +852,7 @@ public:
 
     DLLLOCAL void addAncestor(QoreFunction* ancestor, ClassAccess access) {
         ilist.push_back(INode(ancestor, access));
+        vcache.clear();
     }
 
     DLLLOCAL void addNewAncestor(QoreFunction* ancestor, ClassAccess access) {
@@ -855,6 +860,7 @@ public:
             if ((*i).func == ancestor)
                 return;
         ilist.push_back(INode(ancestor, access));
+        vcache.clear();
     }
 
     // resolves all types in signatures and return types in pending variants; called during the "parseInit" phase
@@ -35,10 +35,40 @@
 #include <errno.h>
 #include <iconv.h>
 
+#include <map>
+#include <vector>
+
+// maximum number of idle conversion descriptors kept for each encoding pair
+#define QORE_ICONV_POOL_MAX 16
+
+//! Pool of reusable iconv conversion descriptors keyed by the target and source encodings.
+class IconvPool {
+public:
+   DLLLOCAL ~IconvPool();
+
+   //! Returns an idle descriptor for the given encodings or (iconv_t) -1 if none is available.
+   DLLLOCAL iconv_t get(const QoreEncoding *to, const QoreEncoding *from);
+
+   //! Returns a descriptor in the initial conversion state to the pool; it is closed if the pool is full.
+   DLLLOCAL void put(const QoreEncoding *to, const QoreEncoding *from, iconv_t c);
+
+private:
+   typedef std::map<std::pair<const QoreEncoding *, const QoreEncoding *>, std::vector<iconv_t>> iconv_map_t;
+
+   QoreThreadLock m;
+   iconv_map_t pool;
+};
+
+DLLLOCAL extern IconvPool qore_iconv_pool;
+
 class IconvHelper {
 
 public:
    DLLLOCAL IconvHelper(const QoreEncoding *to, const QoreEncoding *from, ExceptionSink *xsink) : to(to), from(from) {
+      c = qore_iconv_pool.get(to, from);
+      if (c != (iconv_t) -1) {
+         return;
+      }
 #ifdef NEED_ICONV_TRANSLIT
       QoreString to_code(const_cast<char *>(to->getCode()));
       to_code.concat("//TRANSLIT");
@@ -58,7 +88,9 @@ public:
 
    DLLLOCAL ~IconvHelper() {
       if (c != (iconv_t) -1) {
-         iconv_close(c);
+         // reset the conversion state before the descriptor is reused
+         iconv_adapter(::iconv, c, nullptr, nullptr, nullptr, nullptr);
+         qore_iconv_pool.put(to, from, c);
       }
    }
 
@@ -51,6 +51,8 @@ private:
     StatementBlock* else_code;
     LVList* lvars = nullptr;
 
+    friend class QoreBytecodeCompiler;
+
     DLLLOCAL virtual int execImpl(QoreValue& return_value, ExceptionSink* xsink);
     DLLLOCAL virtual int parseInitImpl(LocalVar* oflag, int pflag = 0);
 };
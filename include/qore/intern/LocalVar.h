@@ -336,16 +336,23 @@ private:
       parse_assigned = false;
    const QoreTypeInfo* typeInfo;
    const QoreTypeInfo* refTypeInfo;
+   // the slot of the variable in the local variable frame as of the last instantiation; -1 = unknown
+   mutable std::atomic<int> slot;
 
    DLLLOCAL LocalVarValue* get_var() const {
-      return thread_find_lvar(name.c_str());
+      return thread_find_lvar(name.c_str(), slot.load(std::memory_order_relaxed));
+   }
+
+   DLLLOCAL void setSlot(int s) const {
+      if (s != slot.load(std::memory_order_relaxed))
+         slot.store(s, std::memory_order_relaxed);
    }
 
 public:
-   DLLLOCAL LocalVar(const char* n_name, const QoreTypeInfo* ti) : name(n_name), typeInfo(ti), refTypeInfo(QoreTypeInfo::getReferenceTarget(ti)) {
+   DLLLOCAL LocalVar(const char* n_name, const QoreTypeInfo* ti) : name(n_name), typeInfo(ti), refTypeInfo(QoreTypeInfo::getReferenceTarget(ti)), slot(-1) {
    }
 
-   DLLLOCAL LocalVar(const LocalVar& old) : name(old.name), closure_use(old.closure_use), parse_assigned(old.parse_assigned), typeInfo(old.typeInfo), refTypeInfo(old.refTypeInfo) {
+   DLLLOCAL LocalVar(const LocalVar& old) : name(old.name), closure_use(old.closure_use), parse_assigned(old.parse_assigned), typeInfo(old.typeInfo), refTypeInfo(old.refTypeInfo), slot(-1) {
    }
 
    DLLLOCAL ~LocalVar() {
@@ -377,7 +384,9 @@ public:
       //printd(5, "LocalVar::instantiateIntern(%s, %d) this: %p '%s' value closure_use: %s pgm: %p val: %s type: '%s' rti: '%s'\n", nval.getTypeName(), assign, this, name.c_str(), closure_use ? "true" : "false", getProgram(), nval.getTypeName(), QoreTypeInfo::getName(typeInfo), QoreTypeInfo::getName(refTypeInfo));
 
       if (!closure_use) {
-         LocalVarValue* val = thread_instantiate_lvar();
+         int s;
+         LocalVarValue* val = thread_instantiate_lvar(s);
+         setSlot(s);
          val->set(name.c_str(), typeInfo, nval, assign, false);
       }
       else
@@ -387,7 +396,9 @@ public:
    DLLLOCAL void instantiateSelf(QoreObject* value) const {
       printd(5, "LocalVar::instantiateSelf(%p) this: %p '%s'\n", value, this, name.c_str());
       if (!closure_use) {
-         LocalVarValue* val = thread_instantiate_lvar();
+         int s;
+         LocalVarValue* val = thread_instantiate_lvar(s);
+         setSlot(s);
          val->set(name.c_str(), typeInfo, value, true, true);
       }
       else {
@@ -0,0 +1,81 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QC_SQLColumnBlock.h
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#ifndef _QORE_CLASS_SQLCOLUMNBLOCK_H
+#define _QORE_CLASS_SQLCOLUMNBLOCK_H
+
+#include "qore/intern/sql_column_block_private.h"
+
+DLLEXPORT extern qore_classid_t CID_SQLCOLUMNBLOCK;
+DLLLOCAL extern QoreClass* QC_SQLCOLUMNBLOCK;
+DLLLOCAL QoreClass* initSQLColumnBlockClass(QoreNamespace& ns);
+
+// the private data for Qore SQLColumnBlock objects; blocks are not modified once they have been filled
+class QoreSQLColumnBlock : public AbstractPrivateData, public SQLColumnBlock {
+public:
+    // creates a block from a hash of lists as returned by SQLStatement::fetchColumns()
+    DLLLOCAL static QoreSQLColumnBlock* fromColumns(const QoreHashNode* h, ExceptionSink* xsink);
+
+    using AbstractPrivateData::deref;
+    DLLLOCAL virtual void deref(ExceptionSink* xsink) {
+        if (ROdereference()) {
+            clear(xsink);
+            delete this;
+        }
+    }
+
+    // verifies that all columns have the same number of rows
+    DLLLOCAL int check(ExceptionSink* xsink) const;
+
+    // returns the index of the given column or raises an exception
+    DLLLOCAL int getColumnIndex(const char* name, ExceptionSink* xsink) const;
+
+    DLLLOCAL bool hasColumn(const char* name) const {
+        return priv->find(name) >= 0;
+    }
+
+    DLLLOCAL QoreListNode* getColumnNames() const;
+    DLLLOCAL QoreHashNode* getColumnTypes() const;
+
+    DLLLOCAL QoreListNode* getColumn(const char* name, ExceptionSink* xsink) const;
+    DLLLOCAL QoreHashNode* getColumns() const;
+
+    DLLLOCAL QoreValue getValue(const char* name, int64 row, ExceptionSink* xsink) const;
+    DLLLOCAL QoreHashNode* getRow(int64 row, ExceptionSink* xsink) const;
+    DLLLOCAL QoreListNode* getRowValues(int64 row, ExceptionSink* xsink) const;
+
+    DLLLOCAL static const char* getTypeName(sql_column_type_e type);
+
+protected:
+    DLLLOCAL int checkRow(int64 row, ExceptionSink* xsink) const;
+};
+
+#endif
@@ -0,0 +1,92 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreBiasedRefs.h
+
+    biased reference counts for simple value nodes
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#ifndef _QORE_QOREBIASEDREFS_H
+
+#define _QORE_QOREBIASEDREFS_H
+
+#ifdef QORE_BIASED_REFS
+
+#include <atomic>
+
+// with biased reference counts, the low bits of the shared reference count are flags
+// set when the owner thread's references have been merged into the shared reference count
+#define QORE_BRC_MERGED 1
+// set when the node has been queued with its owner thread
+#define QORE_BRC_QUEUED 2
+// the value of a single reference in the shared reference count
+#define QORE_BRC_ONE 4
+
+// returns the number of references in a shared reference count
+#define QORE_BRC_COUNT(v) (((v) & ~(QORE_BRC_ONE - 1)) / QORE_BRC_ONE)
+
+// the owner ID of a thread that has not created any nodes with biased reference counts yet
+#define QORE_BRC_UNREGISTERED 0xffffffffu
+// the owner ID of a thread whose queue has been released because the thread is exiting
+#define QORE_BRC_EXITED 0xfffffffeu
+
+//! the owner ID of the calling thread
+DLLLOCAL extern thread_local unsigned q_brc_tid;
+
+//! set when nodes have been queued with the calling thread
+DLLLOCAL extern thread_local std::atomic<bool>* q_brc_pending;
+
+//! registers the calling thread as an owner of nodes and returns its owner ID
+/** owner IDs of exited threads are reused; nodes still owned by an exited thread are adopted by the new thread
+ */
+DLLLOCAL unsigned q_brc_register_thread();
+
+//! releases all nodes queued with the calling thread
+DLLLOCAL void q_brc_release_queue();
+
+//! queues a node whose shared reference count has dropped below zero with its owner thread
+/** the owner's references must be merged before it can be decided if the node can be deleted; if the owner thread
+    has exited, the node is released immediately
+ */
+DLLLOCAL void q_brc_enqueue(AbstractQoreNode* n, unsigned owner);
+
+//! returns the owner ID for a new node created in the calling thread and releases any nodes queued with the thread
+/** returns 0 if the thread is exiting and the node must be created with a merged reference count
+ */
+static inline unsigned q_brc_owner() {
+    unsigned tid = q_brc_tid;
+    if (tid == QORE_BRC_UNREGISTERED)
+        return q_brc_register_thread();
+    if (q_brc_pending->load(std::memory_order_relaxed))
+        q_brc_release_queue();
+    return tid == QORE_BRC_EXITED ? 0 : tid;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,142 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreBytecode.h
+
+    register bytecode for user code blocks
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#ifndef _QORE_QOREBYTECODE_H
+
+#define _QORE_QOREBYTECODE_H
+
+#include <vector>
+
+class StatementBlock;
+class UserVariantBase;
+class LocalVar;
+
+// the bytecode instruction set; "a" is the destination register or jump target, "b" and "c" are source registers
+#define QORE_BC_OPCODES(X) \
+    X(MOV)      /* a = b */ \
+    X(LOADK)    /* a = k */ \
+    X(I2F)      /* a = (float)b */ \
+    X(ADDI)     /* a = b + c */ \
+    X(ADDIK)    /* a = b + k */ \
+    X(SUBI)     /* a = b - c */ \
+    X(MULI)     /* a = b * c */ \
+    X(DIVI)     /* a = b / c; exception if c == 0 */ \
+    X(MODI)     /* a = b % c; exception if c == 0 */ \
+    X(MODEQI)   /* a = b % c; 0 if c == 0 */ \
+    X(NEGI)     /* a = -b */ \
+    X(ADDF)     /* a = b + c */ \
+    X(ADDFK)    /* a = b + k */ \
+    X(SUBF)     /* a = b - c */ \
+    X(MULF)     /* a = b * c */ \
+    X(DIVF)     /* a = b / c; exception if c == 0 */ \
+    X(NEGF)     /* a = -b */ \
+    X(LTI)      /* a = b < c */ \
+    X(LEI)      /* a = b <= c */ \
+    X(EQI)      /* a = b == c */ \
+    X(NEI)      /* a = b != c */ \
+    X(LTF)      /* a = b < c */ \
+    X(LEF)      /* a = b <= c */ \
+    X(EQF)      /* a = b == c */ \
+    X(NEF)      /* a = b != c */ \
+    X(BOOLI)    /* a = b != 0 */ \
+    X(BOOLF)    /* a = b != 0.0 */ \
+    X(NOTI)     /* a = !b */ \
+    X(NOTF)     /* a = !b */ \
+    X(JMP)      /* jump to a */ \
+    X(JMPF)     /* jump to a if !b */ \
+    X(JMPT)     /* jump to a if b */ \
+    X(LOOP)     /* jump to a at the end of a loop iteration */ \
+    X(RETI)     /* return b as an int */ \
+    X(RETF)     /* return b as a float */ \
+    X(RETB)     /* return b as a bool */ \
+    X(RETN)     /* return NOTHING */
+
+enum qore_bc_op_e : unsigned char {
+#define QORE_BC_ENUM(op) QBC_##op,
+    QORE_BC_OPCODES(QORE_BC_ENUM)
+#undef QORE_BC_ENUM
+};
+
+// a VM register; booleans are stored as integers with the values 0 and 1
+union QoreBytecodeReg {
+    int64 i;
+    double f;
+};
+
+struct QoreBytecodeInsn {
+    qore_bc_op_e op;
+    int a, b, c;
+    // immediate operand; for ops that can raise an exception, the index of the error message
+    QoreBytecodeReg k;
+    // the location of the statement for ops that can raise an exception
+    const QoreProgramLocation* loc;
+};
+
+//! a user function or method body compiled to register bytecode
+/** bodies are only compiled if the Program has \c PO_COMPILE_BYTECODE set and all statements and expressions in the
+    body are supported: local variables of type int, float and bool, arithmetic, comparison and logical operators,
+    assignments, if, while, do-while and for statements; local variables live in VM registers instead of on the
+    thread-local variable stack
+ */
+class QoreBytecode {
+public:
+    //! compiles the given body; returns nullptr if the body uses any unsupported statement or expression
+    DLLLOCAL static QoreBytecode* compile(const StatementBlock* body, const UserVariantBase* uvb);
+
+    //! executes the bytecode
+    /** @return 0 if the bytecode was executed, -1 if the arguments do not have the expected types, in which case
+        nothing was executed and the caller must execute the parse tree
+     */
+    DLLLOCAL int exec(QoreValue& return_value, ExceptionSink* xsink) const;
+
+private:
+    friend class QoreBytecodeCompiler;
+
+    // a parameter loaded into a register before execution
+    struct param_t {
+        const LocalVar* lv;
+        int reg;
+        qore_type_t type;
+    };
+
+    std::vector<QoreBytecodeInsn> code;
+    std::vector<param_t> params;
+    int nregs = 0;
+
+    DLLLOCAL QoreBytecode() {
+    }
+
+    DLLLOCAL static void raiseDivisionByZero(const QoreBytecodeInsn* pc, int64 l, int64 r, ExceptionSink* xsink);
+};
+
+#endif
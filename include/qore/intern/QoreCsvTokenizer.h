@@ -0,0 +1,93 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreCsvTokenizer.h
+
+    splits and formats lines of CSV data
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#ifndef _QORE_QORECSVTOKENIZER_H
+
+#define _QORE_QORECSVTOKENIZER_H
+
+#include <qore/AbstractPrivateData.h>
+
+#include <string>
+
+// splits lines of CSV data into fields and formats lists of values as CSV lines
+/* the separator, quote, escape and end of line strings are stored in the tokenizer's encoding; lines in other
+   encodings are split with the strings converted to the line's encoding
+
+   objects are immutable after construction and can be used from multiple threads at the same time
+*/
+class QoreCsvTokenizer : public AbstractPrivateData {
+public:
+    // creates the tokenizer with the given options; see CsvTokenizer::constructor() for the option hash
+    DLLLOCAL QoreCsvTokenizer(const QoreHashNode* opts, ExceptionSink* xsink);
+
+    DLLLOCAL QoreCsvTokenizer(const QoreCsvTokenizer& old) : enc(old.enc), sep(old.sep), quote(old.quote),
+            escape(old.escape), eol(old.eol), trim(old.trim), optimal_quotes(old.optimal_quotes),
+            ascii(old.ascii) {
+    }
+
+    // splits the line into a list of strings in the line's encoding
+    DLLLOCAL QoreListNode* split(const QoreString* line, ExceptionSink* xsink) const;
+
+    // splits the line into a hash keyed by the given headers; fields without a header are keyed by their position
+    DLLLOCAL QoreHashNode* splitToHash(const QoreString* line, const QoreListNode* headers, ExceptionSink* xsink) const;
+
+    // formats the values as a CSV line with a trailing end of line string in the tokenizer's encoding
+    DLLLOCAL QoreStringNode* join(const QoreListNode* values, ExceptionSink* xsink) const;
+
+    DLLLOCAL const QoreEncoding* getEncoding() const {
+        return enc;
+    }
+
+private:
+    const QoreEncoding* enc = QCS_DEFAULT;
+    std::string sep = ",",
+        quote = "\"",
+        escape = "\\",
+        eol = "\n";
+    // trim unquoted fields
+    bool trim = false,
+        // only quote string values that need it
+        optimal_quotes = true,
+        // the separator and quote are ASCII, so they can be used with lines in any ASCII-compatible encoding
+        ascii = true;
+
+    DLLLOCAL int setString(std::string& str, const char* opt, QoreValue v, ExceptionSink* xsink);
+
+    DLLLOCAL QoreListNode* splitIntern(const char* str, size_t len, const QoreEncoding* lenc, const char* sepp,
+            size_t sl, const char* qp, size_t ql, ExceptionSink* xsink) const;
+
+    // returns true if the string must be quoted when optimal quoting is enabled
+    DLLLOCAL bool needsQuotes(const char* str, size_t len) const;
+};
+
+#endif
@@ -33,32 +33,363 @@
 
 #define _QORE_QOREHASHNODEINTERN_H
 
-#include <list>
+#include "qore/intern/xxhash.h"
+#include "qore/intern/QoreSlabAllocator.h"
+
+#include <string.h>
+
+//! the maximum number of members in a hash that will be searched linearly without an index
+#define QORE_HASH_LINEAR_MAX 8
+
+//! the minimum size of the open-addressing hash member index; must be a power of 2
+#define QORE_HASH_INDEX_MIN 16
 
 // to maintain the order of inserts
 class HashMember {
 public:
     QoreValue val;
     std::string key;
+    // intrusive insertion-order links
+    HashMember* prev = nullptr;
+    HashMember* next = nullptr;
+    // cached hash of the key
+    size_t hash;
+
+    DLLLOCAL HashMember(const char* n_key, size_t n_hash) : key(n_key), hash(n_hash) {
+    }
 
-    DLLLOCAL HashMember(const char* n_key) : key(n_key) {
+    DLLLOCAL HashMember(const std::string& n_key, size_t n_hash) : key(n_key), hash(n_hash) {
     }
 
     DLLLOCAL ~HashMember() {
     }
+
+    DLLLOCAL static size_t getHash(const char* key) {
+#if TARGET_BITS == 64
+        return XXH64(key, strlen(key), 0);
+#else
+        return XXH32(key, strlen(key), 0);
+#endif
+    }
 };
 
-typedef std::list<HashMember*> qhlist_t;
+//! insertion-ordered container of hash members with an open-addressing index
+/** Members are linked in insertion order with intrusive links, so each member requires a single allocation, and
+    pointers and iterators to members stay valid when other members are added or removed.
 
-#ifdef HAVE_QORE_HASH_MAP
-//#warning compiling with hash_map
-#include <qore/hash_map_include.h>
-#include "qore/intern/xxhash.h"
+    Hashes with up to QORE_HASH_LINEAR_MAX members are searched linearly and have no index; larger hashes use a
+    flat power-of-two-sized linear probing table of member pointers with backward-shift deletion (no tombstones).
+*/
+class HashMemberList {
+public:
+    class const_iterator;
 
-typedef HASH_MAP<const char*, qhlist_t::iterator, qore_hash_str, eqstr> hm_hm_t;
-#else
-typedef std::map<const char*, qhlist_t::iterator, ltstr> hm_hm_t;
-#endif
+    class iterator {
+        friend class HashMemberList;
+        friend class const_iterator;
+    public:
+        DLLLOCAL iterator() {
+        }
+
+        DLLLOCAL HashMember* const& operator*() const {
+            assert(m);
+            return m;
+        }
+
+        DLLLOCAL HashMember* operator->() const {
+            assert(m);
+            return m;
+        }
+
+        DLLLOCAL iterator& operator++() {
+            assert(m);
+            m = m->next;
+            return *this;
+        }
+
+        DLLLOCAL iterator& operator--() {
+            m = m ? m->prev : l->tail;
+            return *this;
+        }
+
+        DLLLOCAL bool operator==(const iterator& other) const {
+            return m == other.m;
+        }
+
+        DLLLOCAL bool operator!=(const iterator& other) const {
+            return m != other.m;
+        }
+
+    private:
+        const HashMemberList* l = nullptr;
+        HashMember* m = nullptr;
+
+        DLLLOCAL iterator(const HashMemberList* l, HashMember* m) : l(l), m(m) {
+        }
+    };
+
+    class const_iterator {
+        friend class HashMemberList;
+    public:
+        DLLLOCAL const_iterator() {
+        }
+
+        DLLLOCAL const_iterator(const iterator& i) : l(i.l), m(i.m) {
+        }
+
+        DLLLOCAL const HashMember* const& operator*() const {
+            assert(m);
+            return m;
+        }
+
+        DLLLOCAL const HashMember* operator->() const {
+            assert(m);
+            return m;
+        }
+
+        DLLLOCAL const_iterator& operator++() {
+            assert(m);
+            m = m->next;
+            return *this;
+        }
+
+        DLLLOCAL const_iterator& operator--() {
+            m = m ? m->prev : l->tail;
+            return *this;
+        }
+
+        DLLLOCAL bool operator==(const const_iterator& other) const {
+            return m == other.m;
+        }
+
+        DLLLOCAL bool operator!=(const const_iterator& other) const {
+            return m != other.m;
+        }
+
+    private:
+        const HashMemberList* l = nullptr;
+        const HashMember* m = nullptr;
+
+        DLLLOCAL const_iterator(const HashMemberList* l, const HashMember* m) : l(l), m(m) {
+        }
+    };
+
+    DLLLOCAL HashMemberList() {
+    }
+
+    DLLLOCAL ~HashMemberList() {
+        assert(!head);
+        free(index);
+    }
+
+    DLLLOCAL iterator begin() {
+        return iterator(this, head);
+    }
+
+    DLLLOCAL iterator end() {
+        return iterator(this, nullptr);
+    }
+
+    DLLLOCAL const_iterator begin() const {
+        return const_iterator(this, head);
+    }
+
+    DLLLOCAL const_iterator end() const {
+        return const_iterator(this, nullptr);
+    }
+
+    DLLLOCAL HashMember* front() const {
+        assert(head);
+        return head;
+    }
+
+    DLLLOCAL HashMember* back() const {
+        assert(tail);
+        return tail;
+    }
+
+    DLLLOCAL size_t size() const {
+        return len;
+    }
+
+    DLLLOCAL bool empty() const {
+        return !head;
+    }
+
+    //! returns the member with the given key or nullptr if not present
+    DLLLOCAL HashMember* find(const char* key) const {
+        assert(key);
+        if (!index) {
+            for (HashMember* m = head; m; m = m->next) {
+                if (m->key[0] == key[0] && !strcmp(m->key.c_str(), key))
+                    return m;
+            }
+            return nullptr;
+        }
+
+        return findIndex(key, HashMember::getHash(key));
+    }
+
+    //! returns the member with the given key and precalculated key hash or nullptr if not present
+    DLLLOCAL HashMember* find(const char* key, size_t hash) const {
+        assert(key);
+        assert(hash == HashMember::getHash(key));
+        if (!index) {
+            for (HashMember* m = head; m; m = m->next) {
+                if (m->hash == hash && !strcmp(m->key.c_str(), key))
+                    return m;
+            }
+            return nullptr;
+        }
+
+        return findIndex(key, hash);
+    }
+
+    //! creates a new member for a key that must not already be present and appends it to the list
+    DLLLOCAL HashMember* create(const char* key) {
+        return create(key, HashMember::getHash(key));
+    }
+
+    //! creates a new member for a key with a precalculated key hash that must not already be present
+    DLLLOCAL HashMember* create(const char* key, size_t hash) {
+        assert(!find(key));
+        HashMember* m = new HashMember(key, hash);
+        m->prev = tail;
+        if (tail)
+            tail->next = m;
+        else
+            head = m;
+        tail = m;
+        ++len;
+
+        if (index) {
+            // keep the load factor at or below 1/2
+            if ((len << 1) > (mask + 1))
+                rehash((mask + 1) << 1);
+            else
+                indexInsert(m);
+        }
+        else if (len > QORE_HASH_LINEAR_MAX)
+            rehash(QORE_HASH_INDEX_MIN);
+
+        return m;
+    }
+
+    //! creates members with the keys and key hashes of the given list in this empty list; values are not copied
+    /** the index is only built once for the final size
+    */
+    DLLLOCAL void copyKeys(const HashMemberList& l) {
+        assert(empty());
+        for (HashMember* m = l.head; m; m = m->next) {
+            HashMember* n = new HashMember(m->key, m->hash);
+            n->prev = tail;
+            if (tail)
+                tail->next = n;
+            else
+                head = n;
+            tail = n;
+        }
+        len = l.len;
+
+        if (len > QORE_HASH_LINEAR_MAX) {
+            // keep the load factor at or below 1/2
+            size_t size = QORE_HASH_INDEX_MIN;
+            while ((len << 1) > size)
+                size <<= 1;
+            rehash(size);
+        }
+    }
+
+    //! unlinks the member from the list and the index; does not delete it
+    DLLLOCAL void erase(HashMember* m) {
+        if (index)
+            indexRemove(m);
+
+        if (m->prev)
+            m->prev->next = m->next;
+        else
+            head = m->next;
+        if (m->next)
+            m->next->prev = m->prev;
+        else
+            tail = m->prev;
+        --len;
+    }
+
+    DLLLOCAL void erase(iterator i) {
+        erase(*i);
+    }
+
+    //! unlinks all members; does not delete them
+    DLLLOCAL void clear() {
+        head = tail = nullptr;
+        len = 0;
+        if (index) {
+            free(index);
+            index = nullptr;
+            mask = 0;
+        }
+    }
+
+private:
+    HashMember* head = nullptr;
+    HashMember* tail = nullptr;
+    size_t len = 0;
+    // open-addressing index, only allocated for hashes with more than QORE_HASH_LINEAR_MAX members
+    HashMember** index = nullptr;
+    size_t mask = 0;
+
+    DLLLOCAL HashMemberList(const HashMemberList&) = delete;
+    DLLLOCAL HashMemberList& operator=(const HashMemberList&) = delete;
+
+    DLLLOCAL HashMember* findIndex(const char* key, size_t hash) const {
+        assert(index);
+        for (size_t i = hash & mask; index[i]; i = (i + 1) & mask) {
+            if (index[i]->hash == hash && !strcmp(index[i]->key.c_str(), key))
+                return index[i];
+        }
+        return nullptr;
+    }
+
+    DLLLOCAL void indexInsert(HashMember* m) {
+        size_t i = m->hash & mask;
+        while (index[i])
+            i = (i + 1) & mask;
+        index[i] = m;
+    }
+
+    DLLLOCAL void indexRemove(HashMember* m) {
+        size_t i = m->hash & mask;
+        while (index[i] != m) {
+            assert(index[i]);
+            i = (i + 1) & mask;
+        }
+        // backward-shift deletion: move up any following entries that would become unreachable
+        size_t j = i;
+        while (true) {
+            j = (j + 1) & mask;
+            if (!index[j])
+                break;
+            size_t k = index[j]->hash & mask;
+            // move the entry at j to i if its home slot k is not cyclically in (i, j]
+            if ((j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j))) {
+                index[i] = index[j];
+                i = j;
+            }
+        }
+        index[i] = nullptr;
+    }
+
+    DLLLOCAL void rehash(size_t new_size) {
+        free(index);
+        index = (HashMember**)calloc(new_size, sizeof(HashMember*));
+        mask = new_size - 1;
+        for (HashMember* m = head; m; m = m->next)
+            indexInsert(m);
+    }
+};
+
+typedef HashMemberList qhlist_t;
 
 // QoreHashIterator private class
 class qhi_priv {
@@ -121,7 +452,6 @@ public:
 class qore_hash_private {
 public:
     qhlist_t member_list;
-    hm_hm_t hm;
     // either hashdecl or complexTypeInfo can be set, but not both
     const TypedHashDecl* hashdecl = nullptr;
     const QoreTypeInfo* complexTypeInfo = nullptr;
@@ -139,6 +469,14 @@ public:
         assert(member_list.empty());
     }
 
+    DLLLOCAL static void* operator new(size_t size) {
+        return q_slab_alloc(size);
+    }
+
+    DLLLOCAL static void operator delete(void* p, size_t size) {
+        q_slab_free(p, size);
+    }
+
     DLLLOCAL QoreValue getKeyValueIntern(const char* key) const;
 
     DLLLOCAL QoreValue getKeyValueExistence(const char* key, bool& exists, ExceptionSink* xsink) const;
@@ -155,10 +493,10 @@ public:
     DLLLOCAL QoreValue getReferencedKeyValueIntern(const char* key, bool& exists) const {
         assert(key);
 
-        hm_hm_t::const_iterator i = hm.find(key);
-        if (i != hm.end()) {
+        HashMember* m = member_list.find(key);
+        if (m) {
             exists = true;
-            return (*(i->second))->val.refSelf();
+            return m->val.refSelf();
         }
 
         exists = false;
@@ -166,12 +504,10 @@ public:
     }
 
     DLLLOCAL int64 getKeyAsBigInt(const char* key, bool &found) const {
-        assert(key);
-        hm_hm_t::const_iterator i = hm.find(key);
-
-        if (i != hm.end()) {
+        HashMember* m = member_list.find(key);
+        if (m) {
             found = true;
-            return (*(i->second))->val.getAsBigInt();
+            return m->val.getAsBigInt();
         }
 
         found = false;
@@ -179,12 +515,10 @@ public:
     }
 
     DLLLOCAL bool getKeyAsBool(const char* key, bool& found) const {
-        assert(key);
-        hm_hm_t::const_iterator i = hm.find(key);
-
-        if (i != hm.end()) {
+        HashMember* m = member_list.find(key);
+        if (m) {
             found = true;
-            return (*(i->second))->val.getAsBool();
+            return m->val.getAsBool();
         }
 
         found = false;
@@ -192,40 +526,38 @@ public:
     }
 
     DLLLOCAL bool existsKey(const char* key) const {
-        assert(key);
-        return hm.find(key) != hm.end();
+        return member_list.find(key) != nullptr;
     }
 
     DLLLOCAL bool existsKeyValue(const char* key) const {
-        assert(key);
-        hm_hm_t::const_iterator i = hm.find(key);
-        if (i == hm.end())
-            return false;
-        return !(*(i->second))->val.isNothing();
+        HashMember* m = member_list.find(key);
+        return m ? !m->val.isNothing() : false;
     }
 
     DLLLOCAL HashMember* findMember(const char* key) {
-        assert(key);
-        hm_hm_t::iterator i = hm.find(key);
-        return i != hm.end() ? (*(i->second)) : nullptr;
+        return member_list.find(key);
     }
 
-   DLLLOCAL HashMember* findCreateMember(const char* key) {
-        // otherwise create the new hash entry
-        HashMember* om = findMember(key);
+    DLLLOCAL HashMember* findCreateMember(const char* key) {
+        HashMember* om = member_list.find(key);
         if (om)
             return om;
 
-        om = new HashMember(key);
+        // otherwise create the new hash entry
+        om = member_list.create(key);
         assert(om->val.isNothing());
-        member_list.push_back(om);
+        return om;
+    }
 
-        // add to the map
-        qhlist_t::iterator i = member_list.end();
-        --i;
-        hm[om->key.c_str()] = i;
+    // finds or creates a member with a precalculated key hash
+    DLLLOCAL HashMember* findCreateMember(const char* key, size_t hash) {
+        HashMember* om = member_list.find(key, hash);
+        if (om)
+            return om;
 
-        // return the new member
+        // otherwise create the new hash entry
+        om = member_list.create(key, hash);
+        assert(om->val.isNothing());
         return om;
     }
 
@@ -234,29 +566,20 @@ public:
     }
 
     // NOTE: does not delete the value, this must be done by the caller before this call
-    // also does not delete map entry; must be done outside this call
-    DLLLOCAL void internDeleteKey(qhlist_t::iterator i) {
-        HashMember* om = *i;
-
-        member_list.erase(i);
+    DLLLOCAL void internDeleteKey(HashMember* om) {
+        member_list.erase(om);
 
         // free om memory
         delete om;
     }
 
     DLLLOCAL void deleteKey(const char* key, ExceptionSink *xsink) {
-        assert(key);
-
-        hm_hm_t::iterator i = hm.find(key);
-
-        if (i == hm.end())
+        HashMember* li = member_list.find(key);
+        if (!li)
             return;
 
-        qhlist_t::iterator li = i->second;
-        hm.erase(i);
-
         // dereference node if present
-        AbstractQoreNode* n = (*li)->val.assignNothing();
+        AbstractQoreNode* n = li->val.assignNothing();
         if (n) {
             if (needs_scan(n))
                 incScanCount(-1);
@@ -275,17 +598,11 @@ public:
     }
 
     DLLLOCAL QoreValue takeKeyValueIntern(const char* key) {
-        assert(key);
-
-        hm_hm_t::iterator i = hm.find(key);
-
-        if (i == hm.end())
+        HashMember* li = member_list.find(key);
+        if (!li)
             return QoreValue();
 
-        qhlist_t::iterator li = i->second;
-        hm.erase(i);
-
-        QoreValue rv = (*li)->val;
+        QoreValue rv = li->val;
         internDeleteKey(li);
 
         if (needs_scan(rv))
@@ -372,15 +689,16 @@ public:
     }
 
     DLLLOCAL void copyIntern(qore_hash_private& h) const {
-        // copy all members to new object
+        assert(h.member_list.empty());
+        // copy all members to new object; keys and their hashes are copied without lookups
+        h.member_list.copyKeys(member_list);
+        qhlist_t::iterator hi = h.member_list.begin();
         for (auto& i : member_list) {
-            hash_assignment_priv ha(h, i->key.c_str());
-#ifdef DEBUG
-            assert(ha.swap(i->val.refSelf()).isNothing());
-#else
-            ha.swap(i->val.refSelf());
-#endif
+            (*hi)->val = i->val.refSelf();
+            ++hi;
         }
+        // the copy has the same values
+        h.obj_count = obj_count;
     }
 
     DLLLOCAL QoreHashNode* plusEquals(const QoreHashNode* h, ExceptionSink* xsink) const {
@@ -402,8 +720,8 @@ public:
     DLLLOCAL QoreHashNode* evalImpl(ExceptionSink* xsink) const {
         QoreHashNodeHolder h(getCopy(), xsink);
 
-        for (qhlist_t::const_iterator i = member_list.begin(), e = member_list.end(); i != e; ++i) {
-            h->priv->setKeyValue((*i)->key, (*i)->val.refSelf(), xsink);
+        for (auto& i : member_list) {
+            h->priv->setKeyValue(i->key, i->val.refSelf(), xsink);
             if (*xsink)
                 return nullptr;
         }
@@ -437,19 +755,22 @@ public:
 
     DLLLOCAL bool derefImpl(ExceptionSink* xsink, bool reverse = false) {
         if (reverse) {
-            for (qhlist_t::reverse_iterator i = member_list.rbegin(), e = member_list.rend(); i != e; ++i) {
-                (*i)->val.discard(xsink);
-                delete *i;
+            for (HashMember* m = member_list.empty() ? nullptr : member_list.back(); m;) {
+                HashMember* prev = m->prev;
+                m->val.discard(xsink);
+                delete m;
+                m = prev;
             }
         } else {
-            for (qhlist_t::iterator i = member_list.begin(), e = member_list.end(); i != e; ++i) {
-                (*i)->val.discard(xsink);
-                delete *i;
+            for (HashMember* m = member_list.empty() ? nullptr : member_list.front(); m;) {
+                HashMember* next = m->next;
+                m->val.discard(xsink);
+                delete m;
+                m = next;
             }
         }
 
         member_list.clear();
-        hm.clear();
         obj_count = 0;
         return true;
     }
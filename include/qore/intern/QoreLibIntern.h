@@ -645,6 +645,9 @@ public:
 
    DLLLOCAL hash_assignment_priv(QoreHashNode& n_h, const std::string &key, bool must_already_exist = false);
 
+   // finds or creates the member using a precalculated key hash
+   DLLLOCAL hash_assignment_priv(QoreHashNode& n_h, const char* key, size_t hash);
+
    DLLLOCAL hash_assignment_priv(ExceptionSink* xsink, QoreHashNode& n_h, const QoreString& key, bool must_already_exist = false);
 
    DLLLOCAL hash_assignment_priv(ExceptionSink* xsink, QoreHashNode& n_h, const QoreString* key, bool must_already_exist = false);
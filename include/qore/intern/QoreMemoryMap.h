@@ -0,0 +1,77 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreMemoryMap.h
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#ifndef _QORE_QOREMEMORYMAP_H
+#define _QORE_QOREMEMORYMAP_H
+
+//! a read-only memory mapping of a file
+/** binary views over the mapping hold a reference to it, so the file data stays mapped until the last view is
+    destroyed, even if the file itself has been closed
+ */
+class QoreMemoryMap : public QoreReferenceCounter {
+public:
+    //! maps the entire file open on the given file descriptor; returns nullptr if an exception was raised
+    DLLLOCAL static QoreMemoryMap* create(int fd, const char* path, ExceptionSink* xsink);
+
+    DLLLOCAL void ref() const {
+        ROreference();
+    }
+
+    DLLLOCAL void deref() {
+        if (ROdereference())
+            delete this;
+    }
+
+    DLLLOCAL const char* getPtr() const {
+        return (const char*)addr;
+    }
+
+    DLLLOCAL size_t size() const {
+        return len;
+    }
+
+    //! returns a new binary view of the given range, which must be within the mapping
+    DLLLOCAL BinaryNode* getView(size_t offset, size_t size) {
+        assert(offset + size <= len);
+        return new BinaryNode(this, getPtr() + offset, size);
+    }
+
+private:
+    void* addr;
+    size_t len;
+
+    DLLLOCAL QoreMemoryMap(void* addr, size_t len) : addr(addr), len(len) {
+    }
+
+    DLLLOCAL ~QoreMemoryMap();
+};
+
+#endif
@@ -37,6 +37,8 @@
 #include <qore/QoreCondition.h>
 
 #include <string>
+#include <atomic>
+#include <sched.h>
 
 class QoreQueueNode {
 public:
@@ -75,6 +77,98 @@ public:
 #define QW_TIMEOUT -2
 #define QW_ERROR   -3
 
+// bounded multi-producer, multi-consumer ring buffer with per-slot sequence numbers
+/* each slot carries a sequence number that tells producers and consumers whether the slot is free for the current
+   lap or holds a published value; producers and consumers claim positions with a single CAS on their own
+   counter, so neither side takes a lock while the buffer is neither full nor empty
+*/
+class QoreQueueRing {
+public:
+   DLLLOCAL QoreQueueRing(size_t n_size) : size(n_size), buf(new Cell[n_size]) {
+      assert(size);
+      for (size_t i = 0; i < size; ++i)
+         buf[i].seq.store(i, std::memory_order_relaxed);
+   }
+
+   // the ring must be empty when deleted
+   DLLLOCAL ~QoreQueueRing() {
+      assert(!count());
+      delete [] buf;
+   }
+
+   // returns true if the value was stored, false if the ring is full; takes the reference only on success
+   DLLLOCAL bool tryPush(QoreValue v) {
+      size_t pos = enq_pos.load(std::memory_order_relaxed);
+      Cell* c;
+      while (true) {
+         c = &buf[pos % size];
+         size_t seq = c->seq.load(std::memory_order_acquire);
+         ptrdiff_t dif = (ptrdiff_t)seq - (ptrdiff_t)pos;
+         if (!dif) {
+            if (enq_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+               break;
+         }
+         else if (dif < 0)
+            return false;
+         else
+            pos = enq_pos.load(std::memory_order_relaxed);
+      }
+      c->val = v;
+      c->seq.store(pos + 1, std::memory_order_release);
+      return true;
+   }
+
+   // returns true if a value was removed from the ring, false if the ring is empty
+   DLLLOCAL bool tryShift(QoreValue& v) {
+      size_t pos = deq_pos.load(std::memory_order_relaxed);
+      Cell* c;
+      while (true) {
+         c = &buf[pos % size];
+         size_t seq = c->seq.load(std::memory_order_acquire);
+         ptrdiff_t dif = (ptrdiff_t)seq - (ptrdiff_t)(pos + 1);
+         if (!dif) {
+            if (deq_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+               break;
+         }
+         else if (dif < 0)
+            return false;
+         else
+            pos = deq_pos.load(std::memory_order_relaxed);
+      }
+      v = c->val;
+      c->val = QoreValue();
+      c->seq.store(pos + size, std::memory_order_release);
+      return true;
+   }
+
+   // returns the approximate number of elements in the ring
+   DLLLOCAL size_t count() const {
+      size_t d = deq_pos.load(std::memory_order_acquire);
+      size_t e = enq_pos.load(std::memory_order_acquire);
+      return e > d ? e - d : 0;
+   }
+
+   DLLLOCAL size_t getSize() const {
+      return size;
+   }
+
+private:
+   struct Cell {
+      std::atomic<size_t> seq;
+      QoreValue val;
+   };
+
+   size_t size;
+   Cell* buf;
+   std::atomic<size_t> enq_pos = {0};
+   // keep the producer and consumer positions on separate cache lines
+   char pad[64 - sizeof(std::atomic<size_t>)];
+   std::atomic<size_t> deq_pos = {0};
+
+   DLLLOCAL QoreQueueRing(const QoreQueueRing&) = delete;
+   DLLLOCAL QoreQueueRing& operator=(const QoreQueueRing&) = delete;
+};
+
 class qore_queue_private {
 private:
    enum queue_status_e { Queue_Deleted = -1 };
@@ -88,8 +182,15 @@ private:
    QoreStringNode* desc;
    int len,   // the number of elements currently in the queue (or -1 for deleted)
        max;   // the maximum size of the queue (or -1 for unlimited)
-   unsigned read_waiting,   // number of threads waiting on reads
-            write_waiting;  // number of threads waiting on writes
+   // number of threads waiting on reads and writes; atomic so that lock-free ring buffer operations can check them
+   std::atomic<unsigned> read_waiting,
+                         write_waiting;
+   // ring buffer for lock-free operation; only set for ring-buffer queues
+   QoreQueueRing* ring = nullptr;
+   // false if the queue has an error status or has been deleted; only used for ring-buffer queues
+   std::atomic<bool> ring_ok = {true};
+   // number of threads in the lock-free ring buffer push path; see ringDisable()
+   std::atomic<unsigned> ring_pushers = {0};
 
    DLLLOCAL int waitReadIntern(ExceptionSink *xsink, int timeout_ms);
    DLLLOCAL int waitWriteIntern(ExceptionSink *xsink, int timeout_ms);
@@ -103,15 +204,58 @@ private:
    // called in the lock; returns -1 if not possible (cannot write to the queue) or 0 of OK
    DLLLOCAL int checkWriteIntern(ExceptionSink* xsink, bool always_error = false);
 
+   // wakes up one thread blocked on the given condition after a lock-free ring buffer operation
+   DLLLOCAL void ringSignal(std::atomic<unsigned>& waiting, QoreCondition& cond) {
+      // the fence pairs with the fence in ringPush() and ringShift() after a waiter is registered
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiting.load(std::memory_order_relaxed)) {
+         AutoLocker al(&l);
+         cond.signal();
+      }
+   }
+
+   // tries to push a value to the ring buffer without locking; takes the reference only on success
+   DLLLOCAL bool ringTryPush(QoreValue n) {
+      // the pusher count is raised before ring_ok is checked so that ringDisable() can wait for the push to complete
+      ring_pushers.fetch_add(1, std::memory_order_seq_cst);
+      bool rc = ring_ok.load(std::memory_order_seq_cst) && ring->tryPush(n);
+      ring_pushers.fetch_sub(1, std::memory_order_release);
+      return rc;
+   }
+
+   // called in the lock before the ring buffer is cleared; stops lock-free pushes and waits for pushes in progress
+   DLLLOCAL void ringDisable() {
+      ring_ok.store(false, std::memory_order_seq_cst);
+      while (ring_pushers.load(std::memory_order_acquire))
+         sched_yield();
+   }
+
+   DLLLOCAL void ringPush(ExceptionSink* xsink, QoreValue n, int timeout_ms, bool& to);
+   DLLLOCAL QoreValue ringShift(ExceptionSink* xsink, int timeout_ms, bool& to);
+
+   // returns -1 with an exception raised if the operation is not supported by ring-buffer queues
+   DLLLOCAL int checkRingIntern(ExceptionSink* xsink, const char* op) const {
+      if (!ring)
+         return 0;
+      xsink->raiseException("QUEUE-ERROR", "Queue::%s() is not supported by ring-buffer Queue objects", op);
+      return -1;
+   }
+
 public:
    DLLLOCAL qore_queue_private(int n_max = -1) : head(0), tail(0), desc(0), len(0), max(n_max), read_waiting(0), write_waiting(0) {
       assert(max);
       //printd(5, "qore_queue_private::qore_queue_private() this: %p max: %d\n", this, max);
    }
 
+   // a copy of a ring-buffer queue is an empty ring-buffer queue with the same size
    DLLLOCAL qore_queue_private(const qore_queue_private &orig) : head(0), tail(0), err(orig.err), desc(orig.desc ? orig.desc->stringRefSelf() : 0), len(0), max(orig.max), read_waiting(0), write_waiting(0) {
       AutoLocker al(orig.l);
-      if (orig.len == Queue_Deleted)
+      if (orig.ring) {
+         setRingBuffer();
+         if (!err.empty())
+            ring_ok.store(false, std::memory_order_release);
+      }
+      if (orig.len == Queue_Deleted || orig.ring)
          return;
 
       QoreQueueNode* w = orig.head;
@@ -132,9 +276,23 @@ public:
       assert(!tail);
       assert(len == Queue_Deleted);
       assert(!desc);
+      delete ring;
+   }
+
+   // makes the queue use a lock-free ring buffer of size "max"; must be called before the queue is used
+   DLLLOCAL void setRingBuffer() {
+      assert(max > 0);
+      assert(!ring);
+      assert(!head);
+      ring = new QoreQueueRing(max);
    }
 
-   // push at the end of the queue and take the reference - can only be used when len == -1
+   DLLLOCAL bool isRingBuffer() const {
+      return (bool)ring;
+   }
+
+   // push at the end of the queue and take the reference - can only be used when max == -1 or for ring-buffer queues,
+   // where the value is discarded if the queue is full; never blocks
    DLLLOCAL void pushAndTakeRef(QoreValue n);
 
    // push at the end of the queue
@@ -147,11 +305,11 @@ public:
    DLLLOCAL QoreValue pop(ExceptionSink* xsink, int timeout_ms, bool& to);
 
    DLLLOCAL bool empty() const {
-      return !len;
+      return ring ? !ring->count() : !len;
    }
 
    DLLLOCAL int size() const {
-      return len;
+      return ring ? (len == Queue_Deleted ? len : (int)ring->count()) : len;
    }
 
    DLLLOCAL int getMax() const {
@@ -176,6 +334,10 @@ public:
    DLLLOCAL static void destructor(QoreQueue& q, ExceptionSink* xsink) {
       q.priv->destructor(xsink);
    }
+
+   DLLLOCAL static qore_queue_private* get(QoreQueue& q) {
+      return q.priv;
+   }
 };
 
 #endif // _QORE_QOREQUEUEINTERN_H
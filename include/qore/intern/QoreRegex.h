@@ -60,8 +60,11 @@ public:
     DLLLOCAL void parse();
     DLLLOCAL void parseRT(const QoreString* pattern, ExceptionSink* xsink);
     DLLLOCAL bool exec(const QoreString* target, ExceptionSink* xsink) const;
-    DLLLOCAL bool exec(const char* str, size_t len) const;
+    // str must be UTF-8 data; it does not need to be null-terminated; raises an exception if len > INT_MAX
+    DLLLOCAL bool exec(const char* str, size_t len, ExceptionSink* xsink) const;
     DLLLOCAL QoreListNode* extractSubstrings(const QoreString* target, ExceptionSink* xsink) const;
+    // str must be UTF-8 data; it does not need to be null-terminated; raises an exception if len > INT_MAX
+    DLLLOCAL QoreListNode* extractSubstrings(const char* str, size_t len, ExceptionSink* xsink) const;
     // caller owns QoreString returned
     DLLLOCAL QoreString* getString();
 
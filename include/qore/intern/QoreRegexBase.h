@@ -46,10 +46,20 @@
 class QoreRegexBase {
 protected:
    pcre* p;
+   // study data including the JIT-compiled pattern, if available
+   pcre_extra* extra = nullptr;
    int options;
    QoreString* str;
 
+   // studies the compiled pattern and JIT-compiles it if supported by the PCRE library
+   DLLLOCAL void study();
+
+   // executes the pattern with the JIT-compiled code if available
+   DLLLOCAL int execIntern(const char* subject, int len, int offset, int* ovector, int ovecsize) const;
+
 public:
+   DLLLOCAL ~QoreRegexBase();
+
    DLLLOCAL void setCaseInsensitive();
    DLLLOCAL void setDotAll();
    DLLLOCAL void setExtended();
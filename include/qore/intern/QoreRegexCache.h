@@ -0,0 +1,120 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreRegexCache.h
+
+    cache of compiled regular expressions for run-time regex functions
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#ifndef _QORE_QOREREGEXCACHE_H
+
+#define _QORE_QOREREGEXCACHE_H
+
+#include "qore/intern/QoreRegex.h"
+#include "qore/intern/QoreRegexSubst.h"
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+// default maximum number of compiled patterns in the cache
+#define QORE_REGEX_CACHE_DEFAULT_SIZE 256
+
+// bounded LRU cache of compiled regular expressions used by the run-time regex functions
+/* patterns are keyed by pattern type, options, source encoding, and pattern text; patterns that fail to compile are
+   not cached
+*/
+class QoreRegexCache {
+public:
+    DLLLOCAL QoreRegexCache(size_t n_max = QORE_REGEX_CACHE_DEFAULT_SIZE) : max(n_max) {
+    }
+
+    DLLLOCAL ~QoreRegexCache() {
+        clearIntern();
+    }
+
+    // returns a referenced match / extraction pattern; the caller owns the reference
+    DLLLOCAL QoreRegex* getRegex(const QoreString& pattern, int64 options, ExceptionSink* xsink);
+
+    // returns a referenced substitution pattern; the caller owns the reference
+    DLLLOCAL QoreRegexSubst* getRegexSubst(const QoreString& pattern, int64 options, ExceptionSink* xsink);
+
+    // sets the maximum size of the cache; 0 disables caching
+    DLLLOCAL void setMaxSize(size_t n_max);
+
+    // returns cache statistics
+    DLLLOCAL void getInfo(size_t& n_size, size_t& n_max, int64& n_hits, int64& n_misses);
+
+private:
+    struct RegexCacheEntry {
+        std::string key;
+        QoreRegex* re;
+        QoreRegexSubst* rs;
+
+        DLLLOCAL RegexCacheEntry(std::string&& k, QoreRegex* r) : key(std::move(k)), re(r), rs(nullptr) {
+        }
+
+        DLLLOCAL RegexCacheEntry(std::string&& k, QoreRegexSubst* r) : key(std::move(k)), re(nullptr), rs(r) {
+        }
+
+        DLLLOCAL void del() {
+            if (re)
+                re->deref();
+            else
+                rs->deref();
+        }
+    };
+
+    // most recently used entries are at the front of the list
+    typedef std::list<RegexCacheEntry> rclist_t;
+    typedef std::unordered_map<std::string, rclist_t::iterator> rcmap_t;
+
+    QoreThreadLock m;
+    rclist_t lru;
+    rcmap_t map;
+    size_t max;
+    int64 hits = 0,
+        misses = 0;
+
+    DLLLOCAL static std::string getKey(char type, const QoreString& pattern, int64 options);
+
+    // returns the entry for the given key and moves it to the front of the LRU list, or nullptr if not cached
+    DLLLOCAL RegexCacheEntry* findIntern(const std::string& key);
+
+    // adds a new entry and evicts the least recently used entry if the cache is full
+    DLLLOCAL void addIntern(RegexCacheEntry&& e);
+
+    // evicts least recently used entries until the cache is within its maximum size
+    DLLLOCAL void trimIntern();
+
+    DLLLOCAL void clearIntern();
+};
+
+DLLLOCAL extern QoreRegexCache qore_regex_cache;
+
+#endif // _QORE_QOREREGEXCACHE_H
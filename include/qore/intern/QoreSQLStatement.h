@@ -42,6 +42,7 @@
 #define STMT_DEFINED   3
 
 class DBActionHelper;
+class QoreSQLColumnBlock;
 
 class QoreSQLStatement : public AbstractPrivateData, public SQLStatement {
    friend class DBActionHelper;
@@ -109,6 +110,11 @@ public:
 
    DLLLOCAL QoreListNode* fetchRows(int rows, ExceptionSink* xsink);
    DLLLOCAL QoreHashNode* fetchColumns(int rows, ExceptionSink* xsink);
+   DLLLOCAL QoreSQLColumnBlock* fetchBlock(int rows, ExceptionSink* xsink);
+
+   DLLLOCAL int getCapabilities() const {
+      return dsh->helperGetCapabilities();
+   }
 
    DLLLOCAL QoreHashNode* describe(ExceptionSink* xsink);
 
@@ -0,0 +1,99 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreSlabAllocator.h
+
+    per-thread slab allocator for small node objects
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#ifndef _QORE_QORESLABALLOCATOR_H
+
+#define _QORE_QORESLABALLOCATOR_H
+
+#include <vector>
+
+// the size class granularity and the alignment of all slab allocations
+#define QORE_SLAB_GRANULARITY 8
+// the largest allocation served from slabs; larger requests are passed to malloc()
+#define QORE_SLAB_MAX_SIZE 256
+// the number of size classes
+#define QORE_SLAB_CLASSES (QORE_SLAB_MAX_SIZE / QORE_SLAB_GRANULARITY)
+// the size of the memory chunks that are divided into objects of a single size class
+#define QORE_SLAB_CHUNK_SIZE (64 * 1024)
+
+// rounds a size up to the slab granularity
+#define QORE_SLAB_ROUND(s) (((s) + QORE_SLAB_GRANULARITY - 1) & ~(size_t)(QORE_SLAB_GRANULARITY - 1))
+
+//! allocates memory for a small object from the calling thread's slab cache
+/** objects of the same size class freed in the same thread are reused first; memory can be freed in any thread
+ */
+DLLLOCAL void* q_slab_alloc(size_t size);
+
+//! returns memory allocated with q_slab_alloc() to the calling thread's slab cache; size must be the allocation size
+DLLLOCAL void q_slab_free(void* p, size_t size);
+
+#ifdef QORE_NODE_COALLOC
+//! returns the size of a block holding an object and its co-allocated private data
+static inline size_t q_slab_coalloc_size(size_t size, size_t priv_size) {
+    return QORE_SLAB_ROUND(size) + priv_size;
+}
+
+//! allocates a block for an object followed by its private data
+/** the block is registered with the calling thread so that the object's constructor can take the private data
+    storage with q_slab_take_coalloc(); must be freed with q_slab_free() with the size returned by
+    q_slab_coalloc_size()
+ */
+DLLLOCAL void* q_slab_alloc_coalloc(size_t size, size_t priv_size);
+
+//! returns the co-allocated private data storage for the given object or nullptr if it was not co-allocated
+/** must be called from the object's constructor; if another co-allocated object was allocated in the meantime (for
+    example while evaluating constructor arguments), nullptr is returned and the private data must be allocated
+    separately
+ */
+DLLLOCAL void* q_slab_take_coalloc(const void* obj, size_t size);
+
+//! returns true if the private data pointer refers to the object's co-allocated private data storage
+static inline bool q_slab_is_coalloc(const void* obj, size_t size, const void* priv) {
+    return (const char*)obj + QORE_SLAB_ROUND(size) == (const char*)priv;
+}
+#endif
+
+//! statistics for a single slab size class
+struct qore_slab_class_info {
+    // the object size of the class
+    size_t size;
+    // the number of objects allocated and freed
+    int64 allocations, frees;
+    // the number of freed objects cached for reuse
+    int64 cached;
+};
+
+//! returns statistics for all slab size classes that have been used and the number of chunks allocated
+DLLLOCAL void q_slab_get_info(std::vector<qore_slab_class_info>& info, int64& chunks);
+
+#endif
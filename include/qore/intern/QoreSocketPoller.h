@@ -0,0 +1,120 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreSocketPoller.h
+
+    readiness notification for sets of sockets
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#ifndef _QORE_QORESOCKETPOLLER_H
+
+#define _QORE_QORESOCKETPOLLER_H
+
+#include <qore/AbstractPrivateData.h>
+#include <qore/QoreThreadLock.h>
+#include <qore/QoreSocketObject.h>
+
+#include <deque>
+#include <map>
+
+// maximum number of events retrieved from the kernel in one wait() call
+#define QORE_SOCKET_POLLER_EVENTS 128
+
+// one-shot read readiness notification for a set of sockets
+/* sockets are added with an associated value; when a socket becomes readable (or is closed by the peer), it is
+   removed from the poller and its value is returned by wait()
+
+   uses epoll(7) where available, otherwise poll(2); only one thread may wait on a poller at a time, but sockets can
+   be added and removed from any thread at any time
+*/
+class QoreSocketPoller : public AbstractPrivateData {
+public:
+    DLLLOCAL QoreSocketPoller(ExceptionSink* xsink);
+
+    // adds a socket; takes over the reference to "sock" and the value in "arg"
+    DLLLOCAL int add(QoreSocketObject* sock, QoreValue arg, ExceptionSink* xsink);
+
+    // removes a socket; returns true if the socket was registered
+    DLLLOCAL bool remove(QoreSocketObject* sock, ExceptionSink* xsink);
+
+    // waits for sockets to become readable and returns the values associated with ready sockets
+    DLLLOCAL QoreListNode* wait(int timeout_ms, ExceptionSink* xsink);
+
+    // removes all sockets and returns their associated values
+    DLLLOCAL QoreListNode* clear(ExceptionSink* xsink);
+
+    // wakes up a thread waiting in wait()
+    DLLLOCAL void wakeup();
+
+    DLLLOCAL size_t size();
+
+    // returns the name of the polling method used
+    DLLLOCAL static const char* getMethod();
+
+    DLLLOCAL virtual void deref(ExceptionSink* xsink);
+
+protected:
+    DLLLOCAL virtual ~QoreSocketPoller();
+
+private:
+    struct SocketPollEntry {
+        QoreSocketObject* sock;
+        QoreValue arg;
+        int fd;
+    };
+
+    // registered sockets keyed by registration ID
+    typedef std::map<int64, SocketPollEntry> spmap_t;
+    // registration IDs keyed by socket
+    typedef std::map<QoreSocketObject*, int64> sidmap_t;
+
+    QoreThreadLock m;
+    spmap_t smap;
+    sidmap_t sidmap;
+    // IDs of sockets that had buffered data when added and are therefore already readable
+    std::deque<int64> ready;
+    // the next registration ID; 0 is reserved for the wakeup descriptor
+    int64 next_id = 1;
+    bool waiting = false;
+
+#ifdef HAVE_SYS_EPOLL_H
+    int epfd = -1;
+#endif
+    // wakeup pipe
+    int wfd[2] = {-1, -1};
+
+    // removes the entry and moves its value to "l"; must be called with the lock held
+    DLLLOCAL void takeEntryIntern(spmap_t::iterator i, QoreListNode* l, ExceptionSink* xsink);
+
+    DLLLOCAL void drainWakeup();
+
+    // returns the socket's descriptor and optionally whether it has data buffered in user space
+    DLLLOCAL static int getSocketFd(QoreSocketObject* sock, bool* buffered = nullptr);
+};
+
+#endif // _QORE_QORESOCKETPOLLER_H
@@ -0,0 +1,134 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreSubstringSearch.h
+
+    byte-oriented substring search
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#ifndef _QORE_QORESUBSTRINGSEARCH_H
+
+#define _QORE_QORESUBSTRINGSEARCH_H
+
+#include <string.h>
+
+// needles shorter than this are found by scanning for their first byte with memchr()
+#define QSS_MIN_SKIP_NEEDLE 4
+// haystacks shorter than this are searched without building a skip table
+#define QSS_MIN_SKIP_HAYSTACK 256
+
+//! finds occurrences of a byte string in buffers
+/** short needles and haystacks are searched with memchr() and memcmp(); otherwise the Boyer-Moore-Horspool algorithm
+    is used with a skip table that is built on first use, so an object searching for all occurrences of the same needle
+    builds its table only once; the needle must remain valid for the lifetime of the object
+ */
+class QoreSubstringSearch {
+public:
+    DLLLOCAL QoreSubstringSearch(const char* needle, size_t nlen) : needle(needle), nlen(nlen) {
+    }
+
+    //! returns the first occurrence of the needle in the given buffer or nullptr if not found
+    /** an empty needle is found at the start of the buffer
+     */
+    DLLLOCAL const char* find(const char* hay, size_t hlen) {
+        if (nlen > hlen)
+            return nullptr;
+        if (!nlen)
+            return hay;
+        if (nlen == 1)
+            return (const char*)memchr(hay, needle[0], hlen);
+        if (nlen < QSS_MIN_SKIP_NEEDLE || hlen < QSS_MIN_SKIP_HAYSTACK)
+            return findSimple(hay, hlen);
+        return findSkip(hay, hlen);
+    }
+
+    //! returns the last occurrence of the needle that lies entirely in the given buffer or nullptr if not found
+    /** an empty needle is found at the end of the buffer
+     */
+    DLLLOCAL const char* rfind(const char* hay, size_t hlen) {
+        if (nlen > hlen)
+            return nullptr;
+        if (!nlen)
+            return hay + hlen;
+        if (nlen < QSS_MIN_SKIP_NEEDLE || hlen < QSS_MIN_SKIP_HAYSTACK)
+            return rfindSimple(hay, hlen);
+        return rfindSkip(hay, hlen);
+    }
+
+    //! returns the first occurrence of the needle in the given buffer or nullptr if not found
+    DLLLOCAL static const char* find(const char* hay, size_t hlen, const char* needle, size_t nlen) {
+        QoreSubstringSearch ss(needle, nlen);
+        return ss.find(hay, hlen);
+    }
+
+    //! returns the last occurrence of the needle that lies entirely in the given buffer or nullptr if not found
+    DLLLOCAL static const char* rfind(const char* hay, size_t hlen, const char* needle, size_t nlen) {
+        QoreSubstringSearch ss(needle, nlen);
+        return ss.rfind(hay, hlen);
+    }
+
+private:
+    const char* needle;
+    size_t nlen;
+
+    // forward and backward skip tables indexed by byte value
+    size_t skip[256];
+    size_t rskip[256];
+    bool have_skip = false,
+        have_rskip = false;
+
+    DLLLOCAL const char* findSimple(const char* hay, size_t hlen) const {
+        // the end of the range of possible starting positions
+        const char* end = hay + hlen - nlen + 1;
+        const char* p = hay;
+        while (p < end) {
+            p = (const char*)memchr(p, needle[0], end - p);
+            if (!p)
+                break;
+            if (!memcmp(p + 1, needle + 1, nlen - 1))
+                return p;
+            ++p;
+        }
+        return nullptr;
+    }
+
+    DLLLOCAL const char* rfindSimple(const char* hay, size_t hlen) const {
+        size_t i = hlen - nlen + 1;
+        while (i) {
+            --i;
+            if (hay[i] == needle[0] && !memcmp(hay + i + 1, needle + 1, nlen - 1))
+                return hay + i;
+        }
+        return nullptr;
+    }
+
+    DLLLOCAL const char* findSkip(const char* hay, size_t hlen);
+    DLLLOCAL const char* rfindSkip(const char* hay, size_t hlen);
+};
+
+#endif
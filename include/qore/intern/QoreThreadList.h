@@ -34,11 +34,17 @@
 #define _QORE_QORETHREADLIST_H
 
 // FIXME: move to config.h or something like that
-// not more than this number of threads can be running at the same time
+// not more than this number of threads can be running at the same time; the thread table grows in segments up to
+// this limit as threads are created
 #ifndef MAX_QORE_THREADS
-#define MAX_QORE_THREADS 0x1000
+#define MAX_QORE_THREADS 0x10000
 #endif
 
+// the thread table is allocated in segments of 2^QORE_THREAD_SEGMENT_BITS entries
+#define QORE_THREAD_SEGMENT_BITS 10
+#define QORE_THREAD_SEGMENT_SIZE (1 << QORE_THREAD_SEGMENT_BITS)
+#define QORE_THREAD_SEGMENT_MASK (QORE_THREAD_SEGMENT_SIZE - 1)
+
 class ThreadData;
 class CallStack;
 class CallNode;
@@ -59,30 +65,24 @@ class CallNode;
 #define MAX_QORE_THREADS 2560
 #endif
 
-class tid_node {
-public:
-   int tid;
-   tid_node* next, *prev;
-
-   DLLLOCAL tid_node(int ntid);
-   DLLLOCAL ~tid_node();
-};
+#define QORE_THREAD_SEGMENTS ((MAX_QORE_THREADS + QORE_THREAD_SEGMENT_SIZE - 1) / QORE_THREAD_SEGMENT_SIZE)
 
 // this structure holds all thread data that can be addressed with the qore tid
 class ThreadEntry {
 public:
    pthread_t ptid;
-   tid_node* tidnode;
 #ifdef QORE_RUNTIME_THREAD_STACK_TRACE
-   CallStack* callStack;
+   CallStack* callStack = nullptr;
 #endif
-   ThreadData* thread_data;
-   unsigned char status;
-   bool joined; // if set to true then pthread_detach should not be called on exit
+   ThreadData* thread_data = nullptr;
+   std::atomic<unsigned char> status = {QTS_AVAIL};
+   bool joined = false; // if set to true then pthread_detach should not be called on exit
+   // the next TID in the free list
+   std::atomic<int> next_free = {0};
 
    DLLLOCAL void cleanup();
 
-   DLLLOCAL void allocate(tid_node* tn, int stat = QTS_NA);
+   DLLLOCAL void allocate(int stat = QTS_NA);
 
    DLLLOCAL void activate(int tid, pthread_t n_ptid, QoreProgram* p, bool foreign = false);
 
@@ -95,63 +95,111 @@ public:
    }
 };
 
+// thread table statistics
+struct QoreThreadListInfo {
+   // the number of threads currently registered
+   unsigned threads;
+   // the highest number of threads registered at the same time
+   unsigned peak;
+   // the number of thread table entries currently allocated
+   unsigned capacity;
+   // the maximum number of thread table entries
+   unsigned max;
+   // the number of TIDs allocated
+   int64 allocations;
+   // the total and maximum time spent allocating TIDs in nanoseconds
+   int64 alloc_total_ns;
+   int64 alloc_max_ns;
+};
+
+// the thread table
+/* TIDs are allocated without locking: never-used TIDs in allocated segments are issued first, then released TIDs
+   are reused from a lock-free free list, and only when both are exhausted is a new segment allocated; segments are
+   never freed (not even when the process exits, since detached threads may still be running), so entries can be
+   accessed without locking by the thread that owns them
+*/
 class QoreThreadList {
 friend class QoreThreadListIterator;
-friend class tid_node;
 protected:
    mutable QoreThreadLock l;
-   unsigned num_threads;
-   ThreadEntry entry[MAX_QORE_THREADS];
+   std::atomic<unsigned> num_threads = {0};
+   std::atomic<unsigned> peak_threads = {0};
 
-   tid_node* tid_head, * tid_tail;
+   // thread table segments
+   std::atomic<ThreadEntry*> segment[QORE_THREAD_SEGMENTS];
+   // the number of entries in allocated segments
+   std::atomic<int> capacity = {0};
+   // serializes segment allocation
+   QoreThreadLock grow_lock;
 
    // current TID to be issued next
-   int current_tid;
+   std::atomic<int> current_tid = {1};
+
+   // the head of the free TID list; the low 32 bits hold the TID (0 = empty) and the high 32 bits hold a tag that is
+   // incremented with each update to avoid ABA problems
+   std::atomic<uint64_t> free_head = {0};
+
+   // allocation statistics
+   std::atomic<int64> allocations = {0};
+   std::atomic<int64> alloc_total_ns = {0};
+   std::atomic<int64> alloc_max_ns = {0};
 
    bool exiting;
 
+   DLLLOCAL ThreadEntry& getEntry(int tid) const {
+      assert(tid >= 0 && tid < capacity.load(std::memory_order_relaxed));
+      return segment[tid >> QORE_THREAD_SEGMENT_BITS].load(std::memory_order_acquire)[tid & QORE_THREAD_SEGMENT_MASK];
+   }
+
    DLLLOCAL void releaseIntern(int tid) {
       // NOTE: cannot safely call printd here, because normally the thread_data has been deleted
       //printf("DEBUG: ThreadList.releaseIntern() TID %d terminated\n", tid);
-      entry[tid].cleanup();
-      if (tid)
+      getEntry(tid).cleanup();
+      if (tid) {
+         pushFree(tid);
          --num_threads;
+      }
    }
 
-public:
-   DLLLOCAL QoreThreadList() : num_threads(0), tid_head(0), tid_tail(0), current_tid(1), exiting(false) {
+   // returns a TID from the free list or -1 if the list is empty
+   DLLLOCAL int popFree() {
+      uint64_t h = free_head.load(std::memory_order_acquire);
+      while (true) {
+         int tid = (int)(h & 0xffffffff);
+         if (!tid)
+            return -1;
+         // the entry cannot be freed, so this is safe even if another thread takes the TID first; in this case the
+         // tag will have changed and the CAS below fails
+         uint64_t nh = (((h >> 32) + 1) << 32) | (uint32_t)getEntry(tid).next_free.load(std::memory_order_relaxed);
+         if (free_head.compare_exchange_weak(h, nh, std::memory_order_acq_rel, std::memory_order_acquire))
+            return tid;
+      }
    }
 
-   DLLLOCAL int get(int status = QTS_NA) {
-      int tid = -1;
-      AutoLocker al(l);
+   DLLLOCAL void pushFree(int tid) {
+      ThreadEntry& te = getEntry(tid);
+      uint64_t h = free_head.load(std::memory_order_relaxed);
+      uint64_t nh;
+      do {
+         te.next_free.store((int)(h & 0xffffffff), std::memory_order_relaxed);
+         nh = (((h >> 32) + 1) << 32) | (uint32_t)tid;
+      } while (!free_head.compare_exchange_weak(h, nh, std::memory_order_release, std::memory_order_relaxed));
+   }
 
-      if (current_tid == MAX_QORE_THREADS) {
-         int i;
-         // scan thread_list for free entry
-         for (i = 1; i < MAX_QORE_THREADS; i++) {
-            if (entry[i].available()) {
-               tid = i;
-               goto finish;
-            }
-         }
-         if (i == MAX_QORE_THREADS)
-            return -1;
-      }
-      else
-         tid = current_tid++;
+   // allocates a TID; returns -1 if the thread table is full
+   DLLLOCAL int allocateTid();
 
-   finish:
-      entry[tid].allocate(new tid_node(tid), status);
-      ++num_threads;
-      //printf("t%d cs=0\n", tid);
+   // adds a segment to the thread table; returns -1 if the table is already at its maximum size
+   DLLLOCAL int grow();
 
-      return tid;
-   }
+public:
+   DLLLOCAL QoreThreadList();
+
+   DLLLOCAL int get(int status = QTS_NA);
 
    DLLLOCAL int getSignalThreadEntry() {
       AutoLocker al(l);
-      entry[0].allocate(0);
+      getEntry(0).allocate();
       return 0;
    }
 
@@ -162,7 +210,7 @@ public:
 
    DLLLOCAL int releaseReserved(int tid) {
       AutoLocker al(l);
-      if (entry[tid].status != QTS_RESERVED)
+      if (getEntry(tid).status != QTS_RESERVED)
          return -1;
 
       releaseIntern(tid);
@@ -171,13 +219,13 @@ public:
 
    DLLLOCAL void activate(int tid, pthread_t ptid = pthread_self(), QoreProgram* p = 0, bool foreign = false) {
       AutoLocker al(l);
-      entry[tid].activate(tid, ptid, p, foreign);
+      getEntry(tid).activate(tid, ptid, p, foreign);
    }
 
    DLLLOCAL void setStatus(int tid, int status) {
       AutoLocker al(l);
-      assert(entry[tid].status != status);
-      entry[tid].status = status;
+      assert(getEntry(tid).status != status);
+      getEntry(tid).status = status;
    }
 
    DLLLOCAL void deleteData(int tid);
@@ -189,17 +237,28 @@ public:
    DLLLOCAL int activateReserved(int tid) {
       AutoLocker al(l);
 
-      if (entry[tid].status != QTS_RESERVED)
+      if (getEntry(tid).status != QTS_RESERVED)
          return -1;
 
-      entry[tid].activate(tid, pthread_self(), 0, true);
+      getEntry(tid).activate(tid, pthread_self(), 0, true);
       return 0;
    }
 
+   // returns true if the TID has been issued at least once
+   DLLLOCAL bool validTid(int tid) const {
+      return tid >= 0 && tid < current_tid.load(std::memory_order_acquire);
+   }
+
    DLLLOCAL unsigned getNumThreads() const {
       return num_threads;
    }
 
+   DLLLOCAL static unsigned getMaxThreads() {
+      return MAX_QORE_THREADS;
+   }
+
+   DLLLOCAL void getInfo(QoreThreadListInfo& info) const;
+
    DLLLOCAL unsigned cancelAllActiveThreads();
 
 #ifdef QORE_RUNTIME_THREAD_STACK_TRACE
@@ -212,7 +271,7 @@ public:
    DLLLOCAL QoreListNode* getCallStackList();
 
    DLLLOCAL CallStack* getCallStack() {
-      return entry[gettid()].callStack;
+      return getEntry(gettid()).callStack;
    }
 #endif
 
@@ -222,23 +281,24 @@ DLLLOCAL extern QoreThreadList thread_list;
 
 class QoreThreadListIterator : public AutoLocker {
 protected:
-   tid_node* w;
+   int tid;
+   int end;
 
 public:
-   DLLLOCAL QoreThreadListIterator() : AutoLocker(thread_list.l), w(0) {
+   DLLLOCAL QoreThreadListIterator() : AutoLocker(thread_list.l), tid(0), end(thread_list.current_tid) {
    }
 
    DLLLOCAL bool next() {
-      do {
-         w = w ? w->next : thread_list.tid_head;
-      } while (w && (!w->tid || (thread_list.entry[w->tid].status != QTS_ACTIVE)));
-
-      return (bool)w;
+      while (++tid < end) {
+         if (thread_list.getEntry(tid).status == QTS_ACTIVE)
+            return true;
+      }
+      return false;
    }
 
    DLLLOCAL unsigned operator*() const {
-      assert(w);
-      return w->tid;
+      assert(tid > 0 && tid < end);
+      return tid;
    }
 };
 
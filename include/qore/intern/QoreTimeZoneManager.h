@@ -38,6 +38,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 
 #ifndef LOCALTIME_LOCATION
 #define LOCALTIME_LOCATION "/etc/localtime"
@@ -49,6 +50,8 @@
 
 DLLLOCAL extern const char *STATIC_UTC;
 
+class QoreFile;
+
 // transition info structure
 struct QoreTransitionInfo {
    int32_t     utcoff;  // UTC offset in seconds east (negative for west)
@@ -61,15 +64,43 @@ struct QoreTransitionInfo {
 typedef std::vector<QoreTransitionInfo> trans_vec_t;
 
 struct QoreLeapInfo {
-   int ttime; // transition time
+   int64 ttime; // transition time
    int total; // total correction after transition time
 };
 
 struct QoreDSTTransition {
-   int time;
+   int64 time;
    struct QoreTransitionInfo *trans;
 };
 
+// a POSIX TZ rule transition date: "Jn", "n" or "Mm.w.d" followed by an optional "/time"
+struct QorePosixTZDate {
+   char type;     // 'J': julian day without Feb 29, 'D': zero-based day of the year, 'M': month, week and day
+   int month,     // month (1 - 12) for 'M'
+      week,       // week of the month (1 - 5, 5 = last) for 'M'
+      day;        // day of the week (0 = Sunday) for 'M', otherwise the day of the year
+   int time;      // local time of the transition in seconds after midnight (can be negative or > 24h)
+};
+
+// the POSIX TZ rule in the footer of TZif version 2+ files (ex: "CET-1CEST,M3.5.0,M10.5.0/3")
+// used for all times after the last explicit transition
+struct QorePosixTZRule {
+   QoreTransitionInfo std_info,  // standard time
+      dst_info;                  // daylight savings time
+   bool has_dst;                 // if false, then only standard time is used
+   QorePosixTZDate start,        // start of daylight savings time in local standard time
+      end;                       // end of daylight savings time in local daylight savings time
+
+   // parses the rule; returns 0 for OK, -1 for error
+   DLLLOCAL int parse(const char* p);
+
+   // returns the transition info for the given time given as seconds from the epoch (1970-01-01Z)
+   DLLLOCAL const QoreTransitionInfo* get(int64 epoch_offset) const;
+
+   // gets the DST start and end times in seconds from the epoch for the given year
+   DLLLOCAL void getTransitions(int year, int64& dst_start, int64& dst_end) const;
+};
+
 class AbstractQoreZoneInfo {
 protected:
    // region or time zone locale name (i.e. "Europe/Prague" or "-06:00" for UTC - 06:00)
@@ -182,8 +213,6 @@ public:
 
 class QoreZoneInfo : public AbstractQoreZoneInfo {
 protected:
-   // first positive transition entry (after the epoch)
-   int first_pos;
    bool valid;
    const char *std_abbr;  // standard time abbreviation
 
@@ -198,6 +227,24 @@ protected:
    typedef std::vector<QoreLeapInfo> leap_vec_t;
    leap_vec_t leapinfo;
 
+   // standard time info used before the first transition
+   QoreTransitionInfo std_info;
+
+   // the POSIX TZ rule from the file footer for times after the last transition, if any
+   std::unique_ptr<QorePosixTZRule> rule;
+
+   // reads in the header counts and data block; returns 0 for OK, -1 for error (exception raised)
+   DLLLOCAL int readData(QoreFile& f, bool v2, ExceptionSink* xsink);
+
+   // reads in the POSIX TZ rule from the footer of a version 2+ file
+   DLLLOCAL void readFooter(QoreFile& f, const std::string& fn);
+
+   // returns the transition info for the given time given as seconds from the epoch (1970-01-01Z)
+   DLLLOCAL const QoreTransitionInfo* getTransitionInfo(int64 epoch_offset) const;
+
+   // fills the per-thread cache with the transitions in the UTC year of the given time
+   DLLLOCAL const QoreTransitionInfo* cacheYear(int64 epoch_offset) const;
+
    // returns the UTC offset and local time zone name for the given time given as seconds from the epoch (1970-01-01Z)
    DLLLOCAL virtual int getUTCOffsetImpl(int64 epoch_offset, bool &is_dst, const char *&zone_name) const;
 
@@ -0,0 +1,158 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreVariantCache.h
+
+    runtime function variant dispatch cache
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#ifndef _QORE_QOREVARIANTCACHE_H
+
+#define _QORE_QOREVARIANTCACHE_H
+
+#include <atomic>
+
+// the maximum number of argument type vectors cached for a function
+#define QORE_VARIANT_CACHE_ENTRIES 4
+// calls with more arguments than this are not cached
+#define QORE_VARIANT_CACHE_MAX_ARGS 6
+
+class AbstractQoreFunctionVariant;
+class qore_class_private;
+
+// identifies the inputs of a runtime variant match
+/* the result of QoreFunction::runtimeFindVariant() depends only on the runtime types of the arguments (including
+   the class of objects and the hashdecl or complex type of hashes and lists), the class context, the runtime parse
+   options, and whether only user variants are searched; classes, hashdecls and complex types are identified by
+   their addresses, which can be reused after a Program is deleted, so keys also hold the cache generation, and
+   entries from earlier generations never match
+*/
+struct QoreVariantCacheKey {
+    // the value of QoreVariantCache::generation when the key was set
+    unsigned gen;
+    const qore_class_private* class_ctx;
+    // the runtime class context; only set if an argument is an object, since private inheritance can then affect
+    // matching
+    const qore_class_private* runtime_class;
+    int64 ppo;
+    unsigned nargs;
+    bool only_user;
+    qore_type_t type[QORE_VARIANT_CACHE_MAX_ARGS];
+    const void* sub[QORE_VARIANT_CACHE_MAX_ARGS];
+
+    // sets up the key; returns false if the call cannot be cached (too many arguments, or references as arguments)
+    DLLLOCAL bool set(const QoreListNode* args, bool only_user, const qore_class_private* class_ctx, int64 ppo);
+
+    DLLLOCAL bool operator==(const QoreVariantCacheKey& other) const {
+        if (gen != other.gen || nargs != other.nargs || class_ctx != other.class_ctx || ppo != other.ppo || only_user != other.only_user
+            || runtime_class != other.runtime_class)
+            return false;
+        for (unsigned i = 0; i < nargs; ++i) {
+            if (type[i] != other.type[i] || sub[i] != other.sub[i])
+                return false;
+        }
+        return true;
+    }
+};
+
+struct QoreVariantCacheEntry {
+    QoreVariantCacheKey key;
+    const AbstractQoreFunctionVariant* variant;
+    // next entry in the retired list
+    QoreVariantCacheEntry* next;
+};
+
+// inline cache of runtime variant matches for a function
+/* the cache starts out empty, becomes monomorphic with the first match, polymorphic with up to
+   QORE_VARIANT_CACHE_ENTRIES matches, and megamorphic when a further match cannot be added, after which no more
+   entries are added; lookups are lock-free, and entries are only freed when the cache is destroyed, since other
+   threads may be reading them
+*/
+class QoreVariantCache {
+public:
+    DLLLOCAL QoreVariantCache() {
+        for (unsigned i = 0; i < QORE_VARIANT_CACHE_ENTRIES; ++i)
+            entry[i] = nullptr;
+    }
+
+    DLLLOCAL ~QoreVariantCache();
+
+    // returns the cached variant for the given key or nullptr if not cached
+    DLLLOCAL const AbstractQoreFunctionVariant* find(const QoreVariantCacheKey& key) const {
+        for (unsigned i = 0; i < QORE_VARIANT_CACHE_ENTRIES; ++i) {
+            const QoreVariantCacheEntry* e = entry[i].load(std::memory_order_acquire);
+            if (!e)
+                break;
+            if (e->key == key) {
+                hits.fetch_add(1, std::memory_order_relaxed);
+                return e->variant;
+            }
+        }
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    DLLLOCAL void add(const QoreVariantCacheKey& key, const AbstractQoreFunctionVariant* variant);
+
+    // called when the variants of the function change
+    DLLLOCAL void clear();
+
+    DLLLOCAL static void getInfo(int64& hits, int64& misses, int64& uncacheable, int64& megamorphic);
+
+    // invalidates all cached matches; must be called before a Program frees its classes, hashdecls and types
+    /* functions of builtin classes and builtin functions are shared by all Programs, so their caches can hold keys
+       with the addresses of objects of any Program
+    */
+    DLLLOCAL static void invalidate() {
+        generation.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    // the current cache generation
+    DLLLOCAL static std::atomic<unsigned> generation;
+
+    // global statistics
+    DLLLOCAL static std::atomic<int64> hits;
+    DLLLOCAL static std::atomic<int64> misses;
+    DLLLOCAL static std::atomic<int64> uncacheable;
+    DLLLOCAL static std::atomic<int64> megamorphic;
+
+private:
+    std::atomic<QoreVariantCacheEntry*> entry[QORE_VARIANT_CACHE_ENTRIES];
+    // entries removed by clear()
+    std::atomic<QoreVariantCacheEntry*> retired = {nullptr};
+    // set when the cache is megamorphic
+    std::atomic<bool> full = {false};
+
+    // adds an entry that is no longer in the cache to the retired list
+    DLLLOCAL void retire(QoreVariantCacheEntry* e);
+
+    DLLLOCAL QoreVariantCache(const QoreVariantCache&) = delete;
+    DLLLOCAL QoreVariantCache& operator=(const QoreVariantCache&) = delete;
+};
+
+#endif
@@ -55,6 +55,8 @@ public:
 private:
     QoreValue exp;
 
+    friend class QoreBytecodeCompiler;
+
     DLLLOCAL virtual int execImpl(QoreValue& return_value, ExceptionSink *xsink);
     DLLLOCAL virtual int parseInitImpl(LocalVar *oflag, int pflag = 0);
 };
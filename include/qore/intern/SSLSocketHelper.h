@@ -107,6 +107,11 @@ public:
    DLLLOCAL long verifyPeerCertificate() const;
 
    DLLLOCAL void setVerifyMode(int mode, bool accept_all_certs);
+
+   // returns the number of decrypted bytes buffered in the SSL object that can be read without socket I/O
+   DLLLOCAL int pending() const {
+      return ssl ? SSL_pending(ssl) : 0;
+   }
 };
 
 class SSLSocketReferenceHelper {
@@ -43,6 +43,7 @@
 // all definitions in this file are private to the library and subject to change
 class BCAList;
 class BCList;
+class QoreBytecode;
 
 class LVList {
 public:
@@ -112,6 +113,10 @@ protected:
     statement_list_t statement_list;
     block_list_t on_block_exit_list;
     LVList* lvars = nullptr;
+    // compiled bytecode for function and method bodies, if any
+    QoreBytecode* bc = nullptr;
+
+    friend class QoreBytecodeCompiler;
 
     // start must be the element before the start position
     DLLLOCAL int parseInitIntern(LocalVar* oflag, int pflag, statement_list_t::iterator start);
@@ -119,6 +124,9 @@ protected:
     DLLLOCAL bool hasLastReturn(AbstractStatement* as);
     DLLLOCAL void parseCheckReturn();
 
+    // compiles the body to bytecode if supported and enabled with PO_COMPILE_BYTECODE
+    DLLLOCAL void parseCompileBytecode(UserVariantBase* uvb);
+
     DLLLOCAL int execIntern(QoreValue& return_value, ExceptionSink* xsink);
 
     DLLLOCAL StatementBlock(qore_program_private_base* p);
@@ -32,8 +32,13 @@
 #ifndef _QORE_INTERN_THREADLOCALVARIABLEDATA_H
 #define _QORE_INTERN_THREADLOCALVARIABLEDATA_H
 
+#include <vector>
+
 class ThreadLocalVariableData : public ThreadLocalData<LocalVarValue> {
 public:
+    DLLLOCAL ThreadLocalVariableData() : fblock(curr) {
+    }
+
     // marks all variables as finalized on the stack
     DLLLOCAL void finalize(arg_vec_t*& cl) {
         ThreadLocalVariableData::iterator i(curr);
@@ -52,6 +57,10 @@ public:
         // then we uninstantiate
         while (curr->prev || curr->pos)
             uninstantiate(xsink);
+        frames.clear();
+        fblock = curr;
+        fpos = 0;
+        fdepth = 0;
     }
 
     DLLLOCAL LocalVarValue* instantiate() {
@@ -64,9 +73,16 @@ public:
                 curr = curr->next;
             }
         }
+        ++depth;
         return &curr->var[curr->pos++];
     }
 
+    // instantiates a variable and returns its slot relative to the start of the current frame
+    DLLLOCAL LocalVarValue* instantiate(int& slot) {
+        slot = (int)(depth - fdepth);
+        return instantiate();
+    }
+
     DLLLOCAL void uninstantiate(ExceptionSink* xsink) {
         uninstantiateIntern();
         curr->var[curr->pos].uninstantiate(xsink);
@@ -88,6 +104,28 @@ public:
             assert(curr);
         }
         --curr->pos;
+        --depth;
+    }
+
+    // finds the variable in the given slot of the current frame, falls back to a search by name if the slot does not
+    // hold the variable
+    DLLLOCAL LocalVarValue* find(const char* id, int slot) {
+        if (slot >= 0) {
+            Block* w = fblock;
+            int p = fpos + slot;
+            while (p >= QORE_THREAD_STACK_BLOCK) {
+                if (w == curr)
+                    return find(id);
+                w = w->next;
+                p -= QORE_THREAD_STACK_BLOCK;
+            }
+            if (w != curr || p < curr->pos) {
+                LocalVarValue* var = &w->var[p];
+                if (var->id == id && !var->skip && !var->frame_boundary)
+                    return var;
+            }
+        }
+        return find(id);
     }
 
     DLLLOCAL LocalVarValue* find(const char* id) {
@@ -122,12 +160,23 @@ public:
         //printd(5, "ThreadLocalVariableData::pushFrameBoundary(): fc:%d\n", frame_count);
         LocalVarValue* v = instantiate();
         v->setFrameBoundary();
+        // the new frame starts after the boundary marker
+        frames.push_back(frame_t {fblock, fpos, fdepth});
+        fblock = curr;
+        fpos = curr->pos;
+        fdepth = depth;
     }
 
     DLLLOCAL void popFrameBoundary() {
         assert(frame_count >= 0);
         --frame_count;
         //printd(5, "ThreadLocalVariableData::popFrameBoundary(): fc:%d\n", frame_count);
+        assert(!frames.empty());
+        const frame_t& f = frames.back();
+        fblock = f.block;
+        fpos = f.pos;
+        fdepth = f.depth;
+        frames.pop_back();
         uninstantiateIntern();
         assert(curr->var[curr->pos].frame_boundary);
         curr->var[curr->pos].frame_boundary = false;
@@ -139,6 +188,24 @@ public:
 
     // returns 0 = OK, 1 = no such variable, -1 exception setting variable
     DLLLOCAL int setVarValue(int frame, const char* name, const QoreValue& val, ExceptionSink* xsink);
+
+private:
+    // the start of a variable frame on the stack
+    struct frame_t {
+        Block* block;
+        int pos;
+        size_t depth;
+    };
+
+    // the start of enclosing frames
+    std::vector<frame_t> frames;
+    // the start of the current frame; the position may be equal to the block size if the frame starts in the next block
+    Block* fblock;
+    int fpos = 0;
+    // the number of entries on the stack below the current frame
+    size_t fdepth = 0;
+    // the total number of entries on the stack
+    size_t depth = 0;
 };
 
 #endif
@@ -33,6 +33,9 @@
 #define QTP_DEFAULT_RELEASE_MS 5000
 
 #include <deque>
+#include <vector>
+#include <atomic>
+#include <thread>
 #include <qore/qlist>
 
 class ThreadTask;
@@ -41,39 +44,176 @@ class ThreadPoolThread;
 typedef std::deque<ThreadTask*> taskq_t;
 typedef qlist<ThreadPoolThread*> tplist_t;
 
+// a set of tasks executed cooperatively by pool threads and the submitting thread
+/* pool threads and the waiting thread claim tasks with an atomic index, so a batch of any size is queued
+   in the pool with only as many queue entries as threads that can work on it in parallel
+*/
+class ThreadTaskBatch {
+public:
+    // creates a batch executing the given list of call references
+    DLLLOCAL ThreadTaskBatch(const QoreListNode* l) : ThreadTaskBatch(l->size()) {
+        tasks = l->listRefSelf();
+    }
+
+    DLLLOCAL virtual ~ThreadTaskBatch() {
+    }
+
+    DLLLOCAL void ref() {
+        refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    DLLLOCAL void deref(ExceptionSink* xsink) {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            for (auto& i : results)
+                i.discard(xsink);
+            cleanup(xsink);
+            delete this;
+        }
+    }
+
+    DLLLOCAL size_t size() const {
+        return results.size();
+    }
+
+    // executes unclaimed tasks in the batch until there are none left
+    DLLLOCAL void run() {
+        size_t n = results.size();
+        while (true) {
+            size_t i = next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= n)
+                break;
+
+            ExceptionSink xsink;
+            QoreValue rv = runTask(i, &xsink);
+
+            AutoLocker al(m);
+            if (xsink) {
+                rv.discard(&xsink);
+                rv = QoreValue();
+                // only keep the exception from the first task in submission order
+                if (i < err_index) {
+                    err.clear();
+                    err.assimilate(xsink);
+                    err_index = i;
+                }
+                else
+                    xsink.clear();
+            }
+            results[i] = rv;
+            if (!--remaining)
+                cond.broadcast();
+        }
+    }
+
+    // helps execute the batch, waits for all tasks to complete, and returns the results in submission order
+    /* if any task threw an exception, the exception from the first such task is raised in the caller's thread
+     */
+    DLLLOCAL QoreListNode* wait(ExceptionSink* xsink) {
+        run();
+
+        AutoLocker al(m);
+        while (remaining)
+            cond.wait(m);
+
+        if (err_index < results.size()) {
+            xsink->assimilate(err);
+            return nullptr;
+        }
+
+        ReferenceHolder<QoreListNode> rv(new QoreListNode(autoTypeInfo), xsink);
+        for (auto& i : results) {
+            rv->push(i, xsink);
+            i = QoreValue();
+        }
+        return rv.release();
+    }
+
+protected:
+    // creates a batch of the given number of tasks executed with runTask()
+    DLLLOCAL ThreadTaskBatch(size_t n) : results(n), remaining(n), err_index(n) {
+    }
+
+    // executes the task with the given index and returns its result
+    DLLLOCAL virtual QoreValue runTask(size_t i, ExceptionSink* xsink) {
+        return tasks->retrieveEntry(i).get<const ResolvedCallReferenceNode>()->execValue(nullptr, xsink);
+    }
+
+    // releases any data referenced by the tasks
+    DLLLOCAL virtual void cleanup(ExceptionSink* xsink) {
+        if (tasks)
+            tasks->deref(xsink);
+    }
+
+private:
+    // list of call references
+    QoreListNode* tasks = nullptr;
+    // results in submission order
+    std::vector<QoreValue> results;
+    // index of the next task to execute
+    std::atomic<size_t> next = {0};
+    // reference count
+    std::atomic<unsigned> refs = {1};
+
+    // the following members are protected by the mutex
+    QoreThreadLock m;
+    QoreCondition cond;
+    // number of tasks not yet finished
+    size_t remaining;
+    // index of the first task that raised an exception
+    size_t err_index;
+    // exception from the first task that raised an exception
+    ExceptionSink err;
+};
+
 class ThreadTask {
 public:
     DLLLOCAL ThreadTask(ResolvedCallReferenceNode* c, ResolvedCallReferenceNode* cc) : code(c), cancelCode(cc) {
     }
 
+    // creates a task that works on the given batch; the caller's reference to the batch is used
+    DLLLOCAL ThreadTask(ThreadTaskBatch* b) : batch(b) {
+    }
+
     DLLLOCAL ~ThreadTask() {
         assert(!code);
         assert(!cancelCode);
+        assert(!batch);
     }
 
     DLLLOCAL void del(ExceptionSink* xsink) {
-        code->deref(xsink);
-        if (cancelCode)
-            cancelCode->deref(xsink);
+        if (batch)
+            batch->deref(xsink);
+        else {
+            code->deref(xsink);
+            if (cancelCode)
+                cancelCode->deref(xsink);
+        }
 #ifdef DEBUG
         code = nullptr;
         cancelCode = nullptr;
+        batch = nullptr;
 #endif
         delete this;
     }
 
     DLLLOCAL QoreValue run(ExceptionSink* xsink) {
+        if (batch) {
+            batch->run();
+            return QoreValue();
+        }
         return code->execValue(0, xsink);
     }
 
+    // batch tasks are not canceled; any remaining tasks are executed by the thread waiting on the batch
     DLLLOCAL void cancel(ExceptionSink* xsink) {
         if (cancelCode)
             cancelCode->execValue(0, xsink).discard(xsink);
     }
 
 protected:
-    ResolvedCallReferenceNode* code;
-    ResolvedCallReferenceNode* cancelCode;
+    ResolvedCallReferenceNode* code = nullptr;
+    ResolvedCallReferenceNode* cancelCode = nullptr;
+    ThreadTaskBatch* batch = nullptr;
 };
 
 class ThreadTaskHolder {
@@ -238,15 +378,33 @@ protected:
       return 0;
    }
 
+   // queues the given tasks; if the pool has been stopped, the tasks are deleted and an exception is raised
+   DLLLOCAL int queueTasks(taskq_t& tl, const char* meth, ExceptionSink* xsink) {
+      {
+         AutoLocker al(m);
+         if (!checkStopUnlocked(meth, xsink)) {
+            if (q.empty() && !tl.empty())
+               cond.signal();
+            q.insert(q.end(), tl.begin(), tl.end());
+            return 0;
+         }
+      }
+
+      for (auto& i : tl)
+         i->del(xsink);
+      return -1;
+   }
+
    DLLLOCAL ThreadPoolThread* getThreadUnlocked(ExceptionSink* xsink) {
       assert(xsink);
-      while (!stopflag && fh.empty() && max && (int)ah.size() == max) {
+      while (!stopflag && !q.empty() && fh.empty() && max && (int)ah.size() == max) {
          waiting = true;
          cond.wait(m);
          waiting = false;
       }
 
-      if (stopflag)
+      // the queue may have been drained in the meantime by running threads taking tasks directly in done()
+      if (stopflag || q.empty())
          return 0;
 
       ThreadPoolThread* tpt;
@@ -348,13 +506,61 @@ public:
       return 0;
    }
 
+   // submits all tasks with a single acquisition of the pool lock
+   DLLLOCAL int submitBatch(const QoreListNode* l, const ResolvedCallReferenceNode* cc, ExceptionSink* xsink) {
+      taskq_t tl;
+      // optimistically create the task objects outside the lock
+      ConstListIterator li(l);
+      while (li.next()) {
+         const ResolvedCallReferenceNode* c = li.getValue().get<const ResolvedCallReferenceNode>();
+         tl.push_back(new ThreadTask(c->refRefSelf(), cc ? cc->refRefSelf() : nullptr));
+      }
+
+      return queueTasks(tl, "submitBatch", xsink);
+   }
+
+   // executes all tasks in the pool and in the calling thread and returns the results in submission order
+   DLLLOCAL QoreListNode* runBatch(const QoreListNode* l, ExceptionSink* xsink) {
+      ThreadTaskBatch* batch = new ThreadTaskBatch(l);
+      if (queueBatch(batch, xsink)) {
+         batch->deref(xsink);
+         return nullptr;
+      }
+
+      QoreListNode* rv = batch->wait(xsink);
+      batch->deref(xsink);
+      return rv;
+   }
+
+   // queues pool tasks to help execute the given batch; the caller must then call ThreadTaskBatch::wait()
+   /* returns -1 if the pool is being destroyed, in which case an exception is raised
+    */
+   DLLLOCAL int queueBatch(ThreadTaskBatch* batch, ExceptionSink* xsink) {
+      // the calling thread also executes tasks, so at most size - 1 pool threads are needed; the number of pool tasks
+      // is further limited by the number of CPUs and the maximum pool size
+      size_t helpers = batch->size() ? batch->size() - 1 : 0;
+      unsigned cpus = std::thread::hardware_concurrency();
+      if (cpus && helpers >= cpus)
+         helpers = cpus - 1;
+      if (max > 0 && helpers > (size_t)max)
+         helpers = max;
+
+      taskq_t tl;
+      for (size_t i = 0; i < helpers; ++i) {
+         batch->ref();
+         tl.push_back(new ThreadTask(batch));
+      }
+      return queueTasks(tl, "runBatch", xsink);
+   }
+
    DLLLOCAL void threadCounts(int& idle, int& running) {
       AutoLocker al(m);
       idle = fh.size();
       running = ah.size();
    }
 
-   DLLLOCAL int done(ThreadPoolThread* tpt) {
+   // called by a thread when its task is complete; the thread's next task is returned in "next" if any is queued
+   DLLLOCAL int done(ThreadPoolThread* tpt, ThreadTask*& next) {
       {
          AutoLocker al(m);
          // allow the thread to be removed from the active list by ThreadPool::worker() to avoid race conditions
@@ -362,6 +568,14 @@ public:
             return 0;
 
          if (!confirm) {
+            // take the next task directly instead of returning to the free list and waiting for ThreadPool::worker()
+            // to hand it over
+            if (!q.empty()) {
+               next = q.front();
+               q.pop_front();
+               return 0;
+            }
+
             tplist_t::iterator i = tpt->getPos();
             ah.erase(i);
 
@@ -381,4 +595,13 @@ public:
    DLLLOCAL void worker(ExceptionSink* xsink);
 };
 
+// returns a referenced pointer to the shared internal pool used for parallel list evaluation
+/* returns nullptr if the pool could not be created or has been stopped for library shutdown; in that case the caller
+   executes all tasks itself
+*/
+DLLLOCAL ThreadPool* qore_get_shared_thread_pool();
+
+// stops the shared internal pool; after this call parallel evaluation is carried out in the calling thread
+DLLLOCAL void qore_stop_shared_thread_pool();
+
 #endif
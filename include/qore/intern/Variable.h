@@ -103,7 +103,7 @@ private:
     const QoreProgramLocation* loc;      // location of the initial definition
     QoreLValue<qore_gvar_ref_u> val;
     std::string name;
-    mutable QoreVarRWLock rwl;
+    mutable ReadOptimizedVarRWLock rwl;
     QoreParseTypeInfo* parseTypeInfo;
     const QoreTypeInfo* typeInfo;
     const QoreTypeInfo* refTypeInfo = nullptr;
@@ -34,5 +34,8 @@
 #define QORE_LIB_MISC_H
 
 DLLLOCAL void init_misc_functions(QoreNamespace& ns);
+DLLLOCAL TypedHashDecl* init_hashdecl_VariantCacheInfo(QoreNamespace& ns);
+DLLLOCAL TypedHashDecl* init_hashdecl_MemorySizeClassInfo(QoreNamespace& ns);
+DLLLOCAL TypedHashDecl* init_hashdecl_MemoryStats(QoreNamespace& ns);
 
 #endif
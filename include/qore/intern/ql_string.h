@@ -34,5 +34,6 @@
 #define QORE_LIB_STRING_H
 
 DLLLOCAL void init_string_functions(QoreNamespace& ns);
+DLLLOCAL TypedHashDecl* init_hashdecl_RegexCacheInfo(QoreNamespace& ns);
 
 #endif
@@ -37,5 +37,6 @@
 
 DLLLOCAL void init_thread_functions(QoreNamespace& ns);
 DLLLOCAL TypedHashDecl* init_hashdecl_CallStackInfo(QoreNamespace& ns);
+DLLLOCAL TypedHashDecl* init_hashdecl_ThreadListInfo(QoreNamespace& ns);
 
 #endif
@@ -59,6 +59,7 @@ struct dbi_driver_stmt {
     q_dbi_stmt_fetch_row_t fetch_row = nullptr;
     q_dbi_stmt_fetch_rows_t fetch_rows = nullptr;
     q_dbi_stmt_fetch_columns_t fetch_columns = nullptr;
+    q_dbi_stmt_fetch_block_t fetch_block = nullptr;
     q_dbi_stmt_fetch_row_t describe = nullptr;
     q_dbi_stmt_next_t next = nullptr;
     q_dbi_stmt_define_t define = nullptr;
@@ -339,6 +340,15 @@ struct qore_dbi_private {
         return f.stmt.fetch_columns(stmt, rows, xsink);
     }
 
+    DLLLOCAL bool hasStmtFetchBlock() const {
+        return (bool)f.stmt.fetch_block;
+    }
+
+    DLLLOCAL int stmt_fetch_block(SQLStatement* stmt, SQLColumnBlock& block, int rows, ExceptionSink* xsink) const {
+        assert(f.stmt.fetch_block);
+        return f.stmt.fetch_block(stmt, block, rows, xsink);
+    }
+
     DLLLOCAL QoreHashNode* stmt_describe(SQLStatement* stmt, ExceptionSink* xsink) const {
         if (!f.stmt.describe) {
             xsink->raiseException("DBI-DESCRIBE-ERROR", "this driver does not implement the SQLStatement::describe() method");
@@ -32,18 +32,79 @@
 #ifndef _QORE_QORELISTPRIVATE_H
 #define _QORE_QORELISTPRIVATE_H
 
+#include "qore/intern/QoreSlabAllocator.h"
+
 #include <string.h>
 
+#include <atomic>
+
 typedef ReferenceHolder<QoreListNode> safe_qorelist_t;
 
 #define LIST_PAD   15
 
+//! the number of bits in a list index giving the offset in a storage chunk
+#define QORE_LIST_CHUNK_BITS 6
+//! the number of entries in a full list storage chunk
+#define QORE_LIST_CHUNK_SIZE (1 << QORE_LIST_CHUNK_BITS)
+#define QORE_LIST_CHUNK_MASK (QORE_LIST_CHUNK_SIZE - 1)
+
+//! a reference-counted block of list entries
+/** chunks are shared between copies of lists with no values that need scanning for recursive references; a list
+    copies a shared chunk before modifying it, so shared chunks are never modified
+*/
+struct qore_list_chunk {
+    std::atomic_int refs;
+    // the number of entries allocated in the chunk
+    unsigned allocated;
+
+    DLLLOCAL qore_list_chunk(unsigned allocated) : refs(1), allocated(allocated) {
+    }
+
+    //! returns the entries following the chunk header
+    DLLLOCAL QoreValue* entry() {
+        return reinterpret_cast<QoreValue*>(this + 1);
+    }
+
+    DLLLOCAL bool isShared() const {
+        return refs.load(std::memory_order_acquire) > 1;
+    }
+
+    DLLLOCAL void ref() {
+        refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //! returns true if the last reference was released
+    DLLLOCAL bool deref() {
+        return refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    DLLLOCAL static qore_list_chunk* create(unsigned allocated) {
+        void* p = malloc(sizeof(qore_list_chunk) + sizeof(QoreValue) * allocated);
+        return ::new (p) qore_list_chunk(allocated);
+    }
+
+    //! resizes an unshared chunk
+    DLLLOCAL qore_list_chunk* resize(unsigned n) {
+        assert(!isShared());
+        qore_list_chunk* c = reinterpret_cast<qore_list_chunk*>(realloc(this,
+            sizeof(qore_list_chunk) + sizeof(QoreValue) * n));
+        c->allocated = n;
+        return c;
+    }
+};
+
 struct qore_list_private {
-    QoreValue* entry = nullptr;
+    // entry storage: a table of chunks where all chunks except the last have QORE_LIST_CHUNK_SIZE entries;
+    // lists with one chunk use the inline table
+    qore_list_chunk** chunk = &chunk0;
+    size_t chunks = 0;
+    size_t chunk_table_size = 1;
     size_t length = 0;
+    // the total number of entries allocated in all chunks
     size_t allocated = 0;
     unsigned obj_count = 0;
     const QoreTypeInfo* complexTypeInfo = nullptr;
+    qore_list_chunk* chunk0 = nullptr;
     bool finalized : 1;
     bool vlist : 1;
 
@@ -53,9 +114,20 @@ struct qore_list_private {
     DLLLOCAL ~qore_list_private() {
         assert(!length);
 
-        if (entry) {
-            free(entry);
+        for (size_t i = 0; i < chunks; ++i) {
+            releaseChunk(chunk[i], 0, nullptr);
         }
+        if (chunk != &chunk0) {
+            free(chunk);
+        }
+    }
+
+    DLLLOCAL static void* operator new(size_t size) {
+        return q_slab_alloc(size);
+    }
+
+    DLLLOCAL static void operator delete(void* p, size_t size) {
+        q_slab_free(p, size);
     }
 
     DLLLOCAL const QoreTypeInfo* getValueTypeInfo() const {
@@ -107,18 +179,37 @@ struct qore_list_private {
         QoreListNode* l = new QoreListNode;
         l->priv->reserve(length);
         for (size_t i = 0; i < length; ++i) {
-            l->priv->pushIntern(copy_strip_complex_types(entry[i]));
+            l->priv->pushIntern(copy_strip_complex_types(entry(i)));
         }
         return l;
     }
 
     DLLLOCAL void copyIntern(qore_list_private& l) const {
+        // lists without values that need scanning share their storage with the copy
+        if (!obj_count && length) {
+            l.shareEntries(*this);
+            return;
+        }
         l.reserve(length);
         for (size_t i = 0; i < length; ++i) {
-            l.pushIntern(entry[i].refSelf());
+            l.pushIntern(entry(i).refSelf());
         }
     }
 
+    //! shares the storage of the given list; this list must be empty
+    DLLLOCAL void shareEntries(const qore_list_private& l) {
+        assert(!length && !chunks);
+        assert(!l.obj_count);
+        size_t n = ((l.length - 1) >> QORE_LIST_CHUNK_BITS) + 1;
+        growChunkTable(n);
+        for (size_t i = 0; i < n; ++i) {
+            (chunk[i] = l.chunk[i])->ref();
+        }
+        chunks = n;
+        length = l.length;
+        allocated = ((n - 1) << QORE_LIST_CHUNK_BITS) + chunk[n - 1]->allocated;
+    }
+
     DLLLOCAL QoreListNode* concatenate(const QoreListNode* l, ExceptionSink* xsink) const {
         bool strip = !QoreTypeInfo::equal(complexTypeInfo, l->priv->complexTypeInfo);
         ReferenceHolder<QoreListNode> rv(copy(strip), xsink);
@@ -145,7 +236,7 @@ struct qore_list_private {
         rv->priv->pushIntern(e);
 
         for (size_t i = 0; i < length; ++i) {
-            QoreValue v = entry[i];
+            QoreValue v = entry(i);
             if (strip) {
                 v = copy_strip_complex_types(v);
             }
@@ -235,8 +326,9 @@ struct qore_list_private {
 
     QoreValue spliceSingle(size_t offset) {
         assert(offset < length);
+        makeUnique();
 
-        QoreValue rv = entry[offset];
+        QoreValue rv = slot(offset);
         if (needs_scan(rv)) {
             incScanCount(-1);
         }
@@ -244,12 +336,12 @@ struct qore_list_private {
         size_t end = offset + 1;
 
         if (end != length) {
-            memmove(entry + offset, entry + end, sizeof(QoreValue) * (length - end));
+            moveEntries(offset, end, length - end);
             // zero out trailing entries
             zeroEntries(length - 1, length);
         }
         else // set last entry to 0
-            entry[end - 1] = QoreValue();
+            slot(end - 1) = QoreValue();
 
         resize(length - 1);
 
@@ -266,21 +358,23 @@ struct qore_list_private {
         else
             end = offset + len;
 
+        makeUnique();
+
         QoreListNode* rv = extract ? getCopy() : nullptr;
 
         // dereference all entries that will be removed or add to return value list
         for (size_t i = offset; i < end; i++) {
-            removeEntry(entry[i], rv);
+            removeEntry(slot(i), rv);
         }
 
         // move down entries if necessary
         if (end != length) {
-            memmove(entry + offset, entry + end, sizeof(QoreValue) * (length - end));
+            moveEntries(offset, end, length - end);
             // zero out trailing entries
             zeroEntries(length - len, length);
         }
         else // set last entry to 0
-            entry[end - 1] = QoreValue();
+            slot(end - 1) = QoreValue();
 
         resize(length - len);
 
@@ -297,11 +391,11 @@ struct qore_list_private {
             holder = tmp = sl->getCopy();
             tmp->priv->reserve(sl->length);
             for (size_t i = 0; i < sl->length; ++i) {
-                ValueHolder eh(sl->entry[i].refSelf(), xsink);
+                ValueHolder eh(sl->entry(i).refSelf(), xsink);
                 if (checkVal(eh, xsink)) {
                     return nullptr;
                 }
-                tmp->priv->entry[i] = eh.release();
+                tmp->priv->slot(i) = eh.release();
                 ++tmp->priv->length;
             }
         }
@@ -321,11 +415,13 @@ struct qore_list_private {
         else
             end = offset + len;
 
+        makeUnique();
+
         QoreListNode* rv = extract ? getCopy() : nullptr;
 
         // dereference all entries that will be removed or add to return value list
         for (size_t i = offset; i < end; i++) {
-            removeEntry(entry[i], rv);
+            removeEntry(slot(i), rv);
         }
 
         // get number of entries to insert
@@ -336,10 +432,10 @@ struct qore_list_private {
             resize(length - len + n);
             // move trailing entries forward if necessary
             if (end != ol)
-                memmove(entry + (end - len + n), entry + end, sizeof(QoreValue) * (ol - end));
+                moveEntries(end - len + n, end, ol - end);
         }
         else if (len > n) { // make list smaller
-            memmove(entry + offset + n, entry + offset + len, sizeof(QoreValue) * (length - offset - n));
+            moveEntries(offset + n, offset + len, length - offset - n);
             // zero out trailing entries
             zeroEntries(length - (len - n), length);
             // resize list
@@ -348,18 +444,18 @@ struct qore_list_private {
 
         // add in new entries
         if (l.getType() != NT_LIST) {
-            entry[offset] = holder.release();
+            slot(offset) = holder.release();
             if (needs_scan(l))
                 incScanCount(1);
         }
         else {
             qore_list_private* lst = holder->get<const QoreListNode>()->priv;
             for (size_t i = 0; i < n; ++i) {
-                QoreValue v = lst->entry[i];
-                lst->entry[i] = QoreValue();
+                QoreValue v = lst->slot(i);
+                lst->slot(i) = QoreValue();
                 if (needs_scan(v))
                     incScanCount(1);
-                entry[offset + i] = v;
+                slot(offset + i) = v;
             }
             lst->length = 0;
         }
@@ -371,15 +467,16 @@ struct qore_list_private {
         if (num >= length) {
             resize(num + 1);
         }
-        return entry[num];
+        return entryRef(num);
     }
 
     DLLLOCAL QoreValue getAndClear(size_t i) {
         if (i >= length) {
             return QoreValue();
         }
-        QoreValue rv = entry[i];
-        entry[i] = QoreValue();
+        QoreValue& p = entryRef(i);
+        QoreValue rv = p;
+        p = QoreValue();
 
         if (needs_scan(rv)) {
             incScanCount(-1);
@@ -430,8 +527,9 @@ struct qore_list_private {
             return QoreValue();
         }
 
-        QoreValue rv = entry[offset];
-        entry[offset].assignNothing();
+        QoreValue& p = entryRef(offset);
+        QoreValue rv = p;
+        p.assignNothing();
 
         if (needs_scan(rv)) {
             --obj_count;
@@ -445,24 +543,20 @@ struct qore_list_private {
             return;
         // make larger
         if (num >= allocated) {
-            size_t d = num >> 2;
-            allocated = num + (d < LIST_PAD ? LIST_PAD : d);
-            entry = (QoreValue*)realloc(entry, sizeof(QoreValue) * allocated);
+            grow(num);
         }
     }
 
     DLLLOCAL void resize(size_t num) {
         if (num < length) { // make smaller
-            //entry = (QoreValue*)realloc(entry, sizeof(QoreValue*) * num);
+            // the caller has already moved or cleared the trailing entries
             length = num;
             return;
         }
         // make larger
         if (num >= length) {
             if (num >= allocated) {
-                size_t d = num >> 2;
-                allocated = num + (d < LIST_PAD ? LIST_PAD : d);
-                entry = (QoreValue*)realloc(entry, sizeof(QoreValue) * allocated);
+                grow(num);
             }
             zeroEntries(length, num);
         }
@@ -471,10 +565,84 @@ struct qore_list_private {
 
     DLLLOCAL void zeroEntries(size_t start, size_t end) {
         for (size_t i = start; i < end; ++i) {
-            entry[i] = QoreValue();
+            entryRef(i) = QoreValue();
         }
     }
 
+    //! returns the given entry for reading
+    DLLLOCAL const QoreValue& entry(size_t i) const {
+        assert(i < allocated);
+        return chunk[i >> QORE_LIST_CHUNK_BITS]->entry()[i & QORE_LIST_CHUNK_MASK];
+    }
+
+    //! returns the given entry for writing, copying its storage chunk first if it's shared with another list
+    DLLLOCAL QoreValue& entryRef(size_t i) {
+        assert(i < allocated);
+        size_t ci = i >> QORE_LIST_CHUNK_BITS;
+        if (chunk[ci]->isShared()) {
+            unshareChunk(ci);
+        }
+        return chunk[ci]->entry()[i & QORE_LIST_CHUNK_MASK];
+    }
+
+    //! returns the given entry for writing; the entry's storage chunk must not be shared
+    DLLLOCAL QoreValue& slot(size_t i) {
+        assert(i < allocated);
+        assert(!chunk[i >> QORE_LIST_CHUNK_BITS]->isShared());
+        return chunk[i >> QORE_LIST_CHUNK_BITS]->entry()[i & QORE_LIST_CHUNK_MASK];
+    }
+
+    //! copies all storage chunks shared with other lists
+    DLLLOCAL void makeUnique() {
+        for (size_t i = 0; i < chunks; ++i) {
+            if (chunk[i]->isShared()) {
+                unshareChunk(i);
+            }
+        }
+    }
+
+    //! moves entries like memmove(); the storage must not be shared
+    DLLLOCAL void moveEntries(size_t dst, size_t src, size_t n) {
+        if (dst < src) {
+            while (n) {
+                size_t k = segmentSize(n, QORE_LIST_CHUNK_SIZE - (dst & QORE_LIST_CHUNK_MASK),
+                    QORE_LIST_CHUNK_SIZE - (src & QORE_LIST_CHUNK_MASK));
+                memmove(&slot(dst), &slot(src), sizeof(QoreValue) * k);
+                dst += k;
+                src += k;
+                n -= k;
+            }
+        }
+        else if (dst > src) {
+            // move from the end
+            dst += n;
+            src += n;
+            while (n) {
+                size_t k = segmentSize(n, ((dst - 1) & QORE_LIST_CHUNK_MASK) + 1,
+                    ((src - 1) & QORE_LIST_CHUNK_MASK) + 1);
+                dst -= k;
+                src -= k;
+                n -= k;
+                memmove(&slot(dst), &slot(src), sizeof(QoreValue) * k);
+            }
+        }
+    }
+
+    //! returns the entries in a contiguous buffer, or nullptr if the list is stored in more than one chunk
+    DLLLOCAL QoreValue* getFlatEntries() {
+        makeUnique();
+        return chunks == 1 ? chunk[0]->entry() : nullptr;
+    }
+
+    //! dereferences all entries and releases the storage
+    DLLLOCAL void releaseEntries(ExceptionSink* xsink) {
+        for (size_t i = 0; i < chunks; ++i) {
+            releaseChunk(chunk[i], getChunkLength(i), xsink);
+        }
+        chunks = 0;
+        allocated = 0;
+    }
+
     DLLLOCAL void removeEntry(QoreValue& v, QoreListNode*& rv) {
         if (needs_scan(v)) {
             incScanCount(-1);
@@ -486,11 +654,8 @@ struct qore_list_private {
 
     DLLLOCAL int getLValue(size_t ind, LValueHelper& lvh, bool for_remove, ExceptionSink* xsink);
 
-    // mergesort for controlled and interruptible sorts (stable)
-    DLLLOCAL int mergesort(const ResolvedCallReferenceNode* fr, bool ascending, ExceptionSink* xsink);
-
-    // quicksort for controlled and interruptible sorts (unstable)
-    DLLLOCAL int qsort(const ResolvedCallReferenceNode* fr, size_t left, size_t right, bool ascending, ExceptionSink* xsink);
+    // sorts the list in place with an optional callback; stable sorts use a merge sort, unstable sorts an introsort
+    DLLLOCAL int sort(const ResolvedCallReferenceNode* fr, bool ascending, bool stable, ExceptionSink* xsink);
 
     DLLLOCAL void incScanCount(int dt) {
         assert(dt);
@@ -534,6 +699,104 @@ struct qore_list_private {
     DLLLOCAL static void incScanCount(const QoreListNode& l, int dt) {
         l.priv->incScanCount(dt);
     }
+
+private:
+    DLLLOCAL static size_t segmentSize(size_t n, size_t a, size_t b) {
+        if (a < n)
+            n = a;
+        return b < n ? b : n;
+    }
+
+    //! returns the number of valid entries in the given chunk
+    DLLLOCAL size_t getChunkLength(size_t ci) const {
+        size_t start = ci << QORE_LIST_CHUNK_BITS;
+        if (length <= start)
+            return 0;
+        size_t n = length - start;
+        return n > QORE_LIST_CHUNK_SIZE ? QORE_LIST_CHUNK_SIZE : n;
+    }
+
+    //! releases a reference to a chunk; the entries are dereferenced and the chunk freed with the last reference
+    DLLLOCAL static void releaseChunk(qore_list_chunk* c, size_t len, ExceptionSink* xsink) {
+        if (c->deref()) {
+            QoreValue* e = c->entry();
+            for (size_t i = 0; i < len; ++i) {
+                e[i].discard(xsink);
+            }
+            free(c);
+        }
+    }
+
+    //! replaces a shared chunk with a private copy with at least the given size
+    DLLLOCAL void unshareChunk(size_t ci, unsigned size = 0) {
+        qore_list_chunk* c = chunk[ci];
+        qore_list_chunk* nc = qore_list_chunk::create(size > c->allocated ? size : c->allocated);
+        size_t len = getChunkLength(ci);
+        QoreValue* src = c->entry();
+        QoreValue* dst = nc->entry();
+        for (size_t i = 0; i < len; ++i) {
+            dst[i] = src[i].refSelf();
+        }
+        chunk[ci] = nc;
+        // shared chunks never hold values that need scanning, so no exception is possible here
+        releaseChunk(c, len, nullptr);
+    }
+
+    //! ensures that the given chunk has at least the given size
+    DLLLOCAL void resizeChunk(size_t ci, unsigned size) {
+        if (ci == chunks) {
+            growChunkTable(ci + 1);
+            chunk[ci] = qore_list_chunk::create(size);
+            ++chunks;
+            return;
+        }
+        qore_list_chunk* c = chunk[ci];
+        if (c->allocated >= size)
+            return;
+        if (c->isShared())
+            unshareChunk(ci, size);
+        else
+            chunk[ci] = c->resize(size);
+    }
+
+    DLLLOCAL void growChunkTable(size_t n) {
+        if (n <= chunk_table_size)
+            return;
+        size_t size = chunk_table_size << 1;
+        while (size < n)
+            size <<= 1;
+        if (chunk == &chunk0) {
+            chunk = (qore_list_chunk**)malloc(sizeof(qore_list_chunk*) * size);
+            chunk[0] = chunk0;
+        }
+        else
+            chunk = (qore_list_chunk**)realloc(chunk, sizeof(qore_list_chunk*) * size);
+        chunk_table_size = size;
+    }
+
+    //! grows the storage so that more than "num" entries are allocated
+    DLLLOCAL void grow(size_t num) {
+        assert(num >= allocated);
+        if (num < QORE_LIST_CHUNK_SIZE) {
+            // lists with a single chunk grow like a flat array
+            size_t d = num >> 2;
+            size_t size = num + (d < LIST_PAD ? LIST_PAD : d);
+            if (size > QORE_LIST_CHUNK_SIZE)
+                size = QORE_LIST_CHUNK_SIZE;
+            resizeChunk(0, size);
+            allocated = size;
+            return;
+        }
+        // fill up the last chunk and add full chunks
+        if (chunks)
+            resizeChunk(chunks - 1, QORE_LIST_CHUNK_SIZE);
+        size_t n = (num >> QORE_LIST_CHUNK_BITS) + 1;
+        growChunkTable(n);
+        while (chunks < n) {
+            chunk[chunks++] = qore_list_chunk::create(QORE_LIST_CHUNK_SIZE);
+        }
+        allocated = chunks << QORE_LIST_CHUNK_BITS;
+    }
 };
 
 #endif
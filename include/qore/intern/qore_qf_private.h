@@ -38,6 +38,7 @@
 #endif
 
 #include "qore/intern/StringReaderHelper.h"
+#include "qore/intern/QoreMemoryMap.h"
 
 #include <unistd.h>
 #include <sys/types.h>
@@ -63,6 +64,21 @@
 #define DEFAULT_FILE_BUFSIZE 16384
 #endif
 
+// the size of the read buffer used for line, delimiter, and character reads
+#ifndef QORE_FILE_READ_BUFSIZE
+#define QORE_FILE_READ_BUFSIZE 65536
+#endif
+
+// the number of bytes already consumed that are kept in the read buffer when it is refilled so they can be pushed back
+#define QORE_FILE_PUTBACK 4
+
+// returns a pointer to the first '\n' or '\r' in the buffer or nullptr if there is none
+static inline const char* q_find_eol(const char* p, size_t len) {
+    const char* nl = (const char*)memchr(p, '\n', len);
+    const char* cr = (const char*)memchr(p, '\r', nl ? nl - p : len);
+    return cr ? cr : nl;
+}
+
 struct qore_qf_private {
     int fd;
     bool is_open;
@@ -71,6 +87,13 @@ struct qore_qf_private {
     std::string filename;
     mutable QoreThreadLock m;
     Queue* cb_queue;
+    // read buffer: bytes from rbuf + rpos to rbuf + rend have been read from the file but not yet consumed, so the
+    // logical file position is the position of the file descriptor minus (rend - rpos)
+    mutable char* rbuf = nullptr;
+    mutable size_t rpos = 0;
+    mutable size_t rend = 0;
+    // memory mapping of the file for binary views, created on demand
+    QoreMemoryMap* fmap = nullptr;
 
     DLLLOCAL qore_qf_private(const QoreEncoding* cs) : is_open(false),
                                                        special_file(false),
@@ -80,6 +103,7 @@ struct qore_qf_private {
 
     DLLLOCAL ~qore_qf_private() {
         close_intern();
+        free(rbuf);
 
         // must be dereferenced and removed before deleting
         assert(!cb_queue);
@@ -87,6 +111,8 @@ struct qore_qf_private {
 
     DLLLOCAL int close_intern() {
         filename.clear();
+        rpos = rend = 0;
+        releaseMap();
 
         int rc;
         if (is_open) {
@@ -118,6 +144,9 @@ struct qore_qf_private {
             return -1;
         }
         filename = file.filename;
+        // any buffered data and mapping belongs to the old file
+        rpos = rend = 0;
+        releaseMap();
 
         return 0;
     }
@@ -166,6 +195,51 @@ struct qore_qf_private {
       return -1;
    }
 
+   // releases the file's reference to its memory mapping; existing views keep the mapping alive
+   DLLLOCAL void releaseMap() {
+      if (fmap) {
+         fmap->deref();
+         fmap = nullptr;
+      }
+   }
+
+   // returns a read-only view of the given range of the file, mapping the file on demand
+   /** @param offset the byte offset of the view in the file
+       @param size the size of the view in bytes; -1 means up to the end of the file
+    */
+   DLLLOCAL BinaryNode* mapBinary(qore_offset_t offset, qore_offset_t size, ExceptionSink* xsink) {
+      AutoLocker al(m);
+
+      if (!is_open) {
+         xsink->raiseException("FILE-MAP-ERROR", "file has not been opened");
+         return nullptr;
+      }
+
+      if (offset < 0) {
+         xsink->raiseException("FILE-MAP-ERROR", "invalid negative offset " QLLD " given", offset);
+         return nullptr;
+      }
+
+      // remap the file if the range requested is not in the current mapping, as the file may have grown
+      if (!fmap || (qore_size_t)offset > fmap->size() || (size > 0 && (qore_size_t)(offset + size) > fmap->size())) {
+         QoreMemoryMap* nmap = QoreMemoryMap::create(fd, filename.c_str(), xsink);
+         if (!nmap)
+            return nullptr;
+         releaseMap();
+         fmap = nmap;
+      }
+
+      qore_size_t fsize = fmap->size();
+      if ((qore_size_t)offset > fsize) {
+         xsink->raiseException("FILE-MAP-ERROR", "offset " QLLD " is past the end of the file (size: " QSD ")", offset, fsize);
+         return nullptr;
+      }
+      if (size < 0 || (qore_size_t)(offset + size) > fsize)
+         size = fsize - offset;
+
+      return fmap->getView(offset, size);
+   }
+
    // returns -1 for exception
    DLLLOCAL int check_write_open(ExceptionSink* xsink) const {
       if (is_open)
@@ -274,6 +348,8 @@ struct qore_qf_private {
 
    // assumes lock is held and file is open
    DLLLOCAL bool isDataAvailableIntern(int timeout_ms, const char* mname, ExceptionSink *xsink) const {
+      if (rpos < rend)
+         return true;
       return select(timeout_ms, true, mname, xsink);
    }
 
@@ -297,24 +373,104 @@ struct qore_qf_private {
    }
 #endif
 
-   // unlocked, assumes file is open
-   DLLLOCAL qore_size_t read(void *buf, qore_size_t bs) const {
+   // unlocked, assumes file is open; refills the read buffer
+   /* returns the number of bytes read, 0 for EOF, or -1 for errors
+    */
+   DLLLOCAL qore_offset_t fill() const {
+      assert(rpos == rend);
+      if (!rbuf)
+         rbuf = (char*)malloc(QORE_FILE_READ_BUFSIZE);
+
+      // keep the last bytes consumed so that they can be pushed back with unread()
+      size_t keep = rpos < QORE_FILE_PUTBACK ? rpos : QORE_FILE_PUTBACK;
+      if (keep)
+         memmove(rbuf, rbuf + rpos - keep, keep);
+      rpos = rend = keep;
+
       qore_offset_t rc;
       while (true) {
-         rc = ::read(fd, buf, bs);
+         rc = ::read(fd, rbuf + keep, QORE_FILE_READ_BUFSIZE - keep);
          // try again if we were interrupted by a signal
          if (rc >= 0 || errno != EINTR)
             break;
       }
 
-      if (rc > 0)
-         do_read_event_unlocked(rc, rc, bs);
+      if (rc > 0) {
+         rend += rc;
+         do_read_event_unlocked(rc, rc, QORE_FILE_READ_BUFSIZE - keep);
+      }
 
       return rc;
    }
 
+   // unlocked; pushes back bytes just consumed from the read buffer
+   DLLLOCAL void unread(size_t len) const {
+      assert(len <= rpos);
+      rpos -= len;
+   }
+
+   // unlocked; copies buffered data to the given buffer and returns the number of bytes copied
+   DLLLOCAL size_t readBuffered(void* buf, size_t bs) const {
+      size_t len = rend - rpos;
+      if (len > bs)
+         len = bs;
+      memcpy(buf, rbuf + rpos, len);
+      rpos += len;
+      return len;
+   }
+
+   // unlocked, assumes file is open; moves the file position back to the logical position and discards the read buffer
+   /* has no effect for buffered data in files that are not seekable (pipes, sockets, terminals)
+    */
+   DLLLOCAL void syncReadPos() const {
+      if (rpos < rend) {
+         if (lseek(fd, -(off_t)(rend - rpos), SEEK_CUR) == -1)
+            return;
+      }
+      rpos = rend = 0;
+   }
+
+   // unlocked, assumes file is open
+   DLLLOCAL qore_size_t read(void *buf, qore_size_t bs) const {
+      // return buffered data first
+      qore_size_t br = 0;
+      if (rpos < rend) {
+         br = readBuffered(buf, bs);
+         if (br == bs)
+            return br;
+         buf = (char*)buf + br;
+         bs -= br;
+      }
+
+      qore_offset_t rc;
+      if (bs < QORE_FILE_READ_BUFSIZE / 2) {
+         // small reads go through the read buffer
+         rc = fill();
+         if (rc > 0)
+            rc = readBuffered(buf, bs);
+      }
+      else {
+         while (true) {
+            rc = ::read(fd, buf, bs);
+            // try again if we were interrupted by a signal
+            if (rc >= 0 || errno != EINTR)
+               break;
+         }
+
+         if (rc > 0)
+            do_read_event_unlocked(rc, rc, bs);
+      }
+
+      if (rc <= 0)
+         return br ? br : rc;
+      return br + rc;
+   }
+
    // unlocked, assumes file is open
    DLLLOCAL qore_size_t write(const void* buf, qore_size_t len, ExceptionSink* xsink = 0) const {
+      // write at the logical file position
+      syncReadPos();
+
       qore_offset_t rc;
       while (true) {
          rc = ::write(fd, buf, len);
@@ -333,16 +489,19 @@ struct qore_qf_private {
 
    // private function, unlocked
    DLLLOCAL int readChar() const {
-      unsigned char ch = 0;
-      if (read(&ch, 1) != 1)
+      if (rpos == rend && fill() <= 0)
          return -1;
-      return (int)ch;
+      return (int)(unsigned char)rbuf[rpos++];
    }
 
    // private function, unlocked
    DLLLOCAL int readUnicode(int* n_len = 0) const;
 
    DLLLOCAL qore_offset_t readData(void* dest, qore_size_t limit, int timeout_ms, const char* mname, ExceptionSink* xsink) {
+      // return buffered data first
+      if (rpos < rend)
+         return readBuffered(dest, limit);
+
       // wait for data
       if (timeout_ms >= 0 && !isDataAvailableIntern(timeout_ms, mname, xsink)) {
          if (!*xsink)
@@ -375,6 +534,24 @@ struct qore_qf_private {
       char* buf = (char* )malloc(sizeof(char) * bs);
       char* bbuf = 0;
 
+      // return buffered data first
+      if (rpos < rend) {
+         br = rend - rpos;
+         if (size > 0 && br > (qore_size_t)size)
+            br = size;
+         bbuf = (char*)malloc(br + 1);
+         readBuffered(bbuf, br);
+         if (size > 0) {
+            if (br >= (qore_size_t)size) {
+               free(buf);
+               size = br;
+               return bbuf;
+            }
+            if (size - br < bs)
+               bs = size - br;
+         }
+      }
+
       while (true) {
          // wait for data
          if (timeout_ms >= 0 && !isDataAvailableIntern(timeout_ms, mname, xsink)) {
@@ -445,40 +622,40 @@ struct qore_qf_private {
       if (!is_open)
          return -2;
 
-      bool tty = (bool)isatty(fd);
+      int rc = -1;
 
-      int ch, rc = -1;
+      while (rpos < rend || fill() > 0) {
+         rc = 0;
 
-      while ((ch = readChar()) >= 0) {
-         str.concat((char)ch);
-         if (rc == -1)
-            rc = 0;
+         // search the buffered data for the end of the line
+         const char* p = rbuf + rpos;
+         size_t avail = rend - rpos;
+         const char* e = q_find_eol(p, avail);
+         if (!e) {
+            str.concat(p, avail);
+            rpos = rend;
+            continue;
+         }
 
-         if (ch == '\r') {
-            // see if next byte is \n' if we're not connected to a terminal device
-            if (!tty) {
-               ch = readChar();
-               if (ch >= 0) {
-                  if (ch == '\n') {
-                     if (incl_eol)
-                        str.concat((char)ch);
-                  }
-                  else {
-                     // reset file to previous byte position
-                     lseek(fd, -1, SEEK_CUR);
-                  }
+         size_t len = e - p;
+         str.concat(p, incl_eol ? len + 1 : len);
+         rpos += len + 1;
+
+         // see if next byte is \n' if we're not connected to a terminal device
+         if (*e == '\r' && !isatty(fd)) {
+            int ch = readChar();
+            if (ch >= 0) {
+               if (ch == '\n') {
+                  if (incl_eol)
+                     str.concat((char)ch);
+               }
+               else {
+                  // push back the byte read
+                  unread(1);
                }
             }
-            if (!incl_eol)
-               str.terminate(str.strlen() - 1);
-            break;
-         }
-
-         if (ch == '\n') {
-            if (!incl_eol)
-               str.terminate(str.strlen() - 1);
-            break;
          }
+         break;
       }
 
       return rc;
@@ -492,18 +669,24 @@ struct qore_qf_private {
       if (!is_open)
          return -2;
 
-      int ch, rc = -1;
+      int rc = -1;
 
-      while ((ch = readChar()) >= 0) {
-         char c = ch;
-         str.concat(c);
-         if (rc == -1)
-            rc = 0;
-         if (c == byte) {
-            if (!incl_byte)
-               str.terminate(str.strlen() - 1);
-            break;
+      while (rpos < rend || fill() > 0) {
+         rc = 0;
+
+         const char* p = rbuf + rpos;
+         size_t avail = rend - rpos;
+         const char* e = (const char*)memchr(p, byte, avail);
+         if (!e) {
+            str.concat(p, avail);
+            rpos = rend;
+            continue;
          }
+
+         size_t len = e - p;
+         str.concat(p, incl_byte ? len + 1 : len);
+         rpos += len + 1;
+         break;
       }
 
       return rc;
@@ -561,8 +744,8 @@ struct qore_qf_private {
                         str.concatUnicode(ch);
                   }
                   else {
-                     // reset file to previous byte position
-                     lseek(fd, -len, SEEK_CUR);
+                     // push back the character read
+                     unread(len);
                   }
                }
             }
@@ -674,7 +857,8 @@ struct qore_qf_private {
       return rc;
    }
 
-   // not the most efficient search algorithm, restarts the search the byte after it fails for multi-byte patterns
+   // restarts the search the byte after it fails for multi-byte patterns; the first byte of the pattern is located
+   // with memchr() in the read buffer
    DLLLOCAL int readUntil(const char* bytes, QoreString& str, bool incl_bytes) {
       if (!bytes[1])
          return readUntil(bytes[0], str, incl_bytes);
@@ -691,7 +875,24 @@ struct qore_qf_private {
 
       int ch, rc = -1;
 
-      while ((ch = readChar()) >= 0) {
+      while (true) {
+         // skip to the next possible start of the pattern
+         if (!pos && rpos < rend) {
+            const char* p = rbuf + rpos;
+            size_t avail = rend - rpos;
+            const char* e = (const char*)memchr(p, bytes[0], avail);
+            size_t len = e ? e - p : avail;
+            if (len) {
+               str.concat(p, len);
+               rpos += len;
+               rc = 0;
+               continue;
+            }
+         }
+
+         if ((ch = readChar()) < 0)
+            break;
+
          char c = ch;
          str.concat(c);
          if (rc == -1)
@@ -746,7 +947,21 @@ struct qore_qf_private {
       if (!is_open)
          return -1;
 
-      return lseek(fd, 0, SEEK_CUR);
+      off_t pos = lseek(fd, 0, SEEK_CUR);
+      if (pos == -1)
+         return -1;
+      // subtract any data read but not yet consumed
+      return pos - (rend - rpos);
+   }
+
+   DLLLOCAL qore_size_t setPos(qore_size_t pos) {
+      AutoLocker al(m);
+
+      if (!is_open)
+         return -1;
+
+      rpos = rend = 0;
+      return lseek(fd, pos, SEEK_SET);
    }
 
    DLLLOCAL void setEventQueue(Queue* cbq, ExceptionSink* xsink) {
@@ -68,6 +68,35 @@
 #define CHF_PROCESS (1 << 1)
 #define CHF_REQUEST (1 << 2)
 
+// identifiers for HTTP header fields processed when converting headers to a hash
+enum qore_http_header_id_e : unsigned char {
+   QHH_OTHER = 0,
+   QHH_CONNECTION,
+   QHH_CONTENT_TYPE,
+   QHH_TRANSFER_ENCODING,
+   QHH_ACCEPT_CHARSET,
+   QHH_ACCEPT_ENCODING,
+};
+
+// a common HTTP header field name with its precalculated hash key hash
+struct qore_http_header_key {
+   // the lowercase field name used as the hash key
+   const char* name;
+   size_t len;
+   size_t hash;
+   qore_http_header_id_e id;
+};
+
+// returns the common header key matching the given field name case-insensitively, or nullptr if there is none
+DLLLOCAL const qore_http_header_key* q_find_http_header_key(const char* name, size_t len);
+
+// returns a pointer to the first '\r' or '\n' in [p, e) or e if there is none
+static inline char* q_find_crlf(char* p, char* e) {
+   char* cr = (char*)memchr(p, '\r', e - p);
+   char* nl = (char*)memchr(p, '\n', (cr ? cr : e) - p);
+   return nl ? nl : (cr ? cr : e);
+}
+
 #ifndef DEFAULT_SOCKET_MIN_THRESHOLD_BYTES
 #define DEFAULT_SOCKET_MIN_THRESHOLD_BYTES 1024
 #endif
@@ -256,6 +285,11 @@ struct qore_socket_private {
       return sock != QORE_INVALID_SOCKET;
    }
 
+   // returns true if data can be read without waiting on the socket descriptor
+   DLLLOCAL bool hasBufferedData() const {
+      return buflen || (ssl && ssl->pending());
+   }
+
    DLLLOCAL int close() {
       int rc = close_internal();
       if (in_op >= 0)
@@ -1574,97 +1608,155 @@ struct qore_socket_private {
       return rc;
    }
 
-   //! read until \\r\\n\\r\\n and return the string
-   DLLLOCAL QoreStringNode* readHTTPData(ExceptionSink* xsink, const char* meth, int timeout, qore_offset_t& rc, bool exit_early = false) {
-      assert(xsink);
-      assert(meth);
-      if (sock == QORE_INVALID_SOCKET) {
-         se_not_open("Socket", meth, xsink);
-         rc = QSE_NOT_OPEN;
-         return 0;
+   // returns unconsumed data to the socket buffer; may only be called after a brecv() call that consumed all buffered data
+   DLLLOCAL void unrecv(char* p, qore_size_t len) {
+      assert(!buflen);
+      assert(p >= rbuf && p + len <= rbuf + DEFAULT_SOCKET_BUFSIZE);
+      if (len) {
+         bufoffset = p - rbuf;
+         buflen = len;
       }
+   }
 
-      PrivateQoreSocketThroughputHelper th(this, false);
+   //! reads HTTP header data until \\r\\n\\r\\n, \\r\\n\\n, \\n\\n, or \\r\\r
+   /** the socket buffer is scanned a block at a time, and any data following the header is left in the buffer
+
+       @return a pointer to the header data without the final line terminator sequence and terminated with "\\n" and a
+       null character; if the header was received in the first socket read, the data is returned in place in the socket
+       buffer, otherwise it is copied to \\a hdr; returns nullptr on error or if \\a exit_early is true and an empty line
+       was read
+   */
+   DLLLOCAL char* readHTTPDataIntern(ExceptionSink* xsink, const char* meth, int timeout, qore_offset_t& rc, QoreString& hdr, qore_size_t& len, bool exit_early) {
+      assert(hdr.empty());
 
       // state:
       //   0 = '\r' received
       //   1 = '\r\n' received
       //   2 = '\r\n\r' received
       //   3 = '\n' received
-      // read in HHTP header until \r\n\r\n or \n\n from socket
       int state = -1;
-      QoreStringNodeHolder hdr(new QoreStringNode(enc));
 
+      // the number of bytes read in previous blocks
       qore_size_t count = 0;
+      // the offset of the start of the current line terminator sequence
+      qore_size_t tstart = 0;
 
       while (true) {
          char* buf;
-         rc = brecv(xsink, meth, buf, 1, 0, timeout, false);
-         //printd(5, "qore_socket_private::readHTTPData() this: %p Socket::%s(): rc: " QLLD " read char: %c (%03d) (old state: %d)\n", this, meth, rc, rc > 0 && buf[0] > 31 ? buf[0] : '?', rc > 0 ? buf[0] : 0, state);
+         rc = brecv(xsink, meth, buf, DEFAULT_SOCKET_BUFSIZE, 0, timeout, false);
+         //printd(5, "qore_socket_private::readHTTPDataIntern() this: %p Socket::%s(): rc: " QLLD " (state: %d)\n", this, meth, rc, state);
          if (rc <= 0) {
-            //printd(5, "qore_socket_private::readHTTPData(timeout: %d) hdr='%s' (len: %d), rc=" QSD ", errno: %d: '%s'\n", timeout, hdr->getBuffer(), hdr->strlen(), rc, errno, strerror(errno));
-
             if (!*xsink) {
-               if (!count) {
-                  //printd(5, "qore_socket_private::readHTTPData() this: %p rc: %d count: %d (%d) timeout: %d\n", this, rc, count, hdr->size(), timeout);
+               if (!count)
                   se_closed("Socket", meth, xsink);
-               }
-               else {
-                  // FIXME: remove check
-                  if (xsink)
-                     xsink->raiseExceptionArg("SOCKET-HTTP-ERROR", hdr.release(), "socket closed on remote end while reading header data after reading " QSD " byte%s", count, count == 1 ? "" : "s");
-               }
+               else
+                  xsink->raiseExceptionArg("SOCKET-HTTP-ERROR", new QoreStringNode(hdr), "socket closed on remote end while reading header data after reading " QSD " byte%s", count, count == 1 ? "" : "s");
             }
-            return 0;
-         }
-         char c = buf[0];
-         if (++count == QORE_MAX_HEADER_SIZE) {
-            // FIXME: remove check
-            if (xsink)
-               xsink->raiseException("SOCKET-HTTP-ERROR", "header size cannot exceed " QSD " bytes", count);
-            return 0;
+            return nullptr;
          }
 
-         // check if we can progress to the next state
-         if (c == '\n') {
-            if (state == -1) {
-               state = 3;
-               continue;
-            }
-            if (!state) {
-               if (exit_early && hdr->empty())
-                  return 0;
-               state = 1;
-               continue;
-            }
-            assert(state > 0);
-            break;
-         }
-         else if (c == '\r') {
+         char* p = buf;
+         char* be = buf + rc;
+         // do not scan past the maximum header size
+         char* e = (count + rc) >= QORE_MAX_HEADER_SIZE ? buf + (QORE_MAX_HEADER_SIZE - 1 - count) : be;
+         bool done = false;
+
+         while (p < e) {
             if (state == -1) {
-               state = 0;
-               continue;
+               // skip to the next possible line terminator
+               p = q_find_crlf(p, e);
+               if (p == e)
+                  break;
+               tstart = count + (p - buf);
             }
-            if (!state)
+
+            char c = *p++;
+            // check if we can progress to the next state
+            if (c == '\n') {
+               if (state == -1) {
+                  state = 3;
+                  continue;
+               }
+               if (!state) {
+                  if (exit_early && !tstart) {
+                     unrecv(p, be - p);
+                     return nullptr;
+                  }
+                  state = 1;
+                  continue;
+               }
+               assert(state > 0);
+               done = true;
                break;
-            if (state == 1) {
-               state = 2;
-               continue;
             }
+            else if (c == '\r') {
+               if (state == -1) {
+                  state = 0;
+                  continue;
+               }
+               if (!state) {
+                  done = true;
+                  break;
+               }
+               if (state == 1) {
+                  state = 2;
+                  continue;
+               }
+            }
+
+            // any other character is header data
+            state = -1;
          }
 
-         if (state != -1) {
-            switch (state) {
-               case 0: hdr->concat('\r'); break;
-               case 1: hdr->concat("\r\n"); break;
-               case 2: hdr->concat("\r\n\r"); break;
-               case 3: hdr->concat('\n'); break;
+         if (done) {
+            // leave any data after the header in the buffer
+            unrecv(p, be - p);
+            len = tstart + 1;
+
+            // the terminator sequence has at least two bytes, so the header can be terminated in place
+            if (!count) {
+               buf[tstart] = '\n';
+               buf[tstart + 1] = '\0';
+               return buf;
             }
-            state = -1;
+
+            hdr.concat(buf, p - buf);
+            hdr.terminate(tstart);
+            hdr.concat('\n');
+            return (char*)hdr.getBuffer();
+         }
+
+         if (e != be) {
+            xsink->raiseException("SOCKET-HTTP-ERROR", "header size cannot exceed " QSD " bytes", (qore_size_t)QORE_MAX_HEADER_SIZE);
+            return nullptr;
          }
-         hdr->concat(c);
+
+         hdr.concat(buf, rc);
+         count += rc;
+      }
+   }
+
+   //! read until \\r\\n\\r\\n and return the string
+   DLLLOCAL QoreStringNode* readHTTPData(ExceptionSink* xsink, const char* meth, int timeout, qore_offset_t& rc, bool exit_early = false) {
+      assert(xsink);
+      assert(meth);
+      if (sock == QORE_INVALID_SOCKET) {
+         se_not_open("Socket", meth, xsink);
+         rc = QSE_NOT_OPEN;
+         return 0;
       }
-      hdr->concat('\n');
+
+      PrivateQoreSocketThroughputHelper th(this, false);
+
+      QoreStringNodeHolder hdr(new QoreStringNode(enc));
+      qore_size_t len;
+      char* p = readHTTPDataIntern(xsink, meth, timeout, rc, **hdr, len, exit_early);
+      if (!p)
+         return 0;
+
+      // copy the header if it was returned in place in the socket buffer
+      if (p != hdr->getBuffer())
+         hdr->concat(p, len);
 
       //printd(5, "qore_socket_private::readHTTPData(timeout: %d) hdr='%s' (%d)\n", timeout, hdr->getBuffer(), hdr->size());
 
@@ -1965,42 +2057,42 @@ struct qore_socket_private {
 
    DLLLOCAL AbstractQoreNode* readHTTPHeader(ExceptionSink* xsink, QoreHashNode* info, int timeout, qore_offset_t& rc, int source) {
       assert(xsink);
-      QoreStringNodeHolder hdr(readHTTPData(xsink, "readHTTPHeader", timeout, rc));
-      if (!hdr) {
-         assert(*xsink);
+      if (sock == QORE_INVALID_SOCKET) {
+         se_not_open("Socket", "readHTTPHeader", xsink);
+         rc = QSE_NOT_OPEN;
          return 0;
       }
-      assert(rc > 0);
 
-      const char* buf = hdr->getBuffer();
+      PrivateQoreSocketThroughputHelper th(this, false);
 
-      char* p;
-      if ((p = (char*)strstr(buf, "\r\n"))) {
-         *p = '\0';
-         p += 2;
-      }
-      else if ((p = (char*)strchr(buf, '\n'))) {
-         *p = '\0';
-         ++p;
-      }
-      else if ((p = (char*)strchr(buf, '\r'))) {
-         *p = '\0';
-         ++p;
+      // the header is parsed in place in the socket buffer if possible, otherwise it is copied here
+      QoreString hdr(enc);
+      qore_size_t len;
+      char* buf = readHTTPDataIntern(xsink, "readHTTPHeader", timeout, rc, hdr, len, false);
+      if (!buf) {
+         assert(*xsink);
+         return 0;
       }
-      // readHTTPData will only return a string that satisifies one of the above conditions,
-      // however an embedded 0 could have been sent which would make the above searches invalid
-      else {
-         // FIXME: remove check
-         if (xsink)
-            xsink->raiseException("SOCKET-HTTP-ERROR", "invalid header received with embedded nulls in Socket::readHTTPHeader()");
+      assert(rc > 0);
+      th.finalize(len);
+
+      char* end = buf + len;
+      // the header data always ends with '\n'
+      char* p = (char*)memchr(buf, '\n', len);
+      assert(p);
+      // an embedded null in the first line would make the string searches below invalid
+      if (strlen(buf) < (size_t)(p - buf)) {
+         xsink->raiseException("SOCKET-HTTP-ERROR", "invalid header received with embedded nulls in Socket::readHTTPHeader()");
          return 0;
       }
+      *p = '\0';
+      if (p > buf && p[-1] == '\r')
+         p[-1] = '\0';
+      ++p;
 
       char* t1;
       if (!(t1 = (char*)strstr(buf, "HTTP/"))) {
-         // FIXME: remove check
-         if (xsink)
-            xsink->raiseExceptionArg("SOCKET-HTTP-ERROR", hdr.release(), "missing HTTP version string in first header line in Socket::readHTTPHeader()");
+         xsink->raiseExceptionArg("SOCKET-HTTP-ERROR", new QoreStringNode(buf, enc), "missing HTTP version string in first header line in Socket::readHTTPHeader()");
          return 0;
       }
 
@@ -2055,7 +2147,7 @@ struct qore_socket_private {
          flags |= CHF_REQUEST;
       }
 
-      bool close = convertHeaderToHash(*h, p, flags, info, &http_exp_chunked_body);
+      bool close = convertHeaderToHash(*h, p, flags, info, &http_exp_chunked_body, end);
       do_read_http_header(QORE_EVENT_HTTP_MESSAGE_RECEIVED, *h, source);
 
       // process header info
@@ -3056,44 +3148,74 @@ struct qore_socket_private {
       return acceptcharset;
    }
 
+   DLLLOCAL static void addHeaderValue(hash_assignment_priv& ha, AbstractQoreNode* val) {
+      // see if header exists, and if so make it a list and add value to the list
+      if (!(*ha).isNothing()) {
+         QoreListNode* l;
+         if ((*ha).getType() == NT_LIST)
+            l = (*ha).get<QoreListNode>();
+         else {
+            l = new QoreListNode;
+            l->push(ha.swap(l), nullptr);
+         }
+         l->push(val, nullptr);
+      }
+      else // otherwise set header normally
+         ha.assign(val, 0);
+   }
+
    // returns true if the connection should be closed, false if not
-   DLLLOCAL bool convertHeaderToHash(QoreHashNode* h, char* p, int flags = 0, QoreHashNode* info = 0, bool* chunked = 0) {
+   /** @param end the end of the header data, if known; the data must be null-terminated in any case
+    */
+   DLLLOCAL bool convertHeaderToHash(QoreHashNode* h, char* p, int flags = 0, QoreHashNode* info = 0, bool* chunked = 0, char* end = nullptr) {
       bool close = !(flags & CHF_HTTP11);
       // socket encoding
       const char* senc = 0;
       // accept-charset
       bool acceptcharset = false;
-      while (*p) {
+      if (!end)
+         end = p + strlen(p);
+      while (p < end) {
          char* buf = p;
 
-         if ((p = strstr(buf, "\r\n"))) {
-            *p = '\0';
-            p += 2;
-         }
-         else if ((p = strchr(buf, '\n'))) {
-            *p = '\0';
-            p++;
+         // lines end with "\r\n" or "\n", or with "\r" if the data has no '\n'
+         char* le;
+         if ((p = (char*)memchr(buf, '\n', end - buf))) {
+            le = (p > buf && p[-1] == '\r') ? p - 1 : p;
+            ++p;
          }
-         else if ((p = strchr(buf, '\r'))) {
-            *p = '\0';
-            p++;
+         else if ((p = (char*)memchr(buf, '\r', end - buf))) {
+            le = p++;
          }
          else
             break;
-         char* t = strchr(buf, ':');
+         *le = '\0';
+
+         char* t = (char*)memchr(buf, ':', le - buf);
          if (!t)
             break;
          *t = '\0';
+         size_t klen = t - buf;
          t++;
-         while (t && qore_isblank(*t))
+         while (qore_isblank(*t))
             t++;
-         strtolower(buf);
-         //printd(5, "setting %s = '%s'\n", buf, t);
 
-         AbstractQoreNode* val = new QoreStringNode(t);
+         // common field names use a shared lowercase key with a precalculated hash
+         const qore_http_header_key* hk = q_find_http_header_key(buf, klen);
+         qore_http_header_id_e id;
+         if (hk) {
+            id = hk->id;
+         }
+         else {
+            id = QHH_OTHER;
+            strtolower(buf);
+         }
+         //printd(5, "setting %s = '%s'\n", hk ? hk->name : buf, t);
+
+         AbstractQoreNode* val = new QoreStringNode(t, le - t);
 
          if (flags & CHF_PROCESS) {
-            if (!strcmp(buf, "connection")) {
+            if (id == QHH_CONNECTION) {
                if (flags & CHF_HTTP11) {
                   if (strcasestr(t, "close"))
                      close = true;
@@ -3103,7 +3225,7 @@ struct qore_socket_private {
                      close = false;
                }
             }
-            else if (!strcmp(buf, "content-type")) {
+            else if (id == QHH_CONTENT_TYPE) {
                char* a = strcasestr(t, "charset=");
                if (a) {
                   // find end
@@ -3152,31 +3274,25 @@ struct qore_socket_private {
                   info->setKeyValue("body-content-type", val->refSelf(), 0);
                }
             }
-            else if (chunked && !strcmp(buf, "transfer-encoding") && !strcasecmp(t, "chunked")) {
+            else if (chunked && id == QHH_TRANSFER_ENCODING && !strcasecmp(t, "chunked")) {
                *chunked = true;
             }
             else if (info) {
-               if (!strcmp(buf, "accept-charset"))
+               if (id == QHH_ACCEPT_CHARSET)
                   acceptcharset = do_accept_charset(t, *info);
-               else if ((flags & CHF_REQUEST) && !strcmp(buf, "accept-encoding"))
+               else if ((flags & CHF_REQUEST) && id == QHH_ACCEPT_ENCODING)
                   do_accept_encoding(t, *info);
             }
          }
 
-         // see if header exists, and if so make it a list and add value to the list
-         hash_assignment_priv ha(*h, buf);
-         if (!(*ha).isNothing()) {
-            QoreListNode* l;
-            if ((*ha).getType() == NT_LIST)
-               l = (*ha).get<QoreListNode>();
-            else {
-               l = new QoreListNode;
-               l->push(ha.swap(l), nullptr);
-            }
-            l->push(val, nullptr);
+         if (hk) {
+            hash_assignment_priv ha(*h, hk->name, hk->hash);
+            addHeaderValue(ha, val);
+         }
+         else {
+            hash_assignment_priv ha(*h, buf);
+            addHeaderValue(ha, val);
          }
-         else // otherwise set header normally
-            ha.assign(val, 0);
       }
 
       if ((flags & CHF_PROCESS)) {
@@ -34,6 +34,9 @@
 #ifndef QORE_QORE_STRING_PRIVATE_H
 #define QORE_QORE_STRING_PRIVATE_H
 
+#include "qore/intern/QoreSlabAllocator.h"
+#include "qore/intern/QoreSubstringSearch.h"
+
 #include <vector>
 
 #define MAX_INT_STRING_LEN     48
@@ -42,6 +45,9 @@
 #define STR_CLASS_BLOCK        (0x10 * 4)
 #define STR_CLASS_EXTRA        (0x10 * 3)
 
+// size of the inline buffer for short strings, including the terminating null
+#define QORE_STRING_SSO_SIZE   24
+
 #define MIN_SPRINTF_BUFSIZE   64
 
 #define QUS_PATH     0
@@ -58,15 +64,21 @@ public:
    qore_size_t allocated;
    char* buf;
    const QoreEncoding* charset;
+   // inline storage for short strings; buf points here when the string fits
+   char sso[QORE_STRING_SSO_SIZE];
 
    DLLLOCAL qore_string_private() {
    }
 
    DLLLOCAL qore_string_private(const qore_string_private &p) {
-        allocated = p.len + STR_CLASS_EXTRA;
-        allocated = (allocated / 0x10 + 1) * 0x10; // use complete cache line
-        buf = (char*)malloc(sizeof(char) * allocated);
         len = p.len;
+        if (len < QORE_STRING_SSO_SIZE)
+            initBuffer(len + 1);
+        else {
+            allocated = len + STR_CLASS_EXTRA;
+            allocated = (allocated / 0x10 + 1) * 0x10; // use complete cache line
+            buf = (char*)malloc(sizeof(char) * allocated);
+        }
         if (len)
             memcpy(buf, p.buf, len);
         buf[len] = '\0';
@@ -74,16 +86,84 @@ public:
    }
 
    DLLLOCAL ~qore_string_private() {
-        if (buf)
+        freeBuffer();
+   }
+
+   DLLLOCAL static void* operator new(size_t size) {
+      return q_slab_alloc(size);
+   }
+
+   DLLLOCAL static void operator delete(void* p, size_t size) {
+      q_slab_free(p, size);
+   }
+
+   // returns true if the string data is stored in the inline buffer
+   DLLLOCAL bool isInline() const {
+        return buf == sso;
+   }
+
+   // frees the string buffer if it was allocated on the heap
+   DLLLOCAL void freeBuffer() {
+        if (buf && buf != sso)
             free(buf);
    }
 
+   // sets up a new buffer of at least the given size; short buffers use the inline storage
+   // the current buffer must already have been freed or taken
+   DLLLOCAL void initBuffer(qore_size_t size) {
+        if (size <= QORE_STRING_SSO_SIZE) {
+            buf = sso;
+            allocated = QORE_STRING_SSO_SIZE;
+        }
+        else {
+            allocated = size;
+            buf = (char*)malloc(sizeof(char) * allocated);
+        }
+   }
+
+   // resizes the buffer to the given size, moving inline data to the heap if necessary; returns -1 on error
+   DLLLOCAL int reallocBuffer(qore_size_t size) {
+        char* nbuf;
+        if (buf == sso) {
+            if (size <= QORE_STRING_SSO_SIZE)
+                return 0;
+            nbuf = (char*)malloc(sizeof(char) * size);
+            if (!nbuf)
+                return -1;
+            memcpy(nbuf, sso, QORE_STRING_SSO_SIZE);
+        }
+        else {
+            nbuf = (char*)realloc(buf, sizeof(char) * size);
+            if (!nbuf)
+                return -1;
+        }
+        buf = nbuf;
+        allocated = size;
+        return 0;
+   }
+
+   // returns the buffer to the caller, who must free() it; inline strings are copied to a new heap buffer
+   // the string is empty with no buffer after this call
+   DLLLOCAL char* giveBuffer() {
+        char* rv;
+        if (buf == sso) {
+            rv = (char*)malloc(sizeof(char) * (len + 1));
+            memcpy(rv, sso, len + 1);
+        }
+        else
+            rv = buf;
+        buf = 0;
+        len = 0;
+        allocated = 0;
+        return rv;
+   }
+
    DLLLOCAL void check_char(qore_size_t i) {
         if (i >= allocated) {
             qore_size_t d = i >> 2;
-            allocated = i + (d < STR_CLASS_BLOCK ? STR_CLASS_BLOCK : d);
-            allocated = (allocated / 0x10 + 1) * 0x10; // use complete cache line
-            buf = (char*)realloc(buf, allocated * sizeof(char));
+            qore_size_t size = i + (d < STR_CLASS_BLOCK ? STR_CLASS_BLOCK : d);
+            size = (size / 0x10 + 1) * 0x10; // use complete cache line
+            reallocBuffer(size);
         }
    }
 
@@ -180,9 +260,11 @@ public:
       return -1;
    }
 
-   DLLLOCAL static qore_offset_t index_simple(const char *haystack, const char *needle, qore_offset_t pos = 0) {
-      const char *p;
-      if (!(p = strstr(haystack + pos, needle)))
+   // finds the first occurrence of needle in haystack at or after position pos
+   // pos must be a non-negative valid byte offset in haystack
+   DLLLOCAL static qore_offset_t index_simple(const char* haystack, qore_size_t hlen, const char* needle, qore_size_t nlen, qore_offset_t pos = 0) {
+      const char* p = QoreSubstringSearch::find(haystack + pos, hlen - pos, needle, nlen);
+      if (!p)
          return -1;
       return (qore_offset_t)(p - haystack);
    }
@@ -203,7 +285,7 @@ public:
          else if (pos >= (qore_offset_t)len)
             return -1;
 
-         return index_simple(buf, needle->getBuffer(), pos);
+         return index_simple(buf, len, needle->getBuffer(), needle->strlen(), pos);
       }
 
       // do multibyte index()
@@ -214,7 +296,7 @@ public:
       else if (pos >= (qore_offset_t)len)
          return -1;
 
-      qore_offset_t ind = index_simple(buf + pos, needle->getBuffer());
+      qore_offset_t ind = index_simple(buf + pos, len - pos, needle->getBuffer(), needle->strlen());
       if (ind != -1) {
          ind = getEncoding()->getCharPos(buf, buf + pos + ind, xsink);
          if (*xsink)
@@ -228,17 +310,21 @@ public:
       if (needle.strlen() + pos > len)
          return -1;
 
-      return bindex(needle.getBuffer(), pos);
+      return bindex(needle.getBuffer(), needle.strlen(), pos);
    }
 
    DLLLOCAL qore_offset_t bindex(const std::string &needle, qore_offset_t pos) const {
       if (needle.size() + pos > len)
          return -1;
 
-      return bindex(needle.c_str(), pos);
+      return bindex(needle.c_str(), needle.size(), pos);
    }
 
    DLLLOCAL qore_offset_t bindex(const char *needle, qore_offset_t pos) const {
+      return bindex(needle, ::strlen(needle), pos);
+   }
+
+   DLLLOCAL qore_offset_t bindex(const char *needle, qore_size_t needle_len, qore_offset_t pos) const {
       if (pos < 0) {
          pos = len + pos;
          if (pos < 0)
@@ -247,25 +333,22 @@ public:
       else if (pos >= (qore_offset_t)len)
          return -1;
 
-      return index_simple(buf, needle, pos);
+      return index_simple(buf, len, needle, needle_len, pos);
    }
 
    // finds the last occurrence of needle in haystack at or before position pos
    // pos must be a non-negative valid byte offset in haystack
    DLLLOCAL static qore_offset_t rindex_simple(const char *haystack, qore_size_t hlen, const char *needle, qore_size_t nlen, qore_offset_t pos) {
+      if (nlen > hlen)
+         return -1;
       // if the offset does not allow for the needle string to be present, then adjust
-      if ((pos + nlen) > hlen) {
+      if ((pos + nlen) > hlen)
          pos = hlen - nlen;
-         if (pos < 0)
-            return -1;
-      }
 
-      while (pos != -1) {
-         if (!strncmp(haystack + pos, needle, nlen))
-            return pos;
-         pos--;
-      }
-      return -1;
+      const char* p = QoreSubstringSearch::rfind(haystack, pos + nlen, needle, nlen);
+      if (!p)
+         return -1;
+      return (qore_offset_t)(p - haystack);
    }
 
    // start is a byte offset that has to point to the start of a valid character
@@ -474,9 +557,8 @@ public:
             return;
         }
         // allocate new string buffer
-        allocated = STR_CLASS_BLOCK;
+        initBuffer(2);
         len = 1;
-        buf = (char*)malloc(sizeof(char) * allocated);
         buf[0] = c;
         buf[1] = '\0';
    }
@@ -520,10 +602,10 @@ public:
         size_t fmtlen = ::strlen(fmt);
         // ensure minimum space is free
         if ((allocated - len - fmtlen) < MIN_SPRINTF_BUFSIZE) {
-            allocated += fmtlen + MIN_SPRINTF_BUFSIZE;
-            allocated = (allocated / 0x10 + 1) * 0x10; // use complete cache line
+            qore_size_t size = allocated + fmtlen + MIN_SPRINTF_BUFSIZE;
+            size = (size / 0x10 + 1) * 0x10; // use complete cache line
             // resize buffer
-            buf = (char*)realloc(buf, allocated * sizeof(char));
+            reallocBuffer(size);
         }
         // set free buffer size
         qore_offset_t free = allocated - len;
@@ -536,9 +618,9 @@ public:
         if (i < 0) {
             //printf("DEBUG: vsnprintf() failed: i=%d allocated=" QSD " len=" QSD " buf=%p fmtlen=" QSD " (new=i+%d = %d)\n", i, allocated, len, buf, fmtlen, STR_CLASS_EXTRA, i + STR_CLASS_EXTRA);
             // resize buffer
-            allocated += STR_CLASS_EXTRA;
-            allocated = (allocated / 0x10 + 1) * 0x10; // use complete cache line
-            buf = (char*)realloc(buf, sizeof(char) * allocated);
+            qore_size_t size = allocated + STR_CLASS_EXTRA;
+            size = (size / 0x10 + 1) * 0x10; // use complete cache line
+            reallocBuffer(size);
             *(buf + len) = '\0';
             return -1;
         }
@@ -546,9 +628,9 @@ public:
         if (i >= free) {
             //printf("DEBUG: vsnprintf() failed: i=%d allocated=" QSD " len=" QSD " buf=%p fmtlen=" QSD " (new=i+%d = %d)\n", i, allocated, len, buf, fmtlen, STR_CLASS_EXTRA, i + STR_CLASS_EXTRA);
             // resize buffer
-            allocated = len + i + STR_CLASS_EXTRA;
-            allocated = (allocated / 0x10 + 1) * 0x10; // use complete cache line
-            buf = (char*)realloc(buf, sizeof(char) * allocated);
+            qore_size_t size = len + i + STR_CLASS_EXTRA;
+            size = (size / 0x10 + 1) * 0x10; // use complete cache line
+            reallocBuffer(size);
             *(buf + len) = '\0';
             return -1;
         }
@@ -623,14 +705,11 @@ public:
         if ((unsigned)allocated >= requested_size)
             return 0;
         requested_size = (requested_size / 0x10 + 1) * 0x10; // fill complete cache line
-        char* aux = (char*)realloc(buf, requested_size * sizeof(char));
-        if (!aux) {
+        if (reallocBuffer(requested_size)) {
             assert(false);
             // FIXME: std::bad_alloc() should be thrown here;
             return -1;
         }
-        buf = aux;
-        allocated = requested_size;
         return 0;
     }
 
@@ -468,7 +468,8 @@ DLLLOCAL block_list_t::iterator popBlock();
 // called by each "on_block_exit" statement to activate it's code for the block exit
 DLLLOCAL void advanceOnBlockExit();
 
-DLLLOCAL LocalVarValue* thread_instantiate_lvar();
+// instantiates a local variable and returns its slot in the current variable frame
+DLLLOCAL LocalVarValue* thread_instantiate_lvar(int& slot);
 DLLLOCAL void thread_uninstantiate_lvar(ExceptionSink* xsink);
 DLLLOCAL void thread_uninstantiate_self();
 
@@ -535,7 +536,8 @@ public:
 
 DLLLOCAL const QoreListNode* thread_get_implicit_args();
 
-DLLLOCAL LocalVarValue* thread_find_lvar(const char* id);
+// finds a local variable by its slot in the current variable frame, falls back to a search by name
+DLLLOCAL LocalVarValue* thread_find_lvar(const char* id, int slot);
 
 // to get the current runtime object
 DLLLOCAL QoreObject* runtime_get_stack_object();
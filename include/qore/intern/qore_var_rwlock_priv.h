@@ -34,6 +34,17 @@
 #ifndef _QORE_VAR_RWLOCK_PRIV_H
 #define _QORE_VAR_RWLOCK_PRIV_H
 
+#include <atomic>
+
+// the number of reader counters in read-optimized locks; must be a power of 2
+#define QORE_VAR_READER_SLOTS 16
+
+// a reader counter on its own cache line
+struct qore_var_reader_slot {
+   std::atomic<int> count = {0};
+   char pad[64 - sizeof(std::atomic<int>)];
+};
+
 class qore_var_rwlock_priv {
 protected:
    DLLLOCAL virtual void notifyIntern() {
@@ -44,6 +55,38 @@ protected:
    //! this function is not implemented; it is here as a private function in order to prohibit it from being used
    DLLLOCAL qore_var_rwlock_priv& operator=(const qore_var_rwlock_priv&);
 
+   // returns the reader counter for the current thread
+   DLLLOCAL std::atomic<int>& getReaderSlot() {
+      return reader_slots[gettid() & (QORE_VAR_READER_SLOTS - 1)].count;
+   }
+
+   // returns true if any thread holds the read lock; must be called with the mutex held
+   DLLLOCAL bool hasReaders() const {
+      if (!reader_slots)
+         return readers;
+      // a read lock can be released in another thread than the one that acquired it, so only the sum is meaningful
+      int cnt = 0;
+      for (unsigned i = 0; i < QORE_VAR_READER_SLOTS; ++i)
+         cnt += reader_slots[i].count.load();
+      assert(cnt >= 0);
+      return cnt;
+   }
+
+   // grabs the read lock with the mutex held
+   DLLLOCAL void rdlockIntern() {
+      assert(write_tid != gettid());
+      while (write_tid != -1) {
+         ++read_waiting;
+         read_cond.wait(l);
+         --read_waiting;
+      }
+
+      if (reader_slots)
+         ++getReaderSlot();
+      else
+         ++readers;
+   }
+
 public:
    QoreThreadLock l;
    int write_tid,
@@ -54,12 +97,24 @@ public:
       read_cond;
    bool has_notify;
 
+   // reader counters for read-optimized locks, nullptr for normal locks; readers only update the counter for their
+   // thread and only take the mutex when a writer holds or is waiting for the lock
+   qore_var_reader_slot* reader_slots;
+   // number of threads holding or waiting for the write lock; only maintained in read-optimized locks
+   std::atomic<int> writers = {0};
+   // the TID of the thread holding the write lock; a copy of write_tid that unlock() can read without the mutex;
+   // only maintained in read-optimized locks
+   std::atomic<int> write_owner = {-1};
+
    //! creates and initializes the lock
-   DLLLOCAL qore_var_rwlock_priv() : write_tid(-1), readers(0), read_waiting(0), write_waiting(0), has_notify(false) {
+   DLLLOCAL qore_var_rwlock_priv(bool read_optimized = false) : write_tid(-1), readers(0), read_waiting(0),
+      write_waiting(0), has_notify(false),
+      reader_slots(read_optimized ? new qore_var_reader_slot[QORE_VAR_READER_SLOTS] : nullptr) {
    }
 
    //! destroys the lock
    DLLLOCAL virtual ~qore_var_rwlock_priv() {
+      delete [] reader_slots;
    }
 
    //! grabs the write lock
@@ -68,13 +123,19 @@ public:
       AutoLocker al(l);
       assert(tid != write_tid);
 
-      while (readers || write_tid != -1) {
+      // new readers take the mutex from now on
+      if (reader_slots)
+         ++writers;
+
+      while (hasReaders() || write_tid != -1) {
          ++write_waiting;
          write_cond.wait(l);
          --write_waiting;
       }
 
       write_tid = tid;
+      if (reader_slots)
+         write_owner.store(tid, std::memory_order_relaxed);
    }
 
    //! tries to grab the write lock; does not block if unsuccessful; returns 0 if successful
@@ -82,19 +143,47 @@ public:
       int tid = gettid();
       AutoLocker al(l);
       assert(tid != write_tid);
-      if (readers || write_tid != -1)
+      if (write_tid != -1)
          return -1;
 
+      if (reader_slots)
+         ++writers;
+
+      if (hasReaders()) {
+         if (reader_slots)
+            --writers;
+         return -1;
+      }
+
       write_tid = tid;
+      if (reader_slots)
+         write_owner.store(tid, std::memory_order_relaxed);
       return 0;
    }
 
    //! unlocks the lock (assumes the lock is locked)
    DLLLOCAL void unlock() {
       int tid = gettid();
+      // write_owner can only be equal to the current TID if this thread holds the write lock; it is only set and
+      // cleared by the writer itself, so it can be read without the mutex
+      if (reader_slots && write_owner.load(std::memory_order_relaxed) != tid) {
+         --getReaderSlot();
+         // wake up a writer waiting for the readers to release the lock
+         if (writers.load()) {
+            AutoLocker al(l);
+            if (write_tid == -1 && !hasReaders())
+               unlock_read_signal();
+         }
+         return;
+      }
+
       AutoLocker al(l);
       if (write_tid == tid) {
          write_tid = -1;
+         if (reader_slots) {
+            write_owner.store(-1, std::memory_order_relaxed);
+            --writers;
+         }
          if (has_notify)
             notifyIntern();
 
@@ -109,19 +198,40 @@ public:
 
    //! grabs the read lock
    DLLLOCAL void rdlock() {
-      AutoLocker al(l);
-      assert(write_tid != gettid());
-      while (write_tid != -1) {
-         ++read_waiting;
-         read_cond.wait(l);
-         --read_waiting;
+      if (reader_slots) {
+         std::atomic<int>& slot = getReaderSlot();
+         ++slot;
+         if (!writers.load())
+            return;
+         // a writer holds or is waiting for the lock; back out and take the mutex; a writer waiting for the
+         // readers to release the lock does not need to be woken up, because the lock is taken again below if no
+         // writer holds it
+         --slot;
+         AutoLocker al(l);
+         rdlockIntern();
+         return;
       }
 
-      ++readers;
+      AutoLocker al(l);
+      rdlockIntern();
    }
 
    //! tries to grab the read lock; does not block if unsuccessful; returns 0 if successful
    DLLLOCAL int tryrdlock() {
+      if (reader_slots) {
+         std::atomic<int>& slot = getReaderSlot();
+         ++slot;
+         if (!writers.load())
+            return 0;
+         --slot;
+         AutoLocker al(l);
+         assert(write_tid != gettid());
+         if (write_tid != -1)
+            return -1;
+         ++slot;
+         return 0;
+      }
+
       AutoLocker al(l);
       assert(write_tid != gettid());
       if (write_tid != -1)
@@ -145,6 +255,15 @@ public:
    }
 };
 
+//! a variable lock for global variables that are read much more often than they are written
+/** readers do not take the mutex unless a writer holds or is waiting for the lock
+ */
+class ReadOptimizedVarRWLock : public QoreVarRWLock {
+public:
+   DLLLOCAL ReadOptimizedVarRWLock() : QoreVarRWLock(new qore_var_rwlock_priv(true)) {
+   }
+};
+
 class QoreAutoVarRWReadLocker {
 private:
    //! this function is not implemented; it is here as a private function in order to prohibit it from being used
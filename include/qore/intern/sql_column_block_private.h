@@ -0,0 +1,108 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    sql_column_block_private.h
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#ifndef _QORE_SQL_COLUMN_BLOCK_PRIVATE_H
+#define _QORE_SQL_COLUMN_BLOCK_PRIVATE_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+// one column of an SQLColumnBlock; only the buffers for the column's type are used
+struct sql_column_block_column {
+    std::string name;
+    sql_column_type_e type;
+    // encoding for SQL_COL_STRING columns
+    const QoreEncoding* enc;
+
+    // SQL NULL flags; one entry for each row
+    std::vector<bool> nulls;
+    // SQL_COL_INT and SQL_COL_BOOL values and the seconds for SQL_COL_DATE values
+    std::vector<int64> ival;
+    // SQL_COL_FLOAT values
+    std::vector<double> fval;
+    // microseconds and zones for SQL_COL_DATE values
+    std::vector<int> us;
+    std::vector<const AbstractQoreZoneInfo*> zone;
+    // string data for SQL_COL_STRING values, and the end offset of each value in the buffer
+    std::string arena;
+    std::vector<size_t> offset;
+    // SQL_COL_ANY values
+    std::vector<QoreValue> val;
+
+    DLLLOCAL sql_column_block_column(const char* name, sql_column_type_e type, const QoreEncoding* enc)
+        : name(name), type(type), enc(enc) {
+    }
+
+    DLLLOCAL size_t size() const {
+        return nulls.size();
+    }
+
+    DLLLOCAL void reserve(size_t rows);
+
+    DLLLOCAL void appendNull();
+
+    // returns a new value for the given row
+    DLLLOCAL QoreValue get(size_t row) const;
+
+    // returns a new list of all values in the column
+    DLLLOCAL QoreListNode* getList() const;
+
+    DLLLOCAL void clear(ExceptionSink* xsink);
+};
+
+typedef std::vector<sql_column_block_column*> sql_column_list_t;
+typedef std::map<std::string, unsigned> sql_column_map_t;
+
+struct sql_column_block_private {
+    // columns in result set order
+    sql_column_list_t cols;
+    // column name to index map
+    sql_column_map_t cmap;
+
+    DLLLOCAL ~sql_column_block_private() {
+        assert(cols.empty());
+    }
+
+    // returns the index of the given column or -1 if it does not exist
+    DLLLOCAL int find(const char* name) const {
+        sql_column_map_t::const_iterator i = cmap.find(name);
+        return i == cmap.end() ? -1 : (int)i->second;
+    }
+
+    DLLLOCAL size_t size() const {
+        return cols.empty() ? 0 : cols[0]->size();
+    }
+
+    DLLLOCAL void clear(ExceptionSink* xsink);
+};
+
+#endif
@@ -33,6 +33,7 @@
 #include "qore/intern/QoreHashNodeIntern.h"
 #include "qore/intern/QoreClosureNode.h"
 #include "qore/intern/QoreParseHashNode.h"
+#include "qore/intern/QoreBiasedRefs.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -45,13 +46,37 @@
 #define REF_LVL (type!=NT_HASH)
 #endif
 
-AbstractQoreNode::AbstractQoreNode(qore_type_t t, bool n_value, bool n_needs_eval, bool n_there_can_be_only_one, bool n_custom_reference_handlers) : type(t), value(n_value), needs_eval_flag(n_needs_eval), there_can_be_only_one(n_there_can_be_only_one), custom_reference_handlers(n_custom_reference_handlers) {
+#ifdef QORE_BIASED_REFS
+// returns true for types whose reference counts are biased towards the thread that created them; these types have no
+// derefImpl() and can therefore be deleted in any thread at any time
+static inline bool brc_type(qore_type_t t) {
+   return t == NT_STRING || t == NT_DATE || t == NT_BINARY || t == NT_NUMBER;
+}
+#endif
+
+AbstractQoreNode::AbstractQoreNode(qore_type_t t, bool n_value, bool n_needs_eval, bool n_there_can_be_only_one, bool n_custom_reference_handlers) : type(t), value(n_value), needs_eval_flag(n_needs_eval), there_can_be_only_one(n_there_can_be_only_one), custom_reference_handlers(n_custom_reference_handlers)
+#ifdef QORE_BIASED_REFS
+   , biased_refs(!n_there_can_be_only_one && !n_custom_reference_handlers && brc_type(t)), brc_owner(0), brc_refs(0)
+#else
+   , biased_refs(false), brc_owner(0), brc_refs(0)
+#endif
+{
+#ifdef QORE_BIASED_REFS
+   if (biased_refs)
+      brcInit();
+#endif
 #if TRACK_REFS
    printd(REF_LVL, "AbstractQoreNode::ref() %p type: %d (0->1)\n", this, type);
 #endif
 }
 
-AbstractQoreNode::AbstractQoreNode(const AbstractQoreNode& v) : type(v.type), value(v.value), needs_eval_flag(v.needs_eval_flag), there_can_be_only_one(v.there_can_be_only_one), custom_reference_handlers(v.custom_reference_handlers) {
+AbstractQoreNode::AbstractQoreNode(const AbstractQoreNode& v) : type(v.type), value(v.value), needs_eval_flag(v.needs_eval_flag), there_can_be_only_one(v.there_can_be_only_one), custom_reference_handlers(v.custom_reference_handlers)
+   , biased_refs(v.biased_refs), brc_owner(0), brc_refs(0)
+{
+#ifdef QORE_BIASED_REFS
+   if (biased_refs)
+      brcInit();
+#endif
 #if TRACK_REFS
    printd(REF_LVL, "AbstractQoreNode::ref() %p type: %d (0->1)\n", this, type);
 #endif
@@ -91,6 +116,10 @@ void AbstractQoreNode::ref() const {
    if (!there_can_be_only_one) {
       if (custom_reference_handlers)
          customRef();
+#ifdef QORE_BIASED_REFS
+      else if (biased_refs)
+         brcRef();
+#endif
       else
          ROreference();
    }
@@ -113,6 +142,99 @@ void AbstractQoreNode::customDeref(ExceptionSink* xsink) {
    assert(false);
 }
 
+#ifndef QORE_BIASED_REFS
+int AbstractQoreNode::reference_count() const {
+   return references.load();
+}
+
+bool AbstractQoreNode::is_unique() const {
+   return references.load() == 1;
+}
+#else
+int AbstractQoreNode::reference_count() const {
+   if (!biased_refs)
+      return references.load();
+   // the owner's references are read first; brcMerge() adds them to the shared count before clearing brc_refs, so
+   // if brc_refs is read as 0 after a merge, the shared count read below includes them, and if they are read before
+   // being cleared, they may be counted twice; the result is therefore never less than the real reference count
+   int refs = brc_refs.load(std::memory_order_acquire);
+   return refs + QORE_BRC_COUNT(references.load(std::memory_order_acquire));
+}
+
+bool AbstractQoreNode::is_unique() const {
+   return reference_count() == 1;
+}
+
+void AbstractQoreNode::brcInit() {
+   unsigned owner = q_brc_owner();
+   if (owner) {
+      brc_owner.store(owner, std::memory_order_relaxed);
+      brc_refs.store(1, std::memory_order_relaxed);
+      references.store(0, std::memory_order_relaxed);
+   }
+   else
+      references.store(QORE_BRC_ONE | QORE_BRC_MERGED, std::memory_order_relaxed);
+}
+
+void AbstractQoreNode::brcRef() const {
+   if (brc_owner.load(std::memory_order_relaxed) == q_brc_tid)
+      brc_refs.store(brc_refs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+   else
+      references.fetch_add(QORE_BRC_ONE);
+}
+
+bool AbstractQoreNode::brcDeref() const {
+   if (brc_owner.load(std::memory_order_relaxed) == q_brc_tid) {
+      int refs = brc_refs.load(std::memory_order_relaxed) - 1;
+      brc_refs.store(refs, std::memory_order_relaxed);
+      return refs ? false : brcMerge(false);
+   }
+
+   // the owner is only ever reset after the merge has been published, so if it's 0 here, the merged flag is visible
+   // below
+   unsigned owner = brc_owner.load(std::memory_order_acquire);
+   int v = references.load(std::memory_order_relaxed);
+   while (true) {
+      int nv = v - QORE_BRC_ONE;
+      // if the shared count drops below zero before the merge, only the owner can decide if the node can be deleted
+      bool enqueue = !(v & (QORE_BRC_MERGED | QORE_BRC_QUEUED)) && nv < 0;
+      if (enqueue)
+         nv |= QORE_BRC_QUEUED;
+      if (references.compare_exchange_weak(v, nv)) {
+         if (enqueue) {
+            assert(owner);
+            q_brc_enqueue(const_cast<AbstractQoreNode*>(this), owner);
+            return false;
+         }
+         return nv == QORE_BRC_MERGED;
+      }
+   }
+}
+
+bool AbstractQoreNode::brcMerge(bool dequeue) const {
+   int refs = brc_owner.load(std::memory_order_relaxed) ? brc_refs.load(std::memory_order_relaxed) : 0;
+   // the owner's references are published in the shared count before brc_refs is cleared so that
+   // reference_count() cannot miss them; one extra reference keeps the node alive until brc_refs and brc_owner have
+   // been reset, because other threads can release their references as soon as the merge is visible
+   int v = references.load(std::memory_order_relaxed);
+   int nv;
+   do {
+      nv = (v + (refs + 1) * QORE_BRC_ONE) | QORE_BRC_MERGED;
+      if (dequeue)
+         nv &= ~QORE_BRC_QUEUED;
+   } while (!references.compare_exchange_weak(v, nv, std::memory_order_acq_rel, std::memory_order_relaxed));
+   brc_refs.store(0, std::memory_order_release);
+   brc_owner.store(0, std::memory_order_release);
+   // a queued node is deleted when it's dequeued
+   return references.fetch_sub(QORE_BRC_ONE, std::memory_order_acq_rel) - QORE_BRC_ONE == QORE_BRC_MERGED;
+}
+
+void AbstractQoreNode::brcReleaseQueued() {
+   if (brcMerge(true))
+      delete this;
+}
+#endif
+
 void AbstractQoreNode::deref(ExceptionSink* xsink) {
    //QORE_TRACE("AbstractQoreNode::deref()");
 #ifdef DEBUG
@@ -129,16 +251,16 @@ void AbstractQoreNode::deref(ExceptionSink* xsink) {
       printd(REF_LVL, "AbstractQoreNode::deref() %p type: %d %s (%d->%d)\n", this, type, getTypeName(), references.load(), references.load() - 1);
 
 #endif
-   if (references.load() > 10000000 || references.load() <= 0){
+   if (reference_count() > 10000000 || reference_count() <= 0){
       if (type == NT_STRING)
          printd(0, "AbstractQoreNode::deref() WARNING, node %p references: %d (type: %s) (val=\"%s\")\n",
-                this, references.load(), getTypeName(), ((QoreStringNode*)this)->getBuffer());
+                this, reference_count(), getTypeName(), ((QoreStringNode*)this)->getBuffer());
       else
-         printd(0, "AbstractQoreNode::deref() WARNING, node %p references: %d (type: %s)\n", this, references.load(), getTypeName());
+         printd(0, "AbstractQoreNode::deref() WARNING, node %p references: %d (type: %s)\n", this, reference_count(), getTypeName());
       assert(false);
    }
 #endif
-   assert(references.load() > 0);
+   assert(reference_count() > 0);
 
    if (there_can_be_only_one) {
       assert(is_unique());
@@ -148,6 +270,12 @@ void AbstractQoreNode::deref(ExceptionSink* xsink) {
    if (custom_reference_handlers) {
       customDeref(xsink);
    }
+#ifdef QORE_BIASED_REFS
+   else if (biased_refs) {
+      if (brcDeref() && (type < NUM_SIMPLE_TYPES || derefImpl(xsink)))
+         delete this;
+   }
+#endif
    else if (ROdereference()) {
       if (type < NUM_SIMPLE_TYPES || derefImpl(xsink))
          delete this;
@@ -496,6 +624,14 @@ void SimpleQoreNode::deref() {
         return;
     }
 
+#ifdef QORE_BIASED_REFS
+    if (biased_refs) {
+        if (brcDeref())
+            delete this;
+        return;
+    }
+#endif
+
     if (ROdereference())
         delete this;
 }
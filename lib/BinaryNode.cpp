@@ -29,6 +29,7 @@
 */
 
 #include <qore/Qore.h>
+#include "qore/intern/QoreMemoryMap.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -38,13 +39,52 @@ BinaryNode::BinaryNode(void* p, qore_size_t size) : SimpleValueQoreNode(NT_BINAR
     len = size;
 }
 
+BinaryNode::BinaryNode(QoreMemoryMap* m, const void* p, qore_size_t size) : SimpleValueQoreNode(NT_BINARY), ptr(nullptr), len(0) {
+    setView(m, p, size);
+}
+
 BinaryNode::~BinaryNode() {
-    if (ptr) {
+    if (map) {
+        map->deref();
+    }
+    else if (ptr) {
         free(ptr);
     }
 }
 
+bool BinaryNode::isView() const {
+    return (bool)map;
+}
+
+void BinaryNode::setView(QoreMemoryMap* m, const void* p, qore_size_t size) {
+    assert(!map);
+    assert(!ptr);
+    m->ref();
+    map = m;
+    ptr = const_cast<void*>(p);
+    len = size;
+}
+
+void BinaryNode::detach() {
+    assert(map);
+    void* np = nullptr;
+    if (len) {
+        np = malloc(len);
+        memcpy(np, ptr, len);
+    }
+    ptr = np;
+    map->deref();
+    map = nullptr;
+}
+
 void BinaryNode::clear() {
+    if (map) {
+        map->deref();
+        map = nullptr;
+        ptr = nullptr;
+        len = 0;
+        return;
+    }
     // NOTE: must check 'ptr', len may be 0 with memory allocated
     if (ptr) {
         free(ptr);
@@ -80,6 +120,10 @@ BinaryNode* BinaryNode::copy() const {
     if (!len)
         return new BinaryNode();
 
+    // views share the mapping
+    if (map)
+        return new BinaryNode(map, ptr, len);
+
     void *np = malloc(len);
     memcpy(np, ptr, len);
     return new BinaryNode(np, len);
@@ -90,6 +134,18 @@ const void* BinaryNode::getPtr() const {
 }
 
 void BinaryNode::append(const void *nptr, qore_size_t size) {
+    if (map) {
+        // copy the view's data and the new data before releasing the mapping, as nptr may point into the mapping
+        QoreMemoryMap* m = map;
+        map = nullptr;
+        void* np = malloc(len + size);
+        memcpy(np, ptr, len);
+        memcpy((char*)np + len, nptr, size);
+        ptr = np;
+        len += size;
+        m->deref();
+        return;
+    }
     bool self_copy = nptr == ptr;
     ptr = realloc(ptr, len + size);
     if (self_copy) {
@@ -109,6 +165,18 @@ void BinaryNode::append(const BinaryNode &b) {
 }
 
 void BinaryNode::prepend(const void *nptr, qore_size_t size) {
+    if (map) {
+        // copy the new data and the view's data before releasing the mapping, as nptr may point into the mapping
+        QoreMemoryMap* m = map;
+        map = nullptr;
+        void* np = malloc(len + size);
+        memcpy(np, nptr, size);
+        memcpy((char*)np + size, ptr, len);
+        ptr = np;
+        len += size;
+        m->deref();
+        return;
+    }
     ptr = realloc(ptr, len + size);
     // move memory forward
     memmove((char*)ptr + size, ptr, len);
@@ -118,6 +186,8 @@ void BinaryNode::prepend(const void *nptr, qore_size_t size) {
 }
 
 void* BinaryNode::giveBuffer() {
+    if (map)
+        detach();
     void* p = ptr;
     ptr = nullptr;
     len = 0;
@@ -171,6 +241,8 @@ const char *BinaryNode::getTypeName() const {
 
 int BinaryNode::preallocate(qore_size_t size) {
     //printd(5, "BinaryNode::preallocate(" QLLD ") this: %p ptr: %p len: " QLLD "\n", size, this, ptr, len);
+    if (map)
+        detach();
     ptr = q_realloc(ptr, size);
     if (ptr) {
         len = size;
@@ -229,6 +301,9 @@ void BinaryNode::splice(qore_offset_t offset, qore_offset_t length, BinaryNode*
     if (offset == (qore_offset_t)len || !length)
         return;
 
+    if (map)
+        detach();
+
     qore_size_t end;
     if (length > (qore_offset_t)(len - offset)) {
         end = len;
@@ -261,6 +336,9 @@ void BinaryNode::splice(qore_offset_t offset, qore_offset_t length, const void*
 
     //printd(5, "BinaryNode::splice(offset=" QSD ", length=" QSD ", priv->len=" QSD ")\n", offset, length, len);
 
+    if (map)
+        detach();
+
     qore_size_t end;
     if (length > (qore_offset_t)(len - offset)) {
         end = len;
@@ -300,7 +378,11 @@ int BinaryNode::substr(BinaryNode& b, qore_offset_t offset) const {
     if (offset == (qore_offset_t)len)
         return -1;
 
-    b.append((char*)ptr + offset, len - offset);
+    // substrings of views are views of the same mapping
+    if (map && !b.ptr && !b.map)
+        b.setView(map, (char*)ptr + offset, len - offset);
+    else
+        b.append((char*)ptr + offset, len - offset);
     return 0;
 }
 
@@ -315,6 +397,10 @@ int BinaryNode::substr(BinaryNode& b, qore_offset_t offset, qore_offset_t length
     if (length > (qore_offset_t)(len - offset))
         length = len - offset;
 
-    b.append((char*)ptr + offset, length);
+    // substrings of views are views of the same mapping
+    if (map && !b.ptr && !b.map)
+        b.setView(map, (char*)ptr + offset, length);
+    else
+        b.append((char*)ptr + offset, length);
     return 0;
 }
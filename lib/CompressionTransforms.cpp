@@ -32,6 +32,14 @@
 #include <zlib.h>
 #include <bzlib.h>
 #include <errno.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+#include <vector>
 
 #include "qore/Qore.h"
 #include "qore/intern/CompressionTransforms.h"
@@ -94,6 +102,60 @@ public:
       }
       xsink->raiseException("BZIP2-ERROR", desc);
    }
+
+#ifdef HAVE_ZSTD
+   static void mapZstdError(size_t rc, ExceptionSink *xsink) {
+      xsink->raiseException("ZSTD-ERROR", "%s", ZSTD_getErrorName(rc));
+   }
+#endif
+
+#ifdef HAVE_LZ4
+   static void mapLz4Error(size_t rc, ExceptionSink *xsink) {
+      xsink->raiseException("LZ4-ERROR", "%s", LZ4F_getErrorName(rc));
+   }
+#endif
+};
+
+// options for the transformations that support them
+class CompressionOptions {
+public:
+   int64 workers = 0;
+   const BinaryNode *dictionary = nullptr;
+
+   // returns 0 for OK, -1 if an exception was raised
+   int set(const QoreStringNode *alg, const QoreHashNode *opts, bool compress, ExceptionSink *xsink) {
+      if (!opts) {
+         return 0;
+      }
+      bool zstd = (*alg == CompressionTransforms::ALG_ZSTD);
+      ConstHashIterator i(opts);
+      while (i.next()) {
+         const char *key = i.getKey();
+         const QoreValue v = i.get();
+         if (v.isNothing()) {
+            continue;
+         }
+         if (zstd && compress && !strcmp(key, CompressionTransforms::OPT_WORKERS)) {
+            workers = v.getAsBigInt();
+            if (workers < 0) {
+               xsink->raiseException("COMPRESS-OPTION-ERROR", "the \"%s\" option must not be negative (value passed: " QLLD ")", key, workers);
+               return -1;
+            }
+            continue;
+         }
+         if (zstd && !strcmp(key, CompressionTransforms::OPT_DICTIONARY)) {
+            if (v.getType() != NT_BINARY) {
+               xsink->raiseException("COMPRESS-OPTION-ERROR", "the \"%s\" option requires a binary value; got type \"%s\" instead", key, v.getTypeName());
+               return -1;
+            }
+            dictionary = v.get<const BinaryNode>();
+            continue;
+         }
+         xsink->raiseException("COMPRESS-OPTION-ERROR", "option \"%s\" is not supported by the %s %s", key, alg->getBuffer(), compress ? "compressor" : "decompressor");
+         return -1;
+      }
+      return 0;
+   }
 };
 
 class ZlibDeflateTransform : public Transform {
@@ -352,26 +414,406 @@ private:
    State state;
 };
 
+#ifdef HAVE_ZSTD
+class ZstdCompressTransform : public Transform {
+
+public:
+   ZstdCompressTransform(int64 level, const CompressionOptions &opts, ExceptionSink *xsink) : cctx(nullptr), state(STATE_NOT_INIT) {
+      if (level == CompressionTransforms::LEVEL_DEFAULT) {
+         level = ZSTD_CLEVEL_DEFAULT;
+      } else if (!(level >= 1 && level <= ZSTD_maxCLevel())) {
+         xsink->raiseException("ZSTD-LEVEL-ERROR", "level must be between 1 - %d or -1 (value passed: " QLLD ")", ZSTD_maxCLevel(), level);
+         return;
+      }
+
+      cctx = ZSTD_createCCtx();
+      if (!cctx) {
+         xsink->outOfMemory();
+         return;
+      }
+
+      size_t rc = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, (int)level);
+      if (ZSTD_isError(rc)) {
+         CompressionErrorHelper::mapZstdError(rc, xsink);
+         return;
+      }
+      if (opts.workers) {
+         // compression jobs are run in background threads; fails if the library was built without threading
+         rc = ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, (int)opts.workers);
+         if (ZSTD_isError(rc)) {
+            xsink->raiseException("ZSTD-ERROR", "cannot use " QLLD " compression worker threads: %s (the zstd library may not support multithreading)", opts.workers, ZSTD_getErrorName(rc));
+            return;
+         }
+      }
+      if (opts.dictionary) {
+         rc = ZSTD_CCtx_loadDictionary(cctx, opts.dictionary->getPtr(), opts.dictionary->size());
+         if (ZSTD_isError(rc)) {
+            CompressionErrorHelper::mapZstdError(rc, xsink);
+            return;
+         }
+      }
+      state = STATE_OK;
+   }
+
+   ~ZstdCompressTransform() {
+      if (cctx) {
+         ZSTD_freeCCtx(cctx);
+      }
+   }
+
+   std::pair<int64, int64> apply(const void *src, int64 srcLen, void *dst, int64 dstLen, ExceptionSink *xsink) {
+      if (state == STATE_END) {
+         return std::make_pair(0, 0);
+      }
+      if (state != STATE_OK) {
+         xsink->raiseException("ZSTD-ERROR", "invalid zstd stream state");
+         return std::make_pair(0, 0);
+      }
+      ZSTD_inBuffer in = { src, src ? (size_t)srcLen : 0, 0 };
+      ZSTD_outBuffer out = { dst, (size_t)dstLen, 0 };
+      // returns the number of bytes still to be flushed when finishing the frame
+      size_t rc = ZSTD_compressStream2(cctx, &out, &in, src ? ZSTD_e_continue : ZSTD_e_end);
+      if (ZSTD_isError(rc)) {
+         CompressionErrorHelper::mapZstdError(rc, xsink);
+         state = STATE_ERROR;
+         return std::make_pair(0, 0);
+      }
+      if (!src && !rc) {
+         state = STATE_END;
+      }
+      return std::make_pair(in.pos, out.pos);
+   }
+
+private:
+   enum State {
+      STATE_OK, STATE_ERROR, STATE_END, STATE_NOT_INIT
+   };
+
+private:
+   ZSTD_CCtx *cctx;
+   State state;
+};
+
+class ZstdDecompressTransform : public Transform {
+
+public:
+   ZstdDecompressTransform(const CompressionOptions &opts, ExceptionSink *xsink) : dctx(nullptr), state(STATE_NOT_INIT), pending(true) {
+      dctx = ZSTD_createDCtx();
+      if (!dctx) {
+         xsink->outOfMemory();
+         return;
+      }
+      if (opts.dictionary) {
+         size_t rc = ZSTD_DCtx_loadDictionary(dctx, opts.dictionary->getPtr(), opts.dictionary->size());
+         if (ZSTD_isError(rc)) {
+            CompressionErrorHelper::mapZstdError(rc, xsink);
+            return;
+         }
+      }
+      state = STATE_OK;
+   }
+
+   ~ZstdDecompressTransform() {
+      if (dctx) {
+         ZSTD_freeDCtx(dctx);
+      }
+   }
+
+   std::pair<int64, int64> apply(const void *src, int64 srcLen, void *dst, int64 dstLen, ExceptionSink *xsink) {
+      if (state != STATE_OK) {
+         xsink->raiseException("ZSTD-ERROR", "invalid zstd stream state");
+         return std::make_pair(0, 0);
+      }
+      ZSTD_inBuffer in = { src, src ? (size_t)srcLen : 0, 0 };
+      ZSTD_outBuffer out = { dst, (size_t)dstLen, 0 };
+      // returns 0 when a frame has been completely decoded and flushed; concatenated frames are processed in turn
+      size_t rc = ZSTD_decompressStream(dctx, &out, &in);
+      if (ZSTD_isError(rc)) {
+         CompressionErrorHelper::mapZstdError(rc, xsink);
+         state = STATE_ERROR;
+         return std::make_pair(0, 0);
+      }
+      if (!src && !out.pos) {
+         if (pending) {
+            xsink->raiseException("ZSTD-ERROR", "Unexpected end of compressed data stream");
+            state = STATE_ERROR;
+         }
+         return std::make_pair(0, 0);
+      }
+      pending = (rc != 0);
+      return std::make_pair(in.pos, out.pos);
+   }
+
+private:
+   enum State {
+      STATE_OK, STATE_ERROR, STATE_NOT_INIT
+   };
+
+private:
+   ZSTD_DCtx *dctx;
+   State state;
+   // true if the current frame is incomplete
+   bool pending;
+};
+#endif
+
+#ifdef HAVE_LZ4
+class Lz4CompressTransform : public Transform {
+
+public:
+   Lz4CompressTransform(int64 level, ExceptionSink *xsink) : cctx(nullptr), state(STATE_NOT_INIT), bufPos(0), bufLen(0) {
+      if (level == CompressionTransforms::LEVEL_DEFAULT) {
+         level = 0;
+      } else if (!(level >= 0 && level <= LZ4F_compressionLevel_max())) {
+         xsink->raiseException("LZ4-LEVEL-ERROR", "level must be between 0 - %d or -1 (value passed: " QLLD ")", LZ4F_compressionLevel_max(), level);
+         return;
+      }
+
+      memset(&prefs, 0, sizeof(prefs));
+      prefs.frameInfo.blockSizeID = LZ4F_max64KB;
+      prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+      prefs.compressionLevel = (int)level;
+
+      size_t rc = LZ4F_createCompressionContext(&cctx, LZ4F_VERSION);
+      if (LZ4F_isError(rc)) {
+         CompressionErrorHelper::mapLz4Error(rc, xsink);
+         return;
+      }
+
+      // LZ4F_compressUpdate() requires room for a complete compressed block, so output is staged here
+      buf.resize(QORE_MAX(LZ4F_compressBound(ChunkSize, &prefs), (size_t)LZ4F_HEADER_SIZE_MAX));
+
+      rc = LZ4F_compressBegin(cctx, &buf[0], buf.size(), &prefs);
+      if (LZ4F_isError(rc)) {
+         CompressionErrorHelper::mapLz4Error(rc, xsink);
+         return;
+      }
+      bufLen = rc;
+      state = STATE_OK;
+   }
+
+   ~Lz4CompressTransform() {
+      if (cctx) {
+         LZ4F_freeCompressionContext(cctx);
+      }
+   }
+
+   std::pair<int64, int64> apply(const void *src, int64 srcLen, void *dst, int64 dstLen, ExceptionSink *xsink) {
+      if (state == STATE_ERROR || state == STATE_NOT_INIT) {
+         xsink->raiseException("LZ4-ERROR", "invalid lz4 stream state");
+         return std::make_pair(0, 0);
+      }
+      if (bufPos < bufLen) {
+         return std::make_pair(0, drain(dst, dstLen));
+      }
+      if (state == STATE_END) {
+         return std::make_pair(0, 0);
+      }
+      size_t consumed = 0;
+      size_t rc;
+      if (src) {
+         consumed = QORE_MIN((size_t)srcLen, ChunkSize);
+         rc = LZ4F_compressUpdate(cctx, &buf[0], buf.size(), src, consumed, nullptr);
+      } else {
+         rc = LZ4F_compressEnd(cctx, &buf[0], buf.size(), nullptr);
+      }
+      if (LZ4F_isError(rc)) {
+         CompressionErrorHelper::mapLz4Error(rc, xsink);
+         state = STATE_ERROR;
+         return std::make_pair(0, 0);
+      }
+      if (!src) {
+         state = STATE_END;
+      }
+      bufPos = 0;
+      bufLen = rc;
+      return std::make_pair(consumed, drain(dst, dstLen));
+   }
+
+private:
+   enum State {
+      STATE_OK, STATE_ERROR, STATE_END, STATE_NOT_INIT
+   };
+
+   // maximum amount of input compressed in one call
+   static constexpr size_t ChunkSize = 64 * 1024;
+
+   // copies staged output to the destination buffer
+   size_t drain(void *dst, int64 dstLen) {
+      size_t len = QORE_MIN(bufLen - bufPos, (size_t)dstLen);
+      memcpy(dst, &buf[bufPos], len);
+      bufPos += len;
+      return len;
+   }
+
+private:
+   LZ4F_cctx *cctx;
+   LZ4F_preferences_t prefs;
+   State state;
+   std::vector<char> buf;
+   size_t bufPos, bufLen;
+};
+
+class Lz4DecompressTransform : public Transform {
+
+public:
+   Lz4DecompressTransform(ExceptionSink *xsink) : dctx(nullptr), state(STATE_NOT_INIT), pending(true) {
+      size_t rc = LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION);
+      if (LZ4F_isError(rc)) {
+         CompressionErrorHelper::mapLz4Error(rc, xsink);
+         return;
+      }
+      state = STATE_OK;
+   }
+
+   ~Lz4DecompressTransform() {
+      if (dctx) {
+         LZ4F_freeDecompressionContext(dctx);
+      }
+   }
+
+   std::pair<int64, int64> apply(const void *src, int64 srcLen, void *dst, int64 dstLen, ExceptionSink *xsink) {
+      if (state != STATE_OK) {
+         xsink->raiseException("LZ4-ERROR", "invalid lz4 stream state");
+         return std::make_pair(0, 0);
+      }
+      size_t srcSize = src ? (size_t)srcLen : 0;
+      size_t dstSize = (size_t)dstLen;
+      // returns 0 when a frame has been completely decoded and flushed; concatenated frames are processed in turn
+      size_t rc = LZ4F_decompress(dctx, dst, &dstSize, src, &srcSize, nullptr);
+      if (LZ4F_isError(rc)) {
+         CompressionErrorHelper::mapLz4Error(rc, xsink);
+         state = STATE_ERROR;
+         return std::make_pair(0, 0);
+      }
+      if (!src && !dstSize) {
+         if (pending) {
+            xsink->raiseException("LZ4-ERROR", "Unexpected end of compressed data stream");
+            state = STATE_ERROR;
+         }
+         return std::make_pair(0, 0);
+      }
+      pending = (rc != 0);
+      return std::make_pair(srcSize, dstSize);
+   }
+
+private:
+   enum State {
+      STATE_OK, STATE_ERROR, STATE_NOT_INIT
+   };
+
+private:
+   LZ4F_dctx *dctx;
+   State state;
+   // true if the current frame is incomplete
+   bool pending;
+};
+#endif
+
+static void missing_algorithm_error(const QoreStringNode *alg, const char *opt, ExceptionSink *xsink) {
+   xsink->raiseException("MISSING-FEATURE-ERROR", "this build of Qore does not support the %s compression algorithm; for maximum portability use the constant Option::HAVE_%s to check if the algorithm is supported before use", alg->getBuffer(), opt);
+}
+
 Transform *CompressionTransforms::getCompressor(const QoreStringNode *alg, int64 level, ExceptionSink *xsink) {
+   return getCompressor(alg, level, nullptr, xsink);
+}
+
+Transform *CompressionTransforms::getCompressor(const QoreStringNode *alg, int64 level, const QoreHashNode *opts, ExceptionSink *xsink) {
+   CompressionOptions o;
+   if (o.set(alg, opts, true, xsink)) {
+      return 0;
+   }
    if (*alg == ALG_ZLIB) {
       return new ZlibDeflateTransform(level, xsink, false);
    } else if (*alg == ALG_GZIP) {
       return new ZlibDeflateTransform(level, xsink, true);
    } else if (*alg == ALG_BZIP2) {
       return new Bzip2CompressTransform(level, xsink);
+   } else if (*alg == ALG_ZSTD) {
+#ifdef HAVE_ZSTD
+      return new ZstdCompressTransform(level, o, xsink);
+#else
+      missing_algorithm_error(alg, "ZSTD", xsink);
+      return 0;
+#endif
+   } else if (*alg == ALG_LZ4) {
+#ifdef HAVE_LZ4
+      return new Lz4CompressTransform(level, xsink);
+#else
+      missing_algorithm_error(alg, "LZ4", xsink);
+      return 0;
+#endif
    }
    xsink->raiseException("COMPRESS-ERROR", "Unknown compression algorithm: %s", alg->getBuffer());
    return 0;
 }
 
 Transform *CompressionTransforms::getDecompressor(const QoreStringNode *alg, ExceptionSink *xsink) {
+   return getDecompressor(alg, nullptr, xsink);
+}
+
+Transform *CompressionTransforms::getDecompressor(const QoreStringNode *alg, const QoreHashNode *opts, ExceptionSink *xsink) {
+   CompressionOptions o;
+   if (o.set(alg, opts, false, xsink)) {
+      return 0;
+   }
    if (*alg == ALG_ZLIB) {
       return new ZlibInflateTransform(xsink, false);
    } else if (*alg == ALG_GZIP) {
       return new ZlibInflateTransform(xsink, true);
    } else if (*alg == ALG_BZIP2) {
       return new Bzip2DecompressTransform(xsink);
+   } else if (*alg == ALG_ZSTD) {
+#ifdef HAVE_ZSTD
+      return new ZstdDecompressTransform(o, xsink);
+#else
+      missing_algorithm_error(alg, "ZSTD", xsink);
+      return 0;
+#endif
+   } else if (*alg == ALG_LZ4) {
+#ifdef HAVE_LZ4
+      return new Lz4DecompressTransform(xsink);
+#else
+      missing_algorithm_error(alg, "LZ4", xsink);
+      return 0;
+#endif
    }
    xsink->raiseException("COMPRESS-ERROR", "Unknown compression algorithm: %s", alg->getBuffer());
    return 0;
 }
+
+BinaryNode *CompressionTransforms::transformData(Transform *t, const void *ptr, qore_size_t len, ExceptionSink *xsink) {
+   SimpleRefHolder<BinaryNode> b(new BinaryNode);
+
+   qore_size_t bs = QORE_MAX(len, (qore_size_t)4096);
+   if (b->preallocate(bs)) {
+      xsink->outOfMemory();
+      return 0;
+   }
+
+   const char *src = static_cast<const char *>(ptr);
+   qore_size_t done = 0;
+   while (true) {
+      if (bs - done < 1024) {
+         bs *= 2;
+         if (b->preallocate(bs)) {
+            xsink->outOfMemory();
+            return 0;
+         }
+      }
+      // the transformation is finished once all input has been consumed
+      bool finish = !len;
+      std::pair<int64, int64> r = t->apply(finish ? nullptr : src, len, ((char *)b->getPtr()) + done, bs - done, xsink);
+      if (*xsink) {
+         return 0;
+      }
+      src += r.first;
+      len -= r.first;
+      done += r.second;
+      if (finish && !r.second) {
+         break;
+      }
+   }
+   b->setSize(done);
+   return b.release();
+}
@@ -69,6 +69,7 @@ struct dbi_cap_hash dbi_cap_list[] =
   { DBI_CAP_HAS_DESCRIBE,           "HasDescribe" },
   { DBI_CAP_HAS_ARRAY_BIND,         "HasArrayBind" },
   { DBI_CAP_HAS_RESULTSET_OUTPUT,   "HasResultsetOutput" },
+  { DBI_CAP_HAS_COLUMNAR_FETCH,     "HasColumnarFetch" },
 };
 
 #define NUM_DBI_CAPS (sizeof(dbi_cap_list) / sizeof(dbi_cap_hash))
@@ -203,6 +204,13 @@ void qore_dbi_method_list::add(int code, q_dbi_stmt_next_t method) {
    priv->l[code] = (void*)method;
 }
 
+// covers stmt fetch_block
+void qore_dbi_method_list::add(int code, q_dbi_stmt_fetch_block_t method) {
+   assert(code == QDBI_METHOD_STMT_FETCH_BLOCK);
+   assert(priv->l.find(code) == priv->l.end());
+   priv->l[code] = (void*)method;
+}
+
 void qore_dbi_method_list::add(int code, q_dbi_option_set_t method) {
    assert(code == QDBI_METHOD_OPT_SET);
    assert(priv->l.find(code) == priv->l.end());
@@ -361,6 +369,11 @@ qore_dbi_private::qore_dbi_private(const char* nme, const qore_dbi_mlist_private
                 assert(!f.stmt.fetch_columns);
                 f.stmt.fetch_columns = (q_dbi_stmt_fetch_columns_t)(*i).second;
                 break;
+            case QDBI_METHOD_STMT_FETCH_BLOCK:
+                assert(!f.stmt.fetch_block);
+                f.stmt.fetch_block = (q_dbi_stmt_fetch_block_t)(*i).second;
+                cps |= DBI_CAP_HAS_COLUMNAR_FETCH;
+                break;
             case QDBI_METHOD_STMT_DESCRIBE:
                 assert(!f.stmt.describe);
                 f.stmt.describe = (q_dbi_stmt_fetch_row_t)(*i).second;
@@ -32,6 +32,7 @@
 
 #include <qore/Qore.h>
 #include "qore/intern/qore_date_private.h"
+#include "qore/intern/QoreSlabAllocator.h"
 
 DateTimeNode::DateTimeNode(qore_date_private* n_priv) : SimpleValueQoreNode(NT_DATE), DateTime(n_priv) {
 }
@@ -75,6 +76,14 @@ DateTimeNode::DateTimeNode(const DateTimeNode& dt) : SimpleValueQoreNode(NT_DATE
 DateTimeNode::~DateTimeNode() {
 }
 
+void* DateTimeNode::operator new(size_t size) {
+   return q_slab_alloc(size);
+}
+
+void DateTimeNode::operator delete(void* p, size_t size) {
+   q_slab_free(p, size);
+}
+
 // get the value of the type in a string context (default implementation = del = false and returns NullString)
 // if del is true, then the returned QoreString*  should be deleted, if false, then it must not be
 // use the QoreStringValueHelper class (defined in QoreStringNode.h) instead of using this function directly
@@ -36,6 +36,7 @@
 #include "qore/intern/QoreParseListNode.h"
 #include "qore/intern/StatementBlock.h"
 #include "qore/intern/QoreListNodeEvalOptionalRefHolder.h"
+#include "qore/intern/QoreHashNodeIntern.h"
 
 #include <stdio.h>
 #include <ctype.h>
@@ -736,8 +737,131 @@ QoreListNode* QoreFunction::runtimeGetCallVariants() const {
    return rv->empty() ? nullptr : rv.release();
 }
 
+std::atomic<int64> QoreVariantCache::hits(0);
+std::atomic<int64> QoreVariantCache::misses(0);
+std::atomic<int64> QoreVariantCache::uncacheable(0);
+std::atomic<int64> QoreVariantCache::megamorphic(0);
+std::atomic<unsigned> QoreVariantCache::generation(0);
+
+bool QoreVariantCacheKey::set(const QoreListNode* args, bool n_only_user, const qore_class_private* n_class_ctx, int64 n_ppo) {
+    nargs = args ? args->size() : 0;
+    if (nargs > QORE_VARIANT_CACHE_MAX_ARGS)
+        return false;
+
+    // the generation is read after the arguments exist, so the addresses in the key cannot have been reused
+    // since an entry with the same generation was added
+    gen = QoreVariantCache::generation.load(std::memory_order_acquire);
+    class_ctx = n_class_ctx;
+    ppo = n_ppo;
+    only_user = n_only_user;
+
+    bool has_obj = false;
+    for (unsigned i = 0; i < nargs; ++i) {
+        QoreValue n = args->retrieveEntry(i);
+        qore_type_t t = n.getType();
+        type[i] = t;
+        switch (t) {
+            case NT_OBJECT:
+                sub[i] = n.get<const QoreObject>()->getClass();
+                has_obj = true;
+                break;
+            case NT_HASH: {
+                const qore_hash_private* h = qore_hash_private::get(*n.get<const QoreHashNode>());
+                sub[i] = h->hashdecl ? (const void*)h->hashdecl : (const void*)h->complexTypeInfo;
+                break;
+            }
+            case NT_LIST:
+                sub[i] = qore_list_private::get(*n.get<const QoreListNode>())->complexTypeInfo;
+                break;
+            // matching references depends on the type of the referenced lvalue
+            case NT_REFERENCE:
+                return false;
+            default:
+                sub[i] = nullptr;
+                break;
+        }
+    }
+    runtime_class = has_obj ? runtime_get_class() : nullptr;
+    return true;
+}
+
+QoreVariantCache::~QoreVariantCache() {
+    for (unsigned i = 0; i < QORE_VARIANT_CACHE_ENTRIES; ++i)
+        delete entry[i].load();
+    QoreVariantCacheEntry* e = retired;
+    while (e) {
+        QoreVariantCacheEntry* next = e->next;
+        delete e;
+        e = next;
+    }
+}
+
+void QoreVariantCache::add(const QoreVariantCacheKey& key, const AbstractQoreFunctionVariant* variant) {
+    if (full.load(std::memory_order_relaxed))
+        return;
+
+    QoreVariantCacheEntry* ne = new QoreVariantCacheEntry{key, variant, nullptr};
+    for (unsigned i = 0; i < QORE_VARIANT_CACHE_ENTRIES; ++i) {
+        QoreVariantCacheEntry* e = nullptr;
+        if (entry[i].compare_exchange_strong(e, ne, std::memory_order_release, std::memory_order_acquire))
+            return;
+        // another thread has already cached this match
+        if (e->key == key) {
+            delete ne;
+            return;
+        }
+        // replace entries from earlier generations, which can never match again
+        if (e->key.gen != key.gen && entry[i].compare_exchange_strong(e, ne, std::memory_order_release,
+            std::memory_order_relaxed)) {
+            retire(e);
+            return;
+        }
+    }
+    delete ne;
+
+    // all entries are in use; the cache is now megamorphic
+    if (!full.exchange(true))
+        megamorphic.fetch_add(1, std::memory_order_relaxed);
+}
+
+void QoreVariantCache::clear() {
+    for (unsigned i = 0; i < QORE_VARIANT_CACHE_ENTRIES; ++i) {
+        QoreVariantCacheEntry* e = entry[i].exchange(nullptr);
+        if (e)
+            retire(e);
+    }
+    full = false;
+}
+
+void QoreVariantCache::retire(QoreVariantCacheEntry* e) {
+    // other threads may still be reading the entry; it is freed when the cache is destroyed
+    e->next = retired.load(std::memory_order_relaxed);
+    while (!retired.compare_exchange_weak(e->next, e)) {
+    }
+}
+
+void QoreVariantCache::getInfo(int64& h, int64& m, int64& u, int64& mm) {
+    h = hits;
+    m = misses;
+    u = uncacheable;
+    mm = megamorphic;
+}
+
 // finds a variant at runtime
 const AbstractQoreFunctionVariant* QoreFunction::runtimeFindVariant(ExceptionSink* xsink, const QoreListNode* args, bool only_user, const qore_class_private* class_ctx) const {
+    int64 ppo = runtime_get_parse_options();
+
+    // check the variant cache first; the cache is only used once all variants have been committed
+    QoreVariantCacheKey key;
+    bool cacheable = !check_parse && key.set(args, only_user, class_ctx, ppo);
+    if (cacheable) {
+        const AbstractQoreFunctionVariant* variant = vcache.find(key);
+        if (variant)
+            return variant;
+    }
+    else
+        QoreVariantCache::uncacheable.fetch_add(1, std::memory_order_relaxed);
+
     // the lowest match length with the highest score wins
     int match_len = -1;
     int match = -1;
@@ -755,8 +879,6 @@ const AbstractQoreFunctionVariant* QoreFunction::runtimeFindVariant(ExceptionSin
     const qore_class_private* last_class = nullptr;
     bool internal_access = false;
 
-    int64 ppo = runtime_get_parse_options();
-
     int cnt = 0;
 
     // iterate through inheritance list
@@ -963,6 +1085,10 @@ const AbstractQoreFunctionVariant* QoreFunction::runtimeFindVariant(ExceptionSin
             }
 
             assert(!(po & (PO_REQUIRE_TYPES|PO_STRICT_ARGS)) || !(variant->getFlags() & QC_RUNTIME_NOOP));
+
+            // only cache matches that have passed the functionality check
+            if (cacheable)
+                vcache.add(key, variant);
         }
     }
 
@@ -1838,6 +1964,7 @@ int QoreFunction::addPendingVariant(AbstractQoreFunctionVariant* variant) {
     }
 
     vlist.push_back(variant);
+    vcache.clear();
 
     return 0;
 }
@@ -1847,6 +1974,7 @@ void QoreFunction::parseCommit() {
         return;
     }
     check_parse = false;
+    vcache.clear();
 
     parseCheckReturnType();
 
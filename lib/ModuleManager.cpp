@@ -61,7 +61,7 @@
 #include <vector>
 #include <set>
 
-static const qore_mod_api_compat_s qore_mod_api_list_l[] = {{0, 22}};
+static const qore_mod_api_compat_s qore_mod_api_list_l[] = {{0, 23}};
 #define QORE_MOD_API_LEN (sizeof(qore_mod_api_list_l)/sizeof(struct qore_mod_api_compat_s))
 
 // public symbols
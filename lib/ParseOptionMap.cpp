@@ -93,6 +93,7 @@ void ParseOptionMap::static_init() {
    DO_MAP("no-system-hashdecls",      PO_NO_INHERIT_SYSTEM_HASHDECLS);
    DO_MAP("allow-weak-references",    PO_ALLOW_WEAK_REFERENCES);
    DO_MAP("allow-debugger",           PO_ALLOW_DEBUGGER);
+   DO_MAP("compile-bytecode",         PO_COMPILE_BYTECODE);
 
    // the following are not useful from the command-line
    //DO_MAP("no-user-constants",        PO_NO_INHERIT_USER_CONSTANTS);
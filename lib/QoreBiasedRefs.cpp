@@ -0,0 +1,157 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreBiasedRefs.cpp
+
+    biased reference counts for simple value nodes
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#include <qore/Qore.h>
+#include "qore/intern/QoreBiasedRefs.h"
+
+#ifdef QORE_BIASED_REFS
+#include <mutex>
+#include <vector>
+
+#include <pthread.h>
+
+namespace {
+// nodes queued with an owner thread
+struct brc_thread {
+    std::atomic<bool> pending{false};
+    std::vector<AbstractQoreNode*> queue;
+};
+
+// protects the thread table and all queues; constant-initialized as nodes can be created by static constructors
+std::mutex brc_lock;
+// registered threads indexed by owner ID; entries of exited threads are nullptr; allocated on first use
+std::vector<brc_thread*>* brc_threads = nullptr;
+// owner IDs released by exited threads
+std::vector<unsigned>* brc_free_ids = nullptr;
+
+// releases the queue and the owner ID of a thread when it exits
+pthread_key_t brc_key;
+pthread_once_t brc_key_once = PTHREAD_ONCE_INIT;
+
+// the pending flag of threads without a queue
+std::atomic<bool> brc_no_pending(false);
+
+thread_local brc_thread* brc_self = nullptr;
+}
+
+thread_local unsigned q_brc_tid = QORE_BRC_UNREGISTERED;
+thread_local std::atomic<bool>* q_brc_pending = &brc_no_pending;
+
+// takes the nodes queued with the given thread; must be called with brc_lock held
+static void brc_take_queue(brc_thread* t, std::vector<AbstractQoreNode*>& q) {
+    q.swap(t->queue);
+    t->pending.store(false, std::memory_order_relaxed);
+}
+
+static void brc_thread_exit(void* p) {
+    brc_thread* t = (brc_thread*)p;
+    unsigned tid = q_brc_tid;
+
+    {
+        std::lock_guard<std::mutex> g(brc_lock);
+        // the queue is released while holding the lock so that no further nodes can be queued and the ID cannot be
+        // reused before the thread's references have been merged
+        std::vector<AbstractQoreNode*> q;
+        brc_take_queue(t, q);
+        for (auto& i : q)
+            i->brcReleaseQueued();
+
+        (*brc_threads)[tid] = nullptr;
+        brc_free_ids->push_back(tid);
+    }
+
+    // nodes created from now on have merged reference counts
+    q_brc_tid = QORE_BRC_EXITED;
+    q_brc_pending = &brc_no_pending;
+    brc_self = nullptr;
+    delete t;
+}
+
+static void brc_make_key() {
+    pthread_key_create(&brc_key, brc_thread_exit);
+}
+
+unsigned q_brc_register_thread() {
+    pthread_once(&brc_key_once, brc_make_key);
+
+    brc_thread* t = new brc_thread;
+    unsigned tid;
+    {
+        std::lock_guard<std::mutex> g(brc_lock);
+        if (!brc_threads) {
+            // owner ID 0 is reserved for merged reference counts
+            brc_threads = new std::vector<brc_thread*>(1, nullptr);
+            brc_free_ids = new std::vector<unsigned>;
+        }
+        if (!brc_free_ids->empty()) {
+            tid = brc_free_ids->back();
+            brc_free_ids->pop_back();
+            (*brc_threads)[tid] = t;
+        } else {
+            tid = brc_threads->size();
+            brc_threads->push_back(t);
+        }
+    }
+    assert(tid < QORE_BRC_EXITED);
+
+    pthread_setspecific(brc_key, t);
+    brc_self = t;
+    q_brc_tid = tid;
+    q_brc_pending = &t->pending;
+    return tid;
+}
+
+void q_brc_release_queue() {
+    std::vector<AbstractQoreNode*> q;
+    {
+        std::lock_guard<std::mutex> g(brc_lock);
+        brc_take_queue(brc_self, q);
+    }
+    for (auto& i : q)
+        i->brcReleaseQueued();
+}
+
+void q_brc_enqueue(AbstractQoreNode* n, unsigned owner) {
+    std::lock_guard<std::mutex> g(brc_lock);
+    brc_thread* t = owner < brc_threads->size() ? (*brc_threads)[owner] : nullptr;
+    if (t) {
+        t->queue.push_back(n);
+        t->pending.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    // the owner has exited; its last update of the owner's references happened before it released its ID while
+    // holding the lock, and the ID cannot be reused while the lock is held
+    n->brcReleaseQueued();
+}
+#endif
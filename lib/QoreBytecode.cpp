@@ -0,0 +1,908 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreBytecode.cpp
+
+    register bytecode compiler and VM for user code blocks
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#include <qore/Qore.h>
+#include "qore/intern/QoreBytecode.h"
+#include "qore/intern/StatementBlock.h"
+#include "qore/intern/ExpressionStatement.h"
+#include "qore/intern/IfStatement.h"
+#include "qore/intern/WhileStatement.h"
+#include "qore/intern/DoWhileStatement.h"
+#include "qore/intern/ForStatement.h"
+#include "qore/intern/ReturnStatement.h"
+#include "qore/intern/BreakStatement.h"
+#include "qore/intern/ContinueStatement.h"
+#include "qore/intern/Function.h"
+
+#include <map>
+#include <memory>
+#include <typeinfo>
+
+#include <pthread.h>
+
+// use computed gotos for dispatching instructions where supported
+#ifdef __GNUC__
+#define QORE_BC_THREADED_DISPATCH
+#endif
+
+// the number of registers allocated on the stack when executing bytecode; larger register files use the heap
+#define QORE_BC_STACK_REGS 32
+
+// division by zero error messages, indexed by QoreBytecodeInsn::k.i
+enum qore_bc_err_e {
+    BCE_DIVI,
+    BCE_DIVEQI,
+    BCE_DIVF,
+    BCE_DIVEQF,
+};
+
+static const char* qore_bc_err[] = {
+    "division by zero found in integer expression",
+    "division by zero in integer expression",
+    "division by zero found in floating-point expression",
+    "division by zero in floating-point expression",
+};
+
+// the type of a value in a register
+enum qore_bc_type_e {
+    BCT_INT,
+    BCT_FLOAT,
+    BCT_BOOL,
+};
+
+// a compiled expression
+struct bc_operand_t {
+    int reg;
+    qore_bc_type_e type;
+    // true if the register is a temporary value and not a variable
+    bool temp;
+    // the index of the single instruction that set the value or -1 if none
+    int def;
+};
+
+class QoreBytecodeCompiler {
+public:
+    DLLLOCAL QoreBytecodeCompiler(QoreBytecode& bc, const UserVariantBase* uvb) : bc(bc) {
+        const UserSignature* sig = uvb->getUserSignature();
+        rti = sig->getReturnTypeInfo();
+
+        // parameters that can be loaded into registers are assigned the first registers
+        for (LocalVar* lv : sig->lv) {
+            qore_bc_type_e type;
+            if (lv->closureUse() || getType(lv->getTypeInfo(), type))
+                continue;
+            var_t& v = vars[lv];
+            v.op = {newReg(), type, false, -1};
+            v.param = true;
+        }
+    }
+
+    DLLLOCAL int compile(const StatementBlock* body) {
+        if (compileBlock(body))
+            return -1;
+        emit(QBC_RETN);
+
+        bc.nregs = max_top;
+        // only parameters used in the body are loaded
+        for (auto& i : vars) {
+            if (i.second.param && i.second.used) {
+                static const qore_type_t types[] = {NT_INT, NT_FLOAT, NT_BOOLEAN};
+                bc.params.push_back({i.first, i.second.op.reg, types[i.second.op.type]});
+            }
+        }
+        return 0;
+    }
+
+private:
+    struct var_t {
+        bc_operand_t op;
+        bool param = false;
+        bool used = false;
+    };
+
+    struct loop_t {
+        std::vector<size_t> breaks, continues;
+    };
+
+    QoreBytecode& bc;
+    const QoreTypeInfo* rti;
+    std::map<const LocalVar*, var_t> vars;
+    std::vector<loop_t> loops;
+    // the location of the current statement
+    const QoreProgramLocation* loc = nullptr;
+    // the next free register and the highest register used
+    int top = 0,
+        max_top = 0;
+    // the register after the last variable declared in the current statement
+    int decl_hwm = 0;
+
+    DLLLOCAL static int getType(const QoreTypeInfo* ti, qore_bc_type_e& type) {
+        if (ti == bigIntTypeInfo)
+            type = BCT_INT;
+        else if (ti == floatTypeInfo)
+            type = BCT_FLOAT;
+        else if (ti == boolTypeInfo)
+            type = BCT_BOOL;
+        else
+            return -1;
+        return 0;
+    }
+
+    DLLLOCAL int newReg() {
+        int rv = top++;
+        if (top > max_top)
+            max_top = top;
+        return rv;
+    }
+
+    DLLLOCAL int emit(qore_bc_op_e op, int a = 0, int b = 0, int c = 0, int64 k = 0) {
+        QoreBytecodeInsn insn;
+        insn.op = op;
+        insn.a = a;
+        insn.b = b;
+        insn.c = c;
+        insn.k.i = k;
+        insn.loc = loc;
+        bc.code.push_back(insn);
+        return (int)bc.code.size() - 1;
+    }
+
+    DLLLOCAL int emitFloat(qore_bc_op_e op, int a, int b, double k) {
+        int rv = emit(op, a, b);
+        bc.code[rv].k.f = k;
+        return rv;
+    }
+
+    // emits an instruction that writes a new temporary register
+    DLLLOCAL void emitTemp(bc_operand_t& rv, qore_bc_type_e type, qore_bc_op_e op, int b = 0, int c = 0, int64 k = 0) {
+        int reg = newReg();
+        rv = {reg, type, true, emit(op, reg, b, c, k)};
+    }
+
+    // sets the target of the given jump instruction to the next instruction
+    DLLLOCAL void patch(size_t i) {
+        bc.code[i].a = (int)bc.code.size();
+    }
+
+    DLLLOCAL void patch(const std::vector<size_t>& l, int target) {
+        for (size_t i : l)
+            bc.code[i].a = target;
+    }
+
+    // returns the local variable referenced by the given value or nullptr if it's not a simple local variable
+    DLLLOCAL static const VarRefNode* getLocalVarRef(const QoreValue& v) {
+        if (v.getType() != NT_VARREF)
+            return nullptr;
+        const VarRefNode* vr = v.get<const VarRefNode>();
+        const std::type_info& t = typeid(*vr);
+        if ((t != typeid(VarRefNode) && t != typeid(VarRefDeclNode)) || vr->getType() != VT_LOCAL
+            || vr->ref.id->closureUse())
+            return nullptr;
+        return vr;
+    }
+
+    // returns the register of a variable that has already been declared
+    DLLLOCAL int getVar(const QoreValue& v, bc_operand_t& rv) {
+        const VarRefNode* vr = getLocalVarRef(v);
+        if (!vr || vr->isDecl())
+            return -1;
+        auto i = vars.find(vr->ref.id);
+        if (i == vars.end())
+            return -1;
+        i->second.used = true;
+        rv = i->second.op;
+        return 0;
+    }
+
+    DLLLOCAL void toFloat(bc_operand_t& op) {
+        if (op.type == BCT_INT)
+            emitTemp(op, BCT_FLOAT, QBC_I2F, op.reg);
+    }
+
+    DLLLOCAL void toBool(const bc_operand_t& op, int dst) {
+        switch (op.type) {
+            case BCT_INT: emit(QBC_BOOLI, dst, op.reg); break;
+            case BCT_FLOAT: emit(QBC_BOOLF, dst, op.reg); break;
+            case BCT_BOOL: emit(QBC_MOV, dst, op.reg); break;
+        }
+    }
+
+    // stores the given value in the given register with the given type
+    DLLLOCAL int store(const bc_operand_t& op, qore_bc_type_e type, int dst) {
+        if (op.type == type) {
+            if (op.reg == dst)
+                return 0;
+            // write the result directly to the destination if the value was calculated by the last instruction
+            if (op.temp && op.def >= 0 && op.def == (int)bc.code.size() - 1)
+                bc.code[op.def].a = dst;
+            else
+                emit(QBC_MOV, dst, op.reg);
+            return 0;
+        }
+        if (type == BCT_FLOAT && op.type == BCT_INT) {
+            emit(QBC_I2F, dst, op.reg);
+            return 0;
+        }
+        return -1;
+    }
+
+    // emits a jump if the given condition is false (or true)
+    DLLLOCAL size_t emitCondJump(bc_operand_t c, bool if_true = false) {
+        if (c.type == BCT_FLOAT)
+            emitTemp(c, BCT_BOOL, QBC_BOOLF, c.reg);
+        return emit(if_true ? QBC_JMPT : QBC_JMPF, 0, c.reg);
+    }
+
+    // compiles an expression evaluated by a statement; temporary registers are released afterwards
+    DLLLOCAL int compileTopExpr(const QoreValue& v, bc_operand_t& rv, bool discard = false) {
+        decl_hwm = top;
+        if (compileExpr(v, rv, discard))
+            return -1;
+        top = decl_hwm;
+        return 0;
+    }
+
+    DLLLOCAL int compileBlock(const StatementBlock* b) {
+        if (!b)
+            return 0;
+        if (!b->on_block_exit_list.empty())
+            return -1;
+        int save = top;
+        StatementBlock* sb = const_cast<StatementBlock*>(b);
+        for (StatementBlock::statement_list_t::iterator i = sb->statement_list.begin(), e = sb->statement_list.end();
+            i != e; ++i) {
+            if (compileStatement(*i))
+                return -1;
+        }
+        top = save;
+        return 0;
+    }
+
+    DLLLOCAL int compileStatement(AbstractStatement* s) {
+        loc = s->loc;
+        const std::type_info& t = typeid(*s);
+
+        if (t == typeid(StatementBlock))
+            return compileBlock(static_cast<StatementBlock*>(s));
+
+        if (t == typeid(ExpressionStatement)) {
+            ExpressionStatement* es = static_cast<ExpressionStatement*>(s);
+            if (es->exp.isNothing())
+                return 0;
+            // variables must be initialized when declared
+            if (getLocalVarRef(es->exp))
+                return -1;
+            bc_operand_t rv;
+            return compileTopExpr(es->exp, rv, true);
+        }
+
+        if (t == typeid(IfStatement))
+            return compileIf(static_cast<IfStatement*>(s));
+
+        if (t == typeid(WhileStatement))
+            return compileWhile(static_cast<WhileStatement*>(s));
+
+        if (t == typeid(DoWhileStatement))
+            return compileDoWhile(static_cast<WhileStatement*>(s));
+
+        if (t == typeid(ForStatement))
+            return compileFor(static_cast<ForStatement*>(s));
+
+        if (t == typeid(ReturnStatement))
+            return compileReturn(static_cast<ReturnStatement*>(s));
+
+        if (t == typeid(BreakStatement) || t == typeid(ContinueStatement)) {
+            if (loops.empty())
+                return -1;
+            size_t j = emit(QBC_JMP);
+            if (t == typeid(BreakStatement))
+                loops.back().breaks.push_back(j);
+            else
+                loops.back().continues.push_back(j);
+            return 0;
+        }
+
+        return -1;
+    }
+
+    DLLLOCAL int compileIf(IfStatement* s) {
+        int save = top;
+        bc_operand_t c;
+        if (compileTopExpr(s->cond, c))
+            return -1;
+        size_t jf = emitCondJump(c);
+        if (compileBlock(s->if_code))
+            return -1;
+        if (s->else_code) {
+            size_t j = emit(QBC_JMP);
+            patch(jf);
+            if (compileBlock(s->else_code))
+                return -1;
+            patch(j);
+        }
+        else
+            patch(jf);
+        top = save;
+        return 0;
+    }
+
+    DLLLOCAL int compileLoopBody(const StatementBlock* code) {
+        loops.push_back(loop_t());
+        return compileBlock(code);
+    }
+
+    // patches break and continue statements of the current loop
+    DLLLOCAL void endLoop(int cont) {
+        patch(loops.back().continues, cont);
+        patch(loops.back().breaks, (int)bc.code.size());
+        loops.pop_back();
+    }
+
+    DLLLOCAL int compileWhile(WhileStatement* s) {
+        int save = top;
+        int start = (int)bc.code.size();
+        int jf = -1;
+        if (s->cond) {
+            bc_operand_t c;
+            if (compileTopExpr(s->cond, c))
+                return -1;
+            jf = emitCondJump(c);
+        }
+        if (compileLoopBody(s->code))
+            return -1;
+        emit(QBC_LOOP, start);
+        if (jf >= 0)
+            patch(jf);
+        endLoop(start);
+        top = save;
+        return 0;
+    }
+
+    DLLLOCAL int compileDoWhile(WhileStatement* s) {
+        int save = top;
+        int start = (int)bc.code.size();
+        if (compileLoopBody(s->code))
+            return -1;
+        int cont = (int)bc.code.size();
+        bc_operand_t c;
+        if (compileTopExpr(s->cond, c))
+            return -1;
+        size_t jf = emitCondJump(c);
+        emit(QBC_LOOP, start);
+        patch(jf);
+        endLoop(cont);
+        top = save;
+        return 0;
+    }
+
+    DLLLOCAL int compileFor(ForStatement* s) {
+        int save = top;
+        bc_operand_t rv;
+        if (s->assignment && compileTopExpr(s->assignment, rv, true))
+            return -1;
+        int start = (int)bc.code.size();
+        int jf = -1;
+        if (s->cond) {
+            if (compileTopExpr(s->cond, rv))
+                return -1;
+            jf = emitCondJump(rv);
+        }
+        if (compileLoopBody(s->code))
+            return -1;
+        int cont = (int)bc.code.size();
+        if (s->iterator && compileTopExpr(s->iterator, rv, true))
+            return -1;
+        emit(QBC_LOOP, start);
+        if (jf >= 0)
+            patch(jf);
+        endLoop(cont);
+        top = save;
+        return 0;
+    }
+
+    DLLLOCAL int compileReturn(ReturnStatement* s) {
+        if (s->exp.isNothing()) {
+            if (!QoreTypeInfo::parseAccepts(rti, nothingTypeInfo))
+                return -1;
+            emit(QBC_RETN);
+            return 0;
+        }
+
+        bc_operand_t rv;
+        if (compileTopExpr(s->exp, rv))
+            return -1;
+
+        // the value must be returned without a runtime type conversion other than int to float
+        if (!QoreTypeInfo::hasType(rti) || rti == anyTypeInfo || rti == autoTypeInfo) {
+        }
+        else if (rti == bigIntTypeInfo || rti == bigIntOrNothingTypeInfo) {
+            if (rv.type != BCT_INT)
+                return -1;
+        }
+        else if (rti == floatTypeInfo || rti == floatOrNothingTypeInfo) {
+            if (rv.type == BCT_BOOL)
+                return -1;
+            toFloat(rv);
+        }
+        else if (rti == boolTypeInfo || rti == boolOrNothingTypeInfo) {
+            if (rv.type != BCT_BOOL)
+                return -1;
+        }
+        else
+            return -1;
+
+        static const qore_bc_op_e ops[] = {QBC_RETI, QBC_RETF, QBC_RETB};
+        emit(ops[rv.type], 0, rv.reg);
+        return 0;
+    }
+
+    // compiles the operands of a binary operator
+    DLLLOCAL int compileOperands(const QoreValue& left, const QoreValue& right, bc_operand_t& l, bc_operand_t& r) {
+        if (compileExpr(left, l))
+            return -1;
+        // the left value must not be changed by side effects of the right expression
+        if (!l.temp && right.hasEffect()) {
+            int reg = newReg();
+            emit(QBC_MOV, reg, l.reg);
+            l = {reg, l.type, true, -1};
+        }
+        return compileExpr(right, r);
+    }
+
+    DLLLOCAL int compileArith(const QoreValue& left, const QoreValue& right, qore_bc_op_e iop, qore_bc_op_e fop,
+            bc_operand_t& rv, int64 err = 0) {
+        bc_operand_t l, r;
+        if (compileOperands(left, right, l, r) || l.type == BCT_BOOL || r.type == BCT_BOOL)
+            return -1;
+        if (l.type == BCT_INT && r.type == BCT_INT) {
+            emitTemp(rv, BCT_INT, iop, l.reg, r.reg, err);
+            return 0;
+        }
+        if (fop == QBC_RETN)
+            return -1;
+        toFloat(l);
+        toFloat(r);
+        emitTemp(rv, BCT_FLOAT, fop, l.reg, r.reg, err + 2);
+        return 0;
+    }
+
+    // compiles a comparison; booleans can only be compared with booleans and are compared as integers
+    DLLLOCAL int compileCompare(const QoreValue& left, const QoreValue& right, qore_bc_op_e iop, qore_bc_op_e fop,
+            bool swap, bc_operand_t& rv) {
+        bc_operand_t l, r;
+        if (compileOperands(left, right, l, r) || ((l.type == BCT_BOOL) != (r.type == BCT_BOOL)))
+            return -1;
+        if (swap)
+            std::swap(l, r);
+        if (l.type != BCT_FLOAT && r.type != BCT_FLOAT) {
+            emitTemp(rv, BCT_BOOL, iop, l.reg, r.reg);
+            return 0;
+        }
+        toFloat(l);
+        toFloat(r);
+        emitTemp(rv, BCT_BOOL, fop, l.reg, r.reg);
+        return 0;
+    }
+
+    DLLLOCAL int compileLogical(const QoreValue& left, const QoreValue& right, bool is_and, bc_operand_t& rv) {
+        int dst = newReg();
+        bc_operand_t op;
+        if (compileExpr(left, op))
+            return -1;
+        toBool(op, dst);
+        size_t j = emit(is_and ? QBC_JMPF : QBC_JMPT, 0, dst);
+        if (compileExpr(right, op))
+            return -1;
+        toBool(op, dst);
+        patch(j);
+        rv = {dst, BCT_BOOL, true, -1};
+        return 0;
+    }
+
+    DLLLOCAL int compileAssignment(const QoreValue& left, const QoreValue& right, bc_operand_t& rv) {
+        const VarRefNode* vr = getLocalVarRef(left);
+        if (!vr)
+            return -1;
+
+        if (vr->isDecl()) {
+            qore_bc_type_e type;
+            if (getType(vr->ref.id->getTypeInfo(), type))
+                return -1;
+            int reg = newReg();
+            if (decl_hwm < top)
+                decl_hwm = top;
+            // the variable is only visible after the initial value has been compiled
+            bc_operand_t r;
+            if (compileExpr(right, r) || store(r, type, reg))
+                return -1;
+            var_t& v = vars[vr->ref.id];
+            v.op = {reg, type, false, -1};
+            rv = v.op;
+            return 0;
+        }
+
+        bc_operand_t r;
+        if (getVar(left, rv) || compileExpr(right, r))
+            return -1;
+        return store(r, rv.type, rv.reg);
+    }
+
+    DLLLOCAL int compileOpAssignment(const QoreValue& left, const QoreValue& right, qore_bc_op_e iop,
+            qore_bc_op_e fop, bc_operand_t& rv, int64 err = 0) {
+        if (getVar(left, rv) || rv.type == BCT_BOOL)
+            return -1;
+
+        // add a constant integer to an integer variable
+        if (rv.type == BCT_INT && right.getType() == NT_INT && (iop == QBC_ADDI || iop == QBC_SUBI)) {
+            int64 k = right.getAsBigInt();
+            emit(QBC_ADDIK, rv.reg, rv.reg, 0, iop == QBC_ADDI ? k : (int64)(0 - (uint64_t)k));
+            return 0;
+        }
+
+        bc_operand_t r;
+        if (compileExpr(right, r) || r.type == BCT_BOOL)
+            return -1;
+        if (rv.type == BCT_INT) {
+            if (r.type != BCT_INT)
+                return -1;
+            emit(iop, rv.reg, rv.reg, r.reg, err);
+            return 0;
+        }
+        if (fop == QBC_RETN)
+            return -1;
+        toFloat(r);
+        emit(fop, rv.reg, rv.reg, r.reg, err + 2);
+        return 0;
+    }
+
+    DLLLOCAL int compileIncrement(const QoreValue& exp, int delta, bool post, bool discard, bc_operand_t& rv) {
+        bc_operand_t var;
+        if (getVar(exp, var) || var.type == BCT_BOOL)
+            return -1;
+        rv = var;
+        if (post && !discard) {
+            int reg = newReg();
+            emit(QBC_MOV, reg, var.reg);
+            rv = {reg, var.type, true, -1};
+        }
+        if (var.type == BCT_INT)
+            emit(QBC_ADDIK, var.reg, var.reg, 0, delta);
+        else
+            emitFloat(QBC_ADDFK, var.reg, var.reg, delta);
+        return 0;
+    }
+
+    DLLLOCAL int compileQuestionMark(const QoreQuestionMarkOperatorNode* op, bc_operand_t& rv) {
+        bc_operand_t c;
+        if (compileExpr(op->get(0), c))
+            return -1;
+        size_t jf = emitCondJump(c);
+        int dst = newReg();
+        bc_operand_t v;
+        if (compileExpr(op->get(1), v) || store(v, v.type, dst))
+            return -1;
+        qore_bc_type_e type = v.type;
+        size_t j = emit(QBC_JMP);
+        patch(jf);
+        if (compileExpr(op->get(2), v) || v.type != type || store(v, type, dst))
+            return -1;
+        patch(j);
+        rv = {dst, type, true, -1};
+        return 0;
+    }
+
+    DLLLOCAL int compileExpr(const QoreValue& v, bc_operand_t& rv, bool discard = false) {
+        switch (v.getType()) {
+            case NT_INT:
+                emitTemp(rv, BCT_INT, QBC_LOADK, 0, 0, v.getAsBigInt());
+                return 0;
+
+            case NT_FLOAT: {
+                emitTemp(rv, BCT_FLOAT, QBC_LOADK);
+                bc.code[rv.def].k.f = v.getAsFloat();
+                return 0;
+            }
+
+            case NT_BOOLEAN:
+                emitTemp(rv, BCT_BOOL, QBC_LOADK, 0, 0, v.getAsBool() ? 1 : 0);
+                return 0;
+
+            case NT_VARREF:
+                return getVar(v, rv);
+
+            case NT_OPERATOR:
+                break;
+
+            default:
+                return -1;
+        }
+
+        const AbstractQoreNode* n = v.getInternalNode();
+        const std::type_info& t = typeid(*n);
+
+#define QORE_BC_BINARY(cls) const cls* op = static_cast<const cls*>(n)
+        if (t == typeid(QoreAssignmentOperatorNode)) {
+            QORE_BC_BINARY(QoreAssignmentOperatorNode);
+            return compileAssignment(op->getLeft(), op->getRight(), rv);
+        }
+        if (t == typeid(QorePlusOperatorNode)) {
+            QORE_BC_BINARY(QorePlusOperatorNode);
+            return compileArith(op->getLeft(), op->getRight(), QBC_ADDI, QBC_ADDF, rv);
+        }
+        if (t == typeid(QoreMinusOperatorNode)) {
+            QORE_BC_BINARY(QoreMinusOperatorNode);
+            return compileArith(op->getLeft(), op->getRight(), QBC_SUBI, QBC_SUBF, rv);
+        }
+        if (t == typeid(QoreMultiplicationOperatorNode)) {
+            QORE_BC_BINARY(QoreMultiplicationOperatorNode);
+            return compileArith(op->getLeft(), op->getRight(), QBC_MULI, QBC_MULF, rv);
+        }
+        if (t == typeid(QoreDivisionOperatorNode)) {
+            QORE_BC_BINARY(QoreDivisionOperatorNode);
+            return compileArith(op->getLeft(), op->getRight(), QBC_DIVI, QBC_DIVF, rv, BCE_DIVI);
+        }
+        if (t == typeid(QoreModuloOperatorNode)) {
+            QORE_BC_BINARY(QoreModuloOperatorNode);
+            return compileArith(op->getLeft(), op->getRight(), QBC_MODI, QBC_RETN, rv);
+        }
+        if (t == typeid(QoreLogicalLessThanOperatorNode)) {
+            QORE_BC_BINARY(QoreLogicalLessThanOperatorNode);
+            return compileCompare(op->getLeft(), op->getRight(), QBC_LTI, QBC_LTF, false, rv);
+        }
+        if (t == typeid(QoreLogicalGreaterThanOperatorNode)) {
+            QORE_BC_BINARY(QoreLogicalGreaterThanOperatorNode);
+            return compileCompare(op->getLeft(), op->getRight(), QBC_LTI, QBC_LTF, true, rv);
+        }
+        if (t == typeid(QoreLogicalLessThanOrEqualsOperatorNode)) {
+            QORE_BC_BINARY(QoreLogicalLessThanOrEqualsOperatorNode);
+            return compileCompare(op->getLeft(), op->getRight(), QBC_LEI, QBC_LEF, false, rv);
+        }
+        if (t == typeid(QoreLogicalGreaterThanOrEqualsOperatorNode)) {
+            QORE_BC_BINARY(QoreLogicalGreaterThanOrEqualsOperatorNode);
+            return compileCompare(op->getLeft(), op->getRight(), QBC_LEI, QBC_LEF, true, rv);
+        }
+        if (t == typeid(QoreLogicalEqualsOperatorNode)) {
+            QORE_BC_BINARY(QoreLogicalEqualsOperatorNode);
+            return compileCompare(op->getLeft(), op->getRight(), QBC_EQI, QBC_EQF, false, rv);
+        }
+        if (t == typeid(QoreLogicalNotEqualsOperatorNode)) {
+            QORE_BC_BINARY(QoreLogicalNotEqualsOperatorNode);
+            return compileCompare(op->getLeft(), op->getRight(), QBC_NEI, QBC_NEF, false, rv);
+        }
+        if (t == typeid(QoreLogicalAndOperatorNode)) {
+            QORE_BC_BINARY(QoreLogicalAndOperatorNode);
+            return compileLogical(op->getLeft(), op->getRight(), true, rv);
+        }
+        if (t == typeid(QoreLogicalOrOperatorNode)) {
+            QORE_BC_BINARY(QoreLogicalOrOperatorNode);
+            return compileLogical(op->getLeft(), op->getRight(), false, rv);
+        }
+        if (t == typeid(QorePlusEqualsOperatorNode) || t == typeid(QoreIntPlusEqualsOperatorNode)) {
+            QORE_BC_BINARY(QoreBinaryLValueOperatorNode);
+            return compileOpAssignment(op->getLeft(), op->getRight(), QBC_ADDI, QBC_ADDF, rv);
+        }
+        if (t == typeid(QoreMinusEqualsOperatorNode) || t == typeid(QoreIntMinusEqualsOperatorNode)) {
+            QORE_BC_BINARY(QoreBinaryLValueOperatorNode);
+            return compileOpAssignment(op->getLeft(), op->getRight(), QBC_SUBI, QBC_SUBF, rv);
+        }
+        if (t == typeid(QoreMultiplyEqualsOperatorNode)) {
+            QORE_BC_BINARY(QoreBinaryLValueOperatorNode);
+            return compileOpAssignment(op->getLeft(), op->getRight(), QBC_MULI, QBC_MULF, rv);
+        }
+        if (t == typeid(QoreDivideEqualsOperatorNode)) {
+            QORE_BC_BINARY(QoreBinaryLValueOperatorNode);
+            return compileOpAssignment(op->getLeft(), op->getRight(), QBC_DIVI, QBC_DIVF, rv, BCE_DIVEQI);
+        }
+        if (t == typeid(QoreModuloEqualsOperatorNode)) {
+            QORE_BC_BINARY(QoreModuloEqualsOperatorNode);
+            return compileOpAssignment(op->getLeft(), op->getRight(), QBC_MODEQI, QBC_RETN, rv);
+        }
+#undef QORE_BC_BINARY
+
+#define QORE_BC_UNARY(cls) static_cast<const cls*>(n)->getExp()
+        if (t == typeid(QorePreIncrementOperatorNode) || t == typeid(QoreIntPreIncrementOperatorNode))
+            return compileIncrement(QORE_BC_UNARY(QorePreIncrementOperatorNode), 1, false, discard, rv);
+        if (t == typeid(QorePreDecrementOperatorNode) || t == typeid(QoreIntPreDecrementOperatorNode))
+            return compileIncrement(QORE_BC_UNARY(QorePreIncrementOperatorNode), -1, false, discard, rv);
+        if (t == typeid(QorePostIncrementOperatorNode) || t == typeid(QorePostDecrementOperatorNode))
+            return compileIncrement(QORE_BC_UNARY(QorePostIncrementOperatorNode),
+                t == typeid(QorePostIncrementOperatorNode) ? 1 : -1, true, discard, rv);
+        if (t == typeid(QoreIntPostIncrementOperatorNode) || t == typeid(QoreIntPostDecrementOperatorNode))
+            return compileIncrement(QORE_BC_UNARY(QoreIntPostIncrementOperatorNode),
+                t == typeid(QoreIntPostIncrementOperatorNode) ? 1 : -1, true, discard, rv);
+
+        if (t == typeid(QoreUnaryMinusOperatorNode)) {
+            bc_operand_t op;
+            if (compileExpr(QORE_BC_UNARY(QoreUnaryMinusOperatorNode), op) || op.type == BCT_BOOL)
+                return -1;
+            emitTemp(rv, op.type, op.type == BCT_INT ? QBC_NEGI : QBC_NEGF, op.reg);
+            return 0;
+        }
+        if (t == typeid(QoreLogicalNotOperatorNode)) {
+            bc_operand_t op;
+            if (compileExpr(QORE_BC_UNARY(QoreLogicalNotOperatorNode), op))
+                return -1;
+            emitTemp(rv, BCT_BOOL, op.type == BCT_FLOAT ? QBC_NOTF : QBC_NOTI, op.reg);
+            return 0;
+        }
+#undef QORE_BC_UNARY
+
+        if (t == typeid(QoreQuestionMarkOperatorNode))
+            return compileQuestionMark(static_cast<const QoreQuestionMarkOperatorNode*>(n), rv);
+
+        return -1;
+    }
+};
+
+QoreBytecode* QoreBytecode::compile(const StatementBlock* body, const UserVariantBase* uvb) {
+    std::unique_ptr<QoreBytecode> bc(new QoreBytecode);
+    QoreBytecodeCompiler compiler(*bc, uvb);
+    if (compiler.compile(body))
+        return nullptr;
+    //printd(5, "QoreBytecode::compile() body: %p compiled to %d instructions with %d registers\n", body, (int)bc->code.size(), bc->nregs);
+    return bc.release();
+}
+
+void QoreBytecode::raiseDivisionByZero(const QoreBytecodeInsn* pc, int64 l, int64 r, ExceptionSink* xsink) {
+    // the exception is raised with the location of the statement
+    QoreProgramLocationHelper lh(pc->loc);
+    if (pc->op == QBC_MODI)
+        xsink->raiseException("DIVISION-BY-ZERO", "modula operand cannot be zero (" QLLD " %% " QLLD " attempted)", l, r);
+    else
+        xsink->raiseException("DIVISION-BY-ZERO", "%s", qore_bc_err[pc->k.i]);
+}
+
+int QoreBytecode::exec(QoreValue& return_value, ExceptionSink* xsink) const {
+    QoreBytecodeReg stack_regs[QORE_BC_STACK_REGS];
+    std::unique_ptr<QoreBytecodeReg[]> heap_regs;
+    QoreBytecodeReg* r = stack_regs;
+    if (nregs > QORE_BC_STACK_REGS) {
+        heap_regs.reset(new QoreBytecodeReg[nregs]);
+        r = heap_regs.get();
+    }
+
+    // load parameters; if any argument does not have the declared type, the parse tree is executed instead
+    for (const param_t& p : params) {
+        bool needs_deref;
+        QoreValue v = p.lv->eval(needs_deref, xsink);
+        if (v.getType() != p.type) {
+            if (needs_deref)
+                v.discard(xsink);
+            return -1;
+        }
+        switch (p.type) {
+            case NT_INT: r[p.reg].i = v.getAsBigInt(); break;
+            case NT_FLOAT: r[p.reg].f = v.getAsFloat(); break;
+            default: r[p.reg].i = v.getAsBool(); break;
+        }
+    }
+
+    const QoreBytecodeInsn* const base = &code[0];
+    const QoreBytecodeInsn* pc = base;
+
+#ifdef QORE_BC_THREADED_DISPATCH
+#define QORE_BC_LABEL(op) &&op_##op,
+    static const void* const dispatch[] = {
+        QORE_BC_OPCODES(QORE_BC_LABEL)
+    };
+#undef QORE_BC_LABEL
+#define BC_OP(op) op_##op
+#define BC_NEXT() goto *dispatch[(++pc)->op]
+#define BC_GOTO(target) do { pc = base + (target); goto *dispatch[pc->op]; } while (0)
+    goto *dispatch[pc->op];
+#else
+#define BC_OP(op) case QBC_##op
+#define BC_NEXT() do { ++pc; goto next_insn; } while (0)
+#define BC_GOTO(target) do { pc = base + (target); goto next_insn; } while (0)
+next_insn:
+    switch (pc->op) {
+#endif
+    BC_OP(MOV): r[pc->a] = r[pc->b]; BC_NEXT();
+    BC_OP(LOADK): r[pc->a] = pc->k; BC_NEXT();
+    BC_OP(I2F): r[pc->a].f = (double)r[pc->b].i; BC_NEXT();
+
+    // integer arithmetic wraps around like the parse tree implementation, but without undefined behavior
+    BC_OP(ADDI): r[pc->a].i = (int64)((uint64_t)r[pc->b].i + (uint64_t)r[pc->c].i); BC_NEXT();
+    BC_OP(ADDIK): r[pc->a].i = (int64)((uint64_t)r[pc->b].i + (uint64_t)pc->k.i); BC_NEXT();
+    BC_OP(SUBI): r[pc->a].i = (int64)((uint64_t)r[pc->b].i - (uint64_t)r[pc->c].i); BC_NEXT();
+    BC_OP(MULI): r[pc->a].i = (int64)((uint64_t)r[pc->b].i * (uint64_t)r[pc->c].i); BC_NEXT();
+    BC_OP(DIVI):
+        if (!r[pc->c].i) {
+            raiseDivisionByZero(pc, r[pc->b].i, 0, xsink);
+            return 0;
+        }
+        r[pc->a].i = r[pc->b].i / r[pc->c].i;
+        BC_NEXT();
+    BC_OP(MODI):
+        if (!r[pc->c].i) {
+            raiseDivisionByZero(pc, r[pc->b].i, 0, xsink);
+            return 0;
+        }
+        r[pc->a].i = r[pc->b].i % r[pc->c].i;
+        BC_NEXT();
+    BC_OP(MODEQI): r[pc->a].i = r[pc->c].i ? r[pc->b].i % r[pc->c].i : 0; BC_NEXT();
+    BC_OP(NEGI): r[pc->a].i = (int64)(0 - (uint64_t)r[pc->b].i); BC_NEXT();
+
+    BC_OP(ADDF): r[pc->a].f = r[pc->b].f + r[pc->c].f; BC_NEXT();
+    BC_OP(ADDFK): r[pc->a].f = r[pc->b].f + pc->k.f; BC_NEXT();
+    BC_OP(SUBF): r[pc->a].f = r[pc->b].f - r[pc->c].f; BC_NEXT();
+    BC_OP(MULF): r[pc->a].f = r[pc->b].f * r[pc->c].f; BC_NEXT();
+    BC_OP(DIVF):
+        if (r[pc->c].f == 0.0) {
+            raiseDivisionByZero(pc, 0, 0, xsink);
+            return 0;
+        }
+        r[pc->a].f = r[pc->b].f / r[pc->c].f;
+        BC_NEXT();
+    BC_OP(NEGF): r[pc->a].f = -r[pc->b].f; BC_NEXT();
+
+    BC_OP(LTI): r[pc->a].i = r[pc->b].i < r[pc->c].i; BC_NEXT();
+    BC_OP(LEI): r[pc->a].i = r[pc->b].i <= r[pc->c].i; BC_NEXT();
+    BC_OP(EQI): r[pc->a].i = r[pc->b].i == r[pc->c].i; BC_NEXT();
+    BC_OP(NEI): r[pc->a].i = r[pc->b].i != r[pc->c].i; BC_NEXT();
+    BC_OP(LTF): r[pc->a].i = r[pc->b].f < r[pc->c].f; BC_NEXT();
+    BC_OP(LEF): r[pc->a].i = r[pc->b].f <= r[pc->c].f; BC_NEXT();
+    BC_OP(EQF): r[pc->a].i = r[pc->b].f == r[pc->c].f; BC_NEXT();
+    BC_OP(NEF): r[pc->a].i = r[pc->b].f != r[pc->c].f; BC_NEXT();
+    BC_OP(BOOLI): r[pc->a].i = r[pc->b].i != 0; BC_NEXT();
+    BC_OP(BOOLF): r[pc->a].i = r[pc->b].f != 0.0; BC_NEXT();
+    BC_OP(NOTI): r[pc->a].i = !r[pc->b].i; BC_NEXT();
+    BC_OP(NOTF): r[pc->a].i = !r[pc->b].f; BC_NEXT();
+
+    BC_OP(JMP): BC_GOTO(pc->a);
+    BC_OP(JMPF):
+        if (!r[pc->b].i)
+            BC_GOTO(pc->a);
+        BC_NEXT();
+    BC_OP(JMPT):
+        if (r[pc->b].i)
+            BC_GOTO(pc->a);
+        BC_NEXT();
+    BC_OP(LOOP):
+        // loops can be canceled like loops in the parse tree
+        pthread_testcancel();
+        BC_GOTO(pc->a);
+
+    BC_OP(RETI): return_value = r[pc->b].i; return 0;
+    BC_OP(RETF): return_value = r[pc->b].f; return 0;
+    BC_OP(RETB): return_value = (bool)r[pc->b].i; return 0;
+    BC_OP(RETN): return 0;
+#ifndef QORE_BC_THREADED_DISPATCH
+    }
+    assert(false);
+    return 0;
+#endif
+#undef BC_OP
+#undef BC_NEXT
+#undef BC_GOTO
+}
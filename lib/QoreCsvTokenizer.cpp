@@ -0,0 +1,282 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreCsvTokenizer.cpp
+
+    splits and formats lines of CSV data
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#include <qore/Qore.h>
+#include "qore/intern/QoreCsvTokenizer.h"
+#include "qore/intern/QoreSubstringSearch.h"
+
+#include <string.h>
+
+static bool csv_is_ascii(const std::string& str) {
+    for (unsigned char c : str) {
+        if (c & 0x80)
+            return false;
+    }
+    return true;
+}
+
+QoreCsvTokenizer::QoreCsvTokenizer(const QoreHashNode* opts, ExceptionSink* xsink) {
+    if (!opts)
+        return;
+
+    // the encoding must be set before any strings are converted
+    QoreValue v = opts->getKeyValue("encoding");
+    if (!v.isNothing()) {
+        if (v.getType() != NT_STRING) {
+            xsink->raiseException("CSVTOKENIZER-OPTION-ERROR", "expecting a string value for option \"encoding\"; "
+                "got type \"%s\" instead", v.getTypeName());
+            return;
+        }
+        enc = QEM.findCreate(v.get<const QoreStringNode>());
+    }
+
+    ConstHashIterator hi(opts);
+    while (hi.next()) {
+        const char* key = hi.getKey();
+        v = hi.get();
+        if (!strcmp(key, "encoding"))
+            continue;
+        if (!strcmp(key, "separator")) {
+            if (setString(sep, key, v, xsink))
+                return;
+            if (sep.empty()) {
+                xsink->raiseException("CSVTOKENIZER-OPTION-ERROR", "the \"separator\" option cannot be empty");
+                return;
+            }
+            continue;
+        }
+        if (!strcmp(key, "quote")) {
+            if (setString(quote, key, v, xsink))
+                return;
+            continue;
+        }
+        if (!strcmp(key, "quote_escape")) {
+            if (setString(escape, key, v, xsink))
+                return;
+            continue;
+        }
+        if (!strcmp(key, "eol")) {
+            if (setString(eol, key, v, xsink))
+                return;
+            continue;
+        }
+        if (!strcmp(key, "ignore_whitespace")) {
+            trim = v.getAsBool();
+            continue;
+        }
+        if (!strcmp(key, "optimal_quotes")) {
+            optimal_quotes = v.getAsBool();
+            continue;
+        }
+        xsink->raiseException("CSVTOKENIZER-OPTION-ERROR", "unknown option \"%s\"; known options: encoding, eol, "
+            "ignore_whitespace, optimal_quotes, quote, quote_escape, separator", key);
+        return;
+    }
+
+    ascii = enc->isAsciiCompat() && csv_is_ascii(sep) && csv_is_ascii(quote);
+}
+
+int QoreCsvTokenizer::setString(std::string& str, const char* opt, QoreValue v, ExceptionSink* xsink) {
+    if (v.getType() != NT_STRING) {
+        xsink->raiseException("CSVTOKENIZER-OPTION-ERROR", "expecting a string value for option \"%s\"; got type "
+            "\"%s\" instead", opt, v.getTypeName());
+        return -1;
+    }
+    TempEncodingHelper tmp(v.get<const QoreStringNode>(), enc, xsink);
+    if (*xsink)
+        return -1;
+    str.assign(tmp->c_str(), tmp->size());
+    return 0;
+}
+
+QoreListNode* QoreCsvTokenizer::split(const QoreString* line, ExceptionSink* xsink) const {
+    const QoreEncoding* lenc = line->getEncoding();
+    if (lenc == enc || (ascii && lenc->isAsciiCompat()))
+        return splitIntern(line->c_str(), line->size(), lenc, sep.data(), sep.size(), quote.data(), quote.size(),
+            xsink);
+
+    // convert the separator and quote to the line's encoding
+    QoreString sep_str(sep.data(), sep.size(), enc);
+    TempEncodingHelper tsep(sep_str, lenc, xsink);
+    if (*xsink)
+        return nullptr;
+    QoreString quote_str(quote.data(), quote.size(), enc);
+    TempEncodingHelper tquote(quote_str, lenc, xsink);
+    if (*xsink)
+        return nullptr;
+    return splitIntern(line->c_str(), line->size(), lenc, tsep->c_str(), tsep->size(), tquote->c_str(),
+        tquote->size(), xsink);
+}
+
+QoreListNode* QoreCsvTokenizer::splitIntern(const char* str, size_t len, const QoreEncoding* lenc, const char* sepp,
+        size_t sl, const char* qp, size_t ql, ExceptionSink* xsink) const {
+    ReferenceHolder<QoreListNode> l(new QoreListNode(stringTypeInfo), xsink);
+
+    // separators and quotes are found with memchr() for single-byte strings
+    QoreSubstringSearch sep_search(sepp, sl);
+    QoreSubstringSearch quote_search(qp, ql);
+
+    const char* end = str + len;
+    const char* p = str;
+    while (p < end) {
+        size_t left = end - p;
+        // a quoted field must begin with the quote and have room for the closing quote
+        if (ql && left >= ql * 2 && !memcmp(p, qp, ql)) {
+            p += ql;
+            SimpleRefHolder<QoreStringNode> field(new QoreStringNode(lenc));
+            // the start of the data not yet copied to the field
+            const char* start = p;
+            const char* scan = p;
+            const char* q;
+            while (true) {
+                q = quote_search.find(scan, end - scan);
+                if (!q) {
+                    xsink->raiseException("SPLIT-ERROR", "cannot find closing quote '%s' in field " QSD, quote.c_str(),
+                        l->size() + 1);
+                    return nullptr;
+                }
+                // a quote preceded by a backslash is part of the field
+                if (q != scan && q[-1] == '\\') {
+                    scan = q + ql;
+                    continue;
+                }
+                // a doubled quote is an escaped quote (RFC 4180); only one quote is copied to the field
+                if ((size_t)(end - q) >= ql * 2 && !memcmp(q + ql, qp, ql)) {
+                    field->concat(start, q + ql - start);
+                    start = scan = q + ql * 2;
+                    continue;
+                }
+                break;
+            }
+            field->concat(start, q - start);
+            l->push(field.release(), nullptr);
+
+            p = q + ql;
+            if (p == end)
+                break;
+
+            // a separator must follow the closing quote
+            if ((size_t)(end - p) < sl || memcmp(p, sepp, sl)) {
+                xsink->raiseException("SPLIT-ERROR", "separator pattern '%s' does not follow end quote in field " QSD,
+                    sep.c_str(), l->size());
+                return nullptr;
+            }
+            p += sl;
+            continue;
+        }
+
+        const char* s = sep_search.find(p, left);
+        const char* fend = s ? s : end;
+        SimpleRefHolder<QoreStringNode> field(new QoreStringNode(p, fend - p, lenc));
+        if (trim && field->trim(xsink))
+            return nullptr;
+        l->push(field.release(), nullptr);
+        if (!s)
+            break;
+        p = s + sl;
+        // a separator at the end of the line after an unquoted field is followed by an empty field like with split()
+        if (p == end)
+            l->push(new QoreStringNode(lenc), nullptr);
+    }
+
+    return l.release();
+}
+
+QoreHashNode* QoreCsvTokenizer::splitToHash(const QoreString* line, const QoreListNode* headers,
+        ExceptionSink* xsink) const {
+    ReferenceHolder<QoreListNode> l(split(line, xsink), xsink);
+    if (!l)
+        return nullptr;
+
+    ReferenceHolder<QoreHashNode> h(new QoreHashNode(autoTypeInfo), xsink);
+    size_t hsize = headers ? headers->size() : 0;
+    for (size_t i = 0, e = l->size(); i < e; ++i) {
+        QoreValue v = l->getReferencedEntry(i);
+        if (i < hsize) {
+            QoreStringValueHelper key(headers->retrieveEntry(i));
+            h->setKeyValue(**key, v, xsink);
+        }
+        else {
+            QoreString key;
+            key.sprintf(QSD, i);
+            h->setKeyValue(key, v, xsink);
+        }
+        if (*xsink)
+            return nullptr;
+    }
+
+    return h.release();
+}
+
+bool QoreCsvTokenizer::needsQuotes(const char* str, size_t len) const {
+    return QoreSubstringSearch::find(str, len, quote.data(), quote.size())
+        || QoreSubstringSearch::find(str, len, sep.data(), sep.size())
+        || memchr(str, '\n', len) || memchr(str, '\r', len);
+}
+
+QoreStringNode* QoreCsvTokenizer::join(const QoreListNode* values, ExceptionSink* xsink) const {
+    SimpleRefHolder<QoreStringNode> rv(new QoreStringNode(enc));
+
+    for (size_t i = 0, e = values->size(); i < e; ++i) {
+        if (i)
+            rv->concat(sep.data(), sep.size());
+
+        QoreValue v = values->retrieveEntry(i);
+        QoreStringValueHelper str(v, enc, xsink);
+        if (*xsink)
+            return nullptr;
+
+        // only string values are quoted with optimal quoting; fields cannot be quoted without a quote string
+        if (quote.empty() || (optimal_quotes && (v.getType() != NT_STRING || !needsQuotes(str->c_str(), str->size())))) {
+            rv->concat(str->c_str(), str->size());
+            continue;
+        }
+
+        // quote the field and escape all quotes in it
+        rv->concat(quote.data(), quote.size());
+        const char* p = str->c_str();
+        const char* end = p + str->size();
+        QoreSubstringSearch quote_search(quote.data(), quote.size());
+        while (const char* q = quote_search.find(p, end - p)) {
+            rv->concat(p, q - p);
+            rv->concat(escape.data(), escape.size());
+            rv->concat(quote.data(), quote.size());
+            p = q + quote.size();
+        }
+        rv->concat(p, end - p);
+        rv->concat(quote.data(), quote.size());
+    }
+
+    rv->concat(eol.data(), eol.size());
+    return rv.release();
+}
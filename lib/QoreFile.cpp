@@ -316,12 +316,7 @@ int QoreFile::readUntil(const char* bytes, QoreString& str, bool incl_bytes) {
 }
 
 qore_size_t QoreFile::setPos(qore_size_t pos) {
-   AutoLocker al(priv->m);
-
-   if (!priv->is_open)
-      return -1;
-
-   return lseek(priv->fd, pos, SEEK_SET);
+   return priv->setPos(pos);
 }
 
 // FIXME: deleteme
@@ -531,6 +526,10 @@ BinaryNode *QoreFile::readBinary(qore_offset_t size, int timeout_ms, ExceptionSi
    return new BinaryNode(buf, size);
 }
 
+BinaryNode* QoreFile::mapBinary(qore_offset_t offset, qore_offset_t size, ExceptionSink* xsink) {
+   return priv->mapBinary(offset, size, xsink);
+}
+
 qore_size_t QoreFile::read(void *ptr, qore_size_t limit, int timeout_ms, ExceptionSink *xsink) {
    if (timeout_ms >= 0 && !priv->isDataAvailable(timeout_ms, xsink)) {
       xsink->raiseException("FILE-READ-TIMEOUT-ERROR", "timeout limit exceeded (%d ms) reading file", timeout_ms);
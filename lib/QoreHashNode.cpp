@@ -101,15 +101,12 @@ int qore_hash_private::getLValue(const char* key, LValueHelper& lvh, bool for_re
     else if (complexTypeInfo)
         memTypeInfo = QoreTypeInfo::getUniqueReturnComplexHash(complexTypeInfo);
 
-    hm_hm_t::const_iterator i = hm.find(key);
-    HashMember* m;
-    if (i == hm.end()) {
+    HashMember* m = member_list.find(key);
+    if (!m) {
         if (for_remove)
             return -1;
-        m = findCreateMember(key);
+        m = member_list.create(key);
     }
-    else
-        m = (*(i->second));
 
     //printd(5, "qore_hash_private::getLValue() this: %p hd: %p ct: %p key: '%s' type: '%s'\n", this, hashdecl, complexTypeInfo, key, QoreTypeInfo::getName(memTypeInfo));
 
@@ -275,11 +272,11 @@ QoreValue qore_hash_private::getKeyValueExistence(const char* key, bool& exists,
 }
 
 QoreValue qore_hash_private::getKeyValueExistenceIntern(const char* key, bool& exists) const {
-    hm_hm_t::const_iterator i = hm.find(key);
+    HashMember* m = member_list.find(key);
 
-    if (i != hm.end()) {
+    if (m) {
         exists = true;
-        return (*i->second)->val;
+        return m->val;
     }
 
     exists = false;
@@ -287,14 +284,41 @@ QoreValue qore_hash_private::getKeyValueExistenceIntern(const char* key, bool& e
 }
 
 QoreValue qore_hash_private::getKeyValueIntern(const char* key) const {
-    hm_hm_t::const_iterator i = hm.find(key);
-    return i != hm.end() ? (*i->second)->val : QoreValue();
+    HashMember* m = member_list.find(key);
+    return m ? m->val : QoreValue();
+}
+
+// returns the private data for a new hash, using the storage co-allocated with the node if available
+static qore_hash_private* new_hash_private(QoreHashNode* h) {
+#ifdef QORE_NODE_COALLOC
+    void* p = q_slab_take_coalloc(h, sizeof(QoreHashNode));
+    if (p)
+        return ::new (p) qore_hash_private;
+#endif
+    return new qore_hash_private;
+}
+
+QoreHashNode::QoreHashNode(bool ne) : AbstractQoreNode(NT_HASH, !ne, ne), priv(new_hash_private(this)) {
+}
+
+QoreHashNode::QoreHashNode() : AbstractQoreNode(NT_HASH, true, false), priv(new_hash_private(this)) {
 }
 
-QoreHashNode::QoreHashNode(bool ne) : AbstractQoreNode(NT_HASH, !ne, ne), priv(new qore_hash_private) {
+void* QoreHashNode::operator new(size_t size) {
+#ifdef QORE_NODE_COALLOC
+    // only plain hashes are co-allocated with their private data
+    if (size == sizeof(QoreHashNode))
+        return q_slab_alloc_coalloc(size, sizeof(qore_hash_private));
+#endif
+    return q_slab_alloc(size);
 }
 
-QoreHashNode::QoreHashNode() : AbstractQoreNode(NT_HASH, true, false), priv(new qore_hash_private) {
+void QoreHashNode::operator delete(void* p, size_t size) {
+#ifdef QORE_NODE_COALLOC
+    if (size == sizeof(QoreHashNode))
+        size = q_slab_coalloc_size(size, sizeof(qore_hash_private));
+#endif
+    q_slab_free(p, size);
 }
 
 QoreHashNode::QoreHashNode(const TypedHashDecl* hd, ExceptionSink* xsink) : QoreHashNode() {
@@ -311,6 +335,12 @@ QoreHashNode::QoreHashNode(const QoreTypeInfo* valueTypeInfo) : QoreHashNode() {
 }
 
 QoreHashNode::~QoreHashNode() {
+#ifdef QORE_NODE_COALLOC
+   if (q_slab_is_coalloc(this, sizeof(QoreHashNode), priv)) {
+      priv->~qore_hash_private();
+      return;
+   }
+#endif
    delete priv;
 }
 
@@ -485,11 +515,11 @@ bool QoreHashNode::compareSoft(const QoreHashNode* h, ExceptionSink* xsink) cons
 
     ConstHashIterator hi(this);
     while (hi.next()) {
-        hm_hm_t::const_iterator j = h->priv->hm.find(hi.getKey());
-        if (j == h->priv->hm.end())
+        HashMember* m = h->priv->member_list.find(hi.getKey());
+        if (!m)
             return 1;
 
-        if (!hi.get().isEqualSoft((*j->second)->val, xsink)) {
+        if (!hi.get().isEqualSoft(m->val, xsink)) {
             return 1;
         }
     }
@@ -504,11 +534,11 @@ bool QoreHashNode::compareHard(const QoreHashNode* h, ExceptionSink* xsink) cons
 
     ConstHashIterator hi(this);
     while (hi.next()) {
-        hm_hm_t::const_iterator j = h->priv->hm.find(hi.getKey());
-        if (j == h->priv->hm.end())
+        HashMember* m = h->priv->member_list.find(hi.getKey());
+        if (!m)
             return 1;
 
-        if (!hi.get().isEqualHard((*j->second)->val)) {
+        if (!hi.get().isEqualHard(m->val)) {
             return 1;
         }
     }
@@ -738,13 +768,10 @@ void HashIterator::deleteKey(ExceptionSink* xsink) {
 
     (*(priv->i))->val.discard(xsink);
 
-    qhlist_t::iterator ni = priv->i;
+    HashMember* m = *priv->i;
     priv->prev(h->priv->member_list);
 
-    hm_hm_t::iterator i = h->priv->hm.find((*ni)->key.c_str());
-    assert(i != h->priv->hm.end());
-    h->priv->hm.erase(i);
-    h->priv->internDeleteKey(ni);
+    h->priv->internDeleteKey(m);
 }
 
 QoreValue HashIterator::removeKeyValue() {
@@ -759,13 +786,10 @@ QoreValue HashIterator::removeKeyValue() {
         h->priv->incScanCount(-1);
     }
 
-    qhlist_t::iterator ni = priv->i;
+    HashMember* m = *priv->i;
     priv->prev(h->priv->member_list);
 
-    hm_hm_t::iterator i = h->priv->hm.find((*ni)->key.c_str());
-    assert(i != h->priv->hm.end());
-    h->priv->hm.erase(i);
-    h->priv->internDeleteKey(ni);
+    h->priv->internDeleteKey(m);
 
     return rv;
 }
@@ -934,6 +958,9 @@ hash_assignment_priv::hash_assignment_priv(QoreHashNode& n_h, const char* key, b
 hash_assignment_priv::hash_assignment_priv(QoreHashNode& n_h, const std::string& key, bool must_already_exist) : h(*n_h.priv), om(must_already_exist ? h.findMember(key.c_str()) : h.findCreateMember(key.c_str())) {
 }
 
+hash_assignment_priv::hash_assignment_priv(QoreHashNode& n_h, const char* key, size_t hash) : h(*n_h.priv), om(h.findCreateMember(key, hash)) {
+}
+
 hash_assignment_priv::hash_assignment_priv(ExceptionSink* xsink, QoreHashNode& n_h, const QoreString& key, bool must_already_exist) : h(*n_h.priv), om(0) {
    TempEncodingHelper k(key, QCS_DEFAULT, xsink);
    if (*xsink)
@@ -92,7 +92,12 @@ struct qore_httpclient_priv {
         default_headers["Content-Type"] = "text/html";
         default_headers["Connection"] = "Keep-Alive";
         default_headers["User-Agent"] = "Qore-HTTP-Client/" PACKAGE_VERSION;
+#ifdef HAVE_ZSTD
+        // zstd is preferred if available as it compresses better than gzip with less CPU overhead
+        default_headers["Accept-Encoding"] = "zstd,deflate,gzip,bzip2";
+#else
         default_headers["Accept-Encoding"] = "deflate,gzip,bzip2";
+#endif
     }
 
     DLLLOCAL ~qore_httpclient_priv() {
@@ -1313,6 +1318,10 @@ QoreHashNode* qore_httpclient_priv::send_internal(ExceptionSink* xsink, const ch
                     dec = qore_gunzip_to_string;
                 else if (!strcasecmp(content_encoding, "bzip2") || !strcasecmp(content_encoding, "x-bzip2"))
                     dec = qore_bunzip2_to_string;
+                else if (!strcasecmp(content_encoding, "zstd"))
+                    dec = qore_unzstd_to_string;
+                else if (!strcasecmp(content_encoding, "lz4"))
+                    dec = qore_unlz4_to_string;
             }
         }
 
@@ -351,6 +351,24 @@ const qore_option_s qore_option_list_l[] = {
     false
 #endif
   },
+   { QORE_OPT_ZSTD,
+     "HAVE_ZSTD",
+     QO_ALGORITHM,
+#ifdef HAVE_ZSTD
+     true
+#else
+     false
+#endif
+   },
+   { QORE_OPT_LZ4,
+     "HAVE_LZ4",
+     QO_ALGORITHM,
+#ifdef HAVE_LZ4
+     true
+#else
+     false
+#endif
+   },
   { QORE_OPT_FUNC_ROUND,
      "HAVE_ROUND",
      QO_FUNCTION,
@@ -45,6 +45,8 @@
 #endif
 
 #include <algorithm>
+#include <cmath>
+#include <vector>
 
 #define LIST_BLOCK 20
 #define LIST_PAD   15
@@ -96,7 +98,7 @@ int qore_list_private::getLValue(size_t ind, LValueHelper& lvh, bool for_remove,
         resize(ind + 1);
     }
 
-    lvh.resetValue(entry[ind], complexTypeInfo ? QoreTypeInfo::getUniqueReturnComplexList(complexTypeInfo) : nullptr);
+    lvh.resetValue(entryRef(ind), complexTypeInfo ? QoreTypeInfo::getUniqueReturnComplexList(complexTypeInfo) : nullptr);
     return 0;
 }
 
@@ -241,11 +243,21 @@ QoreListNode* qore_list_private::newComplexListFromValue(const QoreTypeInfo* typ
     return holder.release().get<QoreListNode>();
 }
 
-QoreListNode::QoreListNode() : AbstractQoreNode(NT_LIST, true, false), priv(new qore_list_private) {
+// returns the private data for a new list, using the storage co-allocated with the node if available
+static qore_list_private* new_list_private(QoreListNode* l) {
+#ifdef QORE_NODE_COALLOC
+    void* p = q_slab_take_coalloc(l, sizeof(QoreListNode));
+    if (p)
+        return ::new (p) qore_list_private;
+#endif
+    return new qore_list_private;
+}
+
+QoreListNode::QoreListNode() : AbstractQoreNode(NT_LIST, true, false), priv(new_list_private(this)) {
    //printd(5, "QoreListNode::QoreListNode() 1 this=%p ne=%d v=%d\n", this, needs_eval_flag, value);
 }
 
-QoreListNode::QoreListNode(bool i) : AbstractQoreNode(NT_LIST, !i, i), priv(new qore_list_private) {
+QoreListNode::QoreListNode(bool i) : AbstractQoreNode(NT_LIST, !i, i), priv(new_list_private(this)) {
    //printd(5, "QoreListNode::QoreListNode() 2 this=%p ne=%d v=%d\n", this, needs_eval_flag, value);
 }
 
@@ -256,9 +268,32 @@ QoreListNode::QoreListNode(const QoreTypeInfo* valueTypeInfo) : QoreListNode() {
 }
 
 QoreListNode::~QoreListNode() {
+#ifdef QORE_NODE_COALLOC
+    if (q_slab_is_coalloc(this, sizeof(QoreListNode), priv)) {
+        priv->~qore_list_private();
+        return;
+    }
+#endif
     delete priv;
 }
 
+void* QoreListNode::operator new(size_t size) {
+#ifdef QORE_NODE_COALLOC
+    // only plain lists are co-allocated with their private data
+    if (size == sizeof(QoreListNode))
+        return q_slab_alloc_coalloc(size, sizeof(qore_list_private));
+#endif
+    return q_slab_alloc(size);
+}
+
+void QoreListNode::operator delete(void* p, size_t size) {
+#ifdef QORE_NODE_COALLOC
+    if (size == sizeof(QoreListNode))
+        size = q_slab_coalloc_size(size, sizeof(qore_list_private));
+#endif
+    q_slab_free(p, size);
+}
+
 AbstractQoreNode* QoreListNode::realCopy() const {
     return copy();
 }
@@ -304,28 +339,28 @@ const QoreValue QoreListNode::retrieveEntry(size_t num) const {
     if (num >= priv->length) {
         return QoreValue();
     }
-    return priv->entry[num];
+    return priv->entry(num);
 }
 
 QoreValue QoreListNode::retrieveEntry(size_t num) {
     if (num >= priv->length) {
         return QoreValue();
     }
-    return priv->entry[num];
+    return priv->entry(num);
 }
 
 QoreValue QoreListNode::getReferencedEntry(size_t num) const {
     if (num >= priv->length) {
         return QoreValue();
     }
-    return priv->entry[num].refSelf();
+    return priv->entry(num).refSelf();
 }
 
 int QoreListNode::getEntryAsInt(size_t num) const {
     if (num >= priv->length) {
         return 0;
     }
-    return (int)priv->entry[num].getAsBigInt();
+    return (int)priv->entry(num).getAsBigInt();
 }
 
 int QoreListNode::merge(const QoreListNode* list, ExceptionSink* xsink) {
@@ -337,11 +372,12 @@ int QoreListNode::setEntry(size_t index, QoreValue val, ExceptionSink* xsink) {
     if (index >= priv->length) {
         priv->resize(index + 1);
     }
-    if (needs_scan(priv->entry[index])) {
+    QoreValue& p = priv->entryRef(index);
+    if (needs_scan(p)) {
         priv->incScanCount(-1);
     }
-    priv->entry[index].discard(xsink);
-    priv->entry[index] = val;
+    p.discard(xsink);
+    p = val;
 
     if (needs_scan(val)) {
         priv->incScanCount(1);
@@ -360,11 +396,12 @@ int QoreListNode::insert(QoreValue val, ExceptionSink* xsink) {
         return -1;
     }
 
+    priv->makeUnique();
     priv->resize(priv->length + 1);
     if (priv->length - 1) {
-        memmove(priv->entry + 1, priv->entry, sizeof(QoreValue) * (priv->length - 1));
+        priv->moveEntries(1, 0, priv->length - 1);
     }
-    priv->entry[0] = holder.release();
+    priv->slot(0) = holder.release();
     if (needs_scan(val)) {
         priv->incScanCount(1);
     }
@@ -376,10 +413,11 @@ QoreValue QoreListNode::shift() {
     if (!priv->length) {
         return QoreValue();
     }
-    QoreValue rv = priv->entry[0];
+    priv->makeUnique();
+    QoreValue rv = priv->slot(0);
     size_t pos = priv->length - 1;
-    memmove(priv->entry, priv->entry + 1, sizeof(QoreValue) * pos);
-    priv->entry[pos] = QoreValue();
+    priv->moveEntries(0, 1, pos);
+    priv->slot(pos) = QoreValue();
     priv->resize(pos);
 
     if (needs_scan(rv)) {
@@ -394,9 +432,10 @@ QoreValue QoreListNode::pop() {
     if (!priv->length) {
         return QoreValue();
     }
-    QoreValue rv = priv->entry[priv->length - 1];
     size_t pos = priv->length - 1;
-    priv->entry[pos] = QoreValue();
+    QoreValue& p = priv->entryRef(pos);
+    QoreValue rv = p;
+    p = QoreValue();
     priv->resize(pos);
 
     if (needs_scan(rv)) {
@@ -439,7 +478,7 @@ QoreListNode* QoreListNode::copy() const {
 QoreListNode* QoreListNode::copyListFrom(size_t index) const {
     QoreListNode* nl = priv->getCopy();
     for (size_t i = index; i < priv->length; ++i) {
-        nl->priv->pushIntern(priv->entry[i].refSelf());
+        nl->priv->pushIntern(priv->entry(i).refSelf());
     }
 
     return nl;
@@ -501,7 +540,7 @@ QoreListNode* QoreListNode::extract(ptrdiff_t offset, ptrdiff_t len, const QoreV
 QoreListNode* QoreListNode::sort(ExceptionSink* xsink) const {
     ReferenceHolder<QoreListNode> rv(copy(), xsink);
     if (priv->length) {
-        if (rv->priv->qsort(0, 0, priv->length - 1, true, xsink)) {
+        if (rv->priv->sort(nullptr, true, false, xsink)) {
             return nullptr;
         }
     }
@@ -512,7 +551,7 @@ QoreListNode* QoreListNode::sort(ExceptionSink* xsink) const {
 QoreListNode* QoreListNode::sortDescending(ExceptionSink* xsink) const {
     ReferenceHolder<QoreListNode> rv(copy(), xsink);
     if (priv->length) {
-        if (rv->priv->qsort(0, 0, priv->length - 1, false, xsink)) {
+        if (rv->priv->sort(nullptr, false, false, xsink)) {
             return nullptr;
         }
     }
@@ -523,7 +562,7 @@ QoreListNode* QoreListNode::sortDescending(ExceptionSink* xsink) const {
 QoreListNode* QoreListNode::sortDescending(const ResolvedCallReferenceNode* fr, ExceptionSink* xsink) const {
     ReferenceHolder<QoreListNode> rv(copy(), xsink);
     if (priv->length) {
-        if (rv->priv->qsort(fr, 0, priv->length - 1, false, xsink)) {
+        if (rv->priv->sort(fr, false, false, xsink)) {
             return nullptr;
         }
     }
@@ -535,7 +574,7 @@ QoreListNode* qore_list_private::eval(ExceptionSink* xsink) {
     ReferenceHolder<QoreListNode> nl(getCopy(), xsink);
     //printd(5, "qore_list_private::eval() '%s' -> '%s'\n", QoreTypeInfo::getName(complexTypeInfo), get_full_type_name(*nl));
     for (size_t i = 0; i < length; ++i) {
-        ValueEvalRefHolder v(entry[i], xsink);
+        ValueEvalRefHolder v(entry(i), xsink);
         if (*xsink) {
             return nullptr;
         }
@@ -546,170 +585,486 @@ QoreListNode* qore_list_private::eval(ExceptionSink* xsink) {
     return nl.release();
 }
 
-// mergesort for controlled and interruptible sorts (stable)
-int qore_list_private::mergesort(const ResolvedCallReferenceNode* fr, bool ascending, ExceptionSink* xsink) {
-    //printd(5, "List::mergesort() ENTER this: %p, pgm: %p, f: %p length: %d\n", this, pgm, f, length);
+// list sorting
+/* the sort algorithms only ever permute the entries of the list, so if a comparison raises an exception, the sort is
+   aborted and the list still contains every entry exactly once
 
-    if (length <= 1) {
-        return 0;
+   the "less" function objects used by the algorithms return true if the first argument sorts before the second; their
+   failed() method returns true if a comparison raised an exception
+*/
+
+// insertion sort threshold for the unstable sort and initial run size for the stable sort
+#define QORE_SORT_INSERTION 24
+
+// compares values with the logical comparison operator
+class QoreSortCompareGeneric {
+public:
+    DLLLOCAL QoreSortCompareGeneric(ExceptionSink* xsink) : xsink(xsink) {
     }
 
-    // separate list into two equal-sized lists
-    ReferenceHolder<QoreListNode> left(new QoreListNode, xsink);
-    ReferenceHolder<QoreListNode> right(new QoreListNode, xsink);
-    qore_list_private* l = left->priv;
-    qore_list_private* r = right->priv;
-    size_t mid = length / 2;
-    {
-        size_t i = 0;
-        for (; i < mid; ++i) {
-            l->pushIntern(entry[i]);
-        }
-        for (; i < length; ++i) {
-            r->pushIntern(entry[i]);
+    DLLLOCAL int operator()(const QoreValue& l, const QoreValue& r) {
+        return QoreLogicalComparisonOperatorNode::doComparison(l, r, xsink);
+    }
+
+    DLLLOCAL bool failed() const {
+        return (bool)*xsink;
+    }
+
+private:
+    ExceptionSink* xsink;
+};
+
+// compares values with a user-supplied callback
+class QoreSortCompareCallback {
+public:
+    DLLLOCAL QoreSortCompareCallback(const ResolvedCallReferenceNode* fr, ExceptionSink* xsink) : fr(fr), xsink(xsink) {
+    }
+
+    DLLLOCAL int operator()(const QoreValue& l, const QoreValue& r) {
+        safe_qorelist_t args(do_args(l, r), xsink);
+        ValueHolder result(fr->execValue(*args, xsink), xsink);
+        if (*xsink) {
+            return 0;
         }
+        return (int)result->getAsBigInt();
     }
 
-    // set length to 0 - the temporary lists own the entry references now
-    length = 0;
+    DLLLOCAL bool failed() const {
+        return (bool)*xsink;
+    }
 
-    // mergesort the two lists
-    if (l->mergesort(fr, ascending, xsink) || r->mergesort(fr, ascending, xsink)) {
-        return -1;
+private:
+    const ResolvedCallReferenceNode* fr;
+    ExceptionSink* xsink;
+};
+
+// compares lists containing only integers
+class QoreSortCompareInt {
+public:
+    DLLLOCAL int operator()(const QoreValue& l, const QoreValue& r) const {
+        return l.v.i < r.v.i ? -1 : (l.v.i == r.v.i ? 0 : 1);
+    }
+
+    DLLLOCAL bool failed() const {
+        return false;
+    }
+};
+
+// compares lists containing only floating-point values, none of which are NaN
+/* the values are compared with single precision to give the same results as the logical comparison operator
+*/
+class QoreSortCompareFloat {
+public:
+    DLLLOCAL int operator()(const QoreValue& l, const QoreValue& r) const {
+        float lf = (float)l.v.f;
+        float rf = (float)r.v.f;
+        return lf < rf ? -1 : (lf == rf ? 0 : 1);
+    }
+
+    DLLLOCAL bool failed() const {
+        return false;
+    }
+};
+
+// compares lists containing only strings with the same encoding
+class QoreSortCompareString {
+public:
+    DLLLOCAL int operator()(const QoreValue& l, const QoreValue& r) const {
+        return l.get<const QoreStringNode>()->compare(r.get<const QoreStringNode>());
+    }
+
+    DLLLOCAL bool failed() const {
+        return false;
+    }
+};
+
+template <typename C>
+class QoreSortLess {
+public:
+    DLLLOCAL QoreSortLess(C& cmp, bool ascending) : cmp(cmp), ascending(ascending) {
+    }
+
+    DLLLOCAL bool operator()(const QoreValue& l, const QoreValue& r) {
+        int rc = cmp(l, r);
+        return ascending ? rc < 0 : rc > 0;
     }
 
-    // merge the resulting lists
-    // use offsets and getAndClear() to avoid moving a lot of memory around
-    size_t li = 0, ri = 0;
-    while ((li < l->length) && (ri < r->length)) {
-        QoreValue lv = l->entry[li];
-        QoreValue rv = r->entry[ri];
-        int rc;
-        if (fr) {
-            safe_qorelist_t args(do_args(lv, rv), xsink);
-            ValueHolder result(fr->execValue(*args, xsink), xsink);
-            if (*xsink) {
+    DLLLOCAL bool failed() const {
+        return cmp.failed();
+    }
+
+private:
+    C& cmp;
+    bool ascending;
+};
+
+// stable insertion sort
+template <typename L>
+static int qore_insertion_sort(QoreValue* b, size_t n, L& less) {
+    for (size_t i = 1; i < n; ++i) {
+        QoreValue tmp = b[i];
+        size_t j = i;
+        while (j) {
+            bool lt = less(tmp, b[j - 1]);
+            if (less.failed()) {
+                b[j] = tmp;
                 return -1;
             }
-            rc = (int)result->getAsBigInt();
+            if (!lt) {
+                break;
+            }
+            b[j] = b[j - 1];
+            --j;
         }
-        else {
-            rc = QoreLogicalComparisonOperatorNode::doComparison(lv, rv, xsink);
-            if (*xsink) {
+        b[j] = tmp;
+    }
+    return 0;
+}
+
+// insertion sort that gives up after a limited number of moves; returns 1 if the range was sorted, 0 if the move
+// limit was exceeded, and -1 if an exception was raised
+template <typename L>
+static int qore_partial_insertion_sort(QoreValue* b, size_t n, L& less) {
+    size_t moves = 0;
+    for (size_t i = 1; i < n; ++i) {
+        QoreValue tmp = b[i];
+        size_t j = i;
+        while (j) {
+            bool lt = less(tmp, b[j - 1]);
+            if (less.failed()) {
+                b[j] = tmp;
                 return -1;
             }
+            if (!lt) {
+                break;
+            }
+            b[j] = b[j - 1];
+            --j;
         }
-        if ((ascending && rc <= 0)
-            || (!ascending && rc >= 0)) {
-            pushIntern(l->getAndClear(li++));
+        b[j] = tmp;
+        moves += i - j;
+        if (moves > 8) {
+            return 0;
         }
-        else {
-            pushIntern(r->getAndClear(ri++));
+    }
+    return 1;
+}
+
+template <typename L>
+static int qore_sift_down(QoreValue* b, size_t root, size_t n, L& less) {
+    while (true) {
+        size_t child = root * 2 + 1;
+        if (child >= n) {
+            return 0;
+        }
+        if (child + 1 < n) {
+            bool lt = less(b[child], b[child + 1]);
+            if (less.failed()) {
+                return -1;
+            }
+            if (lt) {
+                ++child;
+            }
         }
+        bool lt = less(b[root], b[child]);
+        if (less.failed()) {
+            return -1;
+        }
+        if (!lt) {
+            return 0;
+        }
+        std::swap(b[root], b[child]);
+        root = child;
     }
+}
 
-    // only one list will have entries left...
-    while (li < l->length) {
-        pushIntern(l->getAndClear(li++));
+// heapsort; used when quicksort partitioning degenerates
+template <typename L>
+static int qore_heap_sort(QoreValue* b, size_t n, L& less) {
+    for (size_t i = n / 2; i > 0; --i) {
+        if (qore_sift_down(b, i - 1, n, less)) {
+            return -1;
+        }
     }
-    while (ri < r->length) {
-        pushIntern(r->getAndClear(ri++));
+    for (size_t i = n - 1; i > 0; --i) {
+        std::swap(b[0], b[i]);
+        if (qore_sift_down(b, 0, i, less)) {
+            return -1;
+        }
     }
-
-    //printd(5, "List::mergesort() EXIT this: %p, length: %d\n", this, length);
-
     return 0;
 }
 
-// quicksort for controlled and interruptible sorts (unstable)
-// I am so smart that I did not comment this code
-// and now I don't know how it works anymore
-int qore_list_private::qsort(const ResolvedCallReferenceNode* fr, size_t left, size_t right, bool ascending, ExceptionSink* xsink) {
-    size_t l_hold = left;
-    size_t r_hold = right;
-    QoreValue pivot = entry[left];
+// sorts the three given entries
+template <typename L>
+static int qore_sort3(QoreValue* b, size_t x, size_t y, size_t z, L& less) {
+    if (less(b[y], b[x])) {
+        std::swap(b[x], b[y]);
+    }
+    if (less.failed()) {
+        return -1;
+    }
+    if (less(b[z], b[y])) {
+        std::swap(b[y], b[z]);
+        if (less.failed()) {
+            return -1;
+        }
+        if (less(b[y], b[x])) {
+            std::swap(b[x], b[y]);
+        }
+    }
+    return less.failed() ? -1 : 0;
+}
 
-    while (left < right) {
+// unstable introspective sort: quicksort with median-of-three pivots (pseudo-median of nine for large ranges),
+// insertion sort for small ranges, a heapsort fallback when the recursion depth limit is reached, and detection of
+// already-partitioned ranges to handle sorted and nearly-sorted input in linear time
+/* all loops are bounds-checked, so inconsistent comparison results (ex: from a callback) cannot cause out-of-range
+   accesses
+*/
+template <typename L>
+static int qore_intro_sort(QoreValue* b, size_t n, L& less, unsigned depth) {
+    while (n > QORE_SORT_INSERTION) {
+        if (!depth) {
+            return qore_heap_sort(b, n, less);
+        }
+        --depth;
+
+        // move the pivot to the first position
+        size_t mid = n / 2;
+        if (n > 128) {
+            size_t s = n / 8;
+            if (qore_sort3(b, 0, s, s * 2, less)
+                || qore_sort3(b, mid - s, mid, mid + s, less)
+                || qore_sort3(b, n - 1 - s * 2, n - 1 - s, n - 1, less)
+                || qore_sort3(b, s, mid, n - 1 - s, less)) {
+                return -1;
+            }
+        }
+        else if (qore_sort3(b, 0, mid, n - 1, less)) {
+            return -1;
+        }
+        std::swap(b[0], b[mid]);
+
+        // partition around the pivot; entries equal to the pivot stop both scans so that ranges with many equal
+        // entries are split evenly
+        QoreValue pivot = b[0];
+        size_t i = 0, j = n;
+        bool swapped = false;
         while (true) {
-            int rc;
-            if (fr) {
-                safe_qorelist_t args(do_args(entry[right], pivot), xsink);
-                ValueHolder rv(fr->execValue(*args, xsink), xsink);
-                if (*xsink) {
+            while (++i < n) {
+                bool lt = less(b[i], pivot);
+                if (less.failed()) {
                     return -1;
                 }
-                rc = (int)rv->getAsBigInt();
+                if (!lt) {
+                    break;
+                }
             }
-            else {
-                rc = QoreLogicalComparisonOperatorNode::doComparison(entry[right], pivot, xsink);
-                if (*xsink) {
+            while (--j > 0) {
+                bool lt = less(pivot, b[j]);
+                if (less.failed()) {
                     return -1;
                 }
+                if (!lt) {
+                    break;
+                }
             }
-            if ((left < right)
-                && ((rc >= 0 && ascending)
-                    || (rc < 0 && !ascending))) {
-                --right;
-            }
-            else {
+            if (i >= j) {
                 break;
             }
+            std::swap(b[i], b[j]);
+            swapped = true;
         }
+        std::swap(b[0], b[j]);
 
-        if (left != right) {
-            entry[left] = entry[right];
-            ++left;
+        // if no entries were swapped, the range may already be sorted
+        if (!swapped) {
+            int lrc = qore_partial_insertion_sort(b, j, less);
+            if (lrc < 0) {
+                return -1;
+            }
+            int rrc = qore_partial_insertion_sort(b + j + 1, n - j - 1, less);
+            if (rrc < 0) {
+                return -1;
+            }
+            if (lrc && rrc) {
+                return 0;
+            }
         }
 
-        while (true) {
-            int rc;
-            if (fr) {
-                safe_qorelist_t args(do_args(entry[left], pivot), xsink);
-                ValueHolder rv(fr->execValue(*args, xsink), xsink);
-                if (*xsink) {
-                    return -1;
-                }
-                rc = (int)rv->getAsBigInt();
+        // recurse into the smaller partition and iterate on the larger one
+        if (j < n - j - 1) {
+            if (qore_intro_sort(b, j, less, depth)) {
+                return -1;
             }
-            else {
-                rc = QoreLogicalComparisonOperatorNode::doComparison(entry[left], pivot, xsink);
-                if (*xsink) {
-                    return -1;
-                }
+            b += j + 1;
+            n -= j + 1;
+        }
+        else {
+            if (qore_intro_sort(b + j + 1, n - j - 1, less, depth)) {
+                return -1;
             }
-            if ((left < right)
-                && ((rc <= 0 && ascending)
-                    || (rc > 0 && !ascending))) {
-                ++left;
+            n = j;
+        }
+    }
+
+    return qore_insertion_sort(b, n, less);
+}
+
+// merges the adjacent sorted ranges [b, b + mid) and [b + mid, b + n) using "buf" for the left range
+template <typename L>
+static int qore_merge(QoreValue* b, size_t mid, size_t n, QoreValue* buf, L& less) {
+    // skip the merge if the ranges are already in order
+    bool lt = less(b[mid], b[mid - 1]);
+    if (less.failed()) {
+        return -1;
+    }
+    if (!lt) {
+        return 0;
+    }
+
+    memcpy((void*)buf, (void*)b, mid * sizeof(QoreValue));
+    size_t i = 0, j = mid, k = 0;
+    int rc = 0;
+    while (i < mid && j < n) {
+        lt = less(b[j], buf[i]);
+        if (less.failed()) {
+            rc = -1;
+            break;
+        }
+        // take from the left range on ties to keep the sort stable
+        if (lt) {
+            b[k++] = b[j++];
+        }
+        else {
+            b[k++] = buf[i++];
+        }
+    }
+    // copy back any remaining entries from the left range; the gap left in the list is always the same size
+    memcpy((void*)(b + k), (void*)(buf + i), (mid - i) * sizeof(QoreValue));
+    return rc;
+}
+
+// stable bottom-up merge sort with a single temporary buffer; initial runs are sorted with insertion sort, and
+// adjacent runs that are already in order are not merged
+template <typename L>
+static int qore_merge_sort(QoreValue* b, size_t n, L& less) {
+    for (size_t i = 0; i < n; i += QORE_SORT_INSERTION) {
+        if (qore_insertion_sort(b + i, QORE_MIN(QORE_SORT_INSERTION, n - i), less)) {
+            return -1;
+        }
+    }
+    if (n <= QORE_SORT_INSERTION) {
+        return 0;
+    }
+
+    // the buffer holds the left run of a merge, which is at most the widest run width
+    size_t max_width = QORE_SORT_INSERTION;
+    while (max_width * 2 < n) {
+        max_width *= 2;
+    }
+    std::vector<QoreValue> buf(max_width);
+    for (size_t width = QORE_SORT_INSERTION; width < n; width *= 2) {
+        for (size_t lo = 0; lo + width < n; lo += width * 2) {
+            if (qore_merge(b + lo, width, QORE_MIN(width * 2, n - lo), &buf[0], less)) {
+                return -1;
             }
-            else {
-                break;
+        }
+    }
+    return 0;
+}
+
+template <typename C>
+static int qore_sort_intern(QoreValue* b, size_t n, C& cmp, bool ascending, bool stable) {
+    QoreSortLess<C> less(cmp, ascending);
+    if (stable) {
+        return qore_merge_sort(b, n, less);
+    }
+
+    unsigned depth = 0;
+    for (size_t i = n; i > 1; i >>= 1) {
+        depth += 2;
+    }
+    return qore_intro_sort(b, n, less, depth);
+}
+
+static int qore_sort_list(QoreValue* entry, size_t length, const ResolvedCallReferenceNode* fr, bool ascending,
+        bool stable, ExceptionSink* xsink) {
+    if (fr) {
+        QoreSortCompareCallback cmp(fr, xsink);
+        return qore_sort_intern(entry, length, cmp, ascending, stable);
+    }
+
+    // check for lists with homogeneous types that can be compared directly
+    qore_type_t t = entry[0].getType();
+    const QoreEncoding* enc = t == NT_STRING ? entry[0].get<const QoreStringNode>()->getEncoding() : nullptr;
+    bool homogeneous = t == NT_INT || t == NT_FLOAT || t == NT_STRING;
+    for (size_t i = 0; homogeneous && i < length; ++i) {
+        if (entry[i].getType() != t) {
+            homogeneous = false;
+        }
+        else if (t == NT_FLOAT) {
+            // NaN values raise an exception in the logical comparison operator
+            if (std::isnan(entry[i].v.f)) {
+                homogeneous = false;
             }
         }
+        else if (t == NT_STRING && entry[i].get<const QoreStringNode>()->getEncoding() != enc) {
+            homogeneous = false;
+        }
+    }
 
-        if (left != right) {
-            entry[right] = entry[left];
-            --right;
+    if (homogeneous) {
+        switch (t) {
+            case NT_INT: {
+                QoreSortCompareInt cmp;
+                return qore_sort_intern(entry, length, cmp, ascending, stable);
+            }
+            case NT_FLOAT: {
+                QoreSortCompareFloat cmp;
+                return qore_sort_intern(entry, length, cmp, ascending, stable);
+            }
+            default: {
+                assert(t == NT_STRING);
+                QoreSortCompareString cmp;
+                return qore_sort_intern(entry, length, cmp, ascending, stable);
+            }
         }
     }
-    entry[left] = pivot;
-    size_t t_left = left;
-    left = l_hold;
-    right = r_hold;
-    int rc = 0;
-    if (left < t_left) {
-        rc = qsort(fr, left, t_left - 1, ascending, xsink);
+
+    QoreSortCompareGeneric cmp(xsink);
+    return qore_sort_intern(entry, length, cmp, ascending, stable);
+}
+
+int qore_list_private::sort(const ResolvedCallReferenceNode* fr, bool ascending, bool stable, ExceptionSink* xsink) {
+    if (length <= 1) {
+        return 0;
     }
-    if (!rc && right > t_left) {
-        rc = qsort(fr, t_left + 1, right, ascending, xsink);
+
+    QoreValue* b = getFlatEntries();
+    if (b) {
+        return qore_sort_list(b, length, fr, ascending, stable, xsink);
     }
+
+    // lists stored in more than one chunk are sorted in a temporary contiguous buffer; the entries are always copied
+    // back, because an aborted sort leaves every entry in the buffer exactly once
+    b = (QoreValue*)malloc(sizeof(QoreValue) * length);
+    for (size_t i = 0; i < length; ++i) {
+        b[i] = slot(i);
+    }
+    int rc = qore_sort_list(b, length, fr, ascending, stable, xsink);
+    for (size_t i = 0; i < length; ++i) {
+        slot(i) = b[i];
+    }
+    free(b);
     return rc;
 }
 
 QoreListNode* QoreListNode::sort(const ResolvedCallReferenceNode* fr, ExceptionSink* xsink) const {
     ReferenceHolder<QoreListNode> rv(copy(), xsink);
     if (priv->length) {
-        if (rv->priv->qsort(fr, 0, priv->length - 1, true, xsink)) {
+        if (rv->priv->sort(fr, true, false, xsink)) {
             return nullptr;
         }
     }
@@ -720,7 +1075,7 @@ QoreListNode* QoreListNode::sort(const ResolvedCallReferenceNode* fr, ExceptionS
 QoreListNode* QoreListNode::sortStable(ExceptionSink* xsink) const {
     ReferenceHolder<QoreListNode> rv(copy(), xsink);
     if (priv->length) {
-        if (rv->priv->mergesort(0, true, xsink)) {
+        if (rv->priv->sort(nullptr, true, true, xsink)) {
             return nullptr;
         }
     }
@@ -731,7 +1086,7 @@ QoreListNode* QoreListNode::sortStable(ExceptionSink* xsink) const {
 QoreListNode* QoreListNode::sortDescendingStable(ExceptionSink* xsink) const {
     ReferenceHolder<QoreListNode> rv(copy(), xsink);
     if (priv->length) {
-        if (rv->priv->mergesort(0, false, xsink)) {
+        if (rv->priv->sort(nullptr, false, true, xsink)) {
             return nullptr;
         }
     }
@@ -742,7 +1097,7 @@ QoreListNode* QoreListNode::sortDescendingStable(ExceptionSink* xsink) const {
 QoreListNode* QoreListNode::sortDescendingStable(const ResolvedCallReferenceNode* fr, ExceptionSink* xsink) const {
     ReferenceHolder<QoreListNode> rv(copy(), xsink);
     if (priv->length) {
-        if (rv->priv->mergesort(fr, false, xsink)) {
+        if (rv->priv->sort(fr, false, true, xsink)) {
             return nullptr;
         }
     }
@@ -753,7 +1108,7 @@ QoreListNode* QoreListNode::sortDescendingStable(const ResolvedCallReferenceNode
 QoreListNode* QoreListNode::sortStable(const ResolvedCallReferenceNode* fr, ExceptionSink* xsink) const {
     ReferenceHolder<QoreListNode> rv(copy(), xsink);
     if (priv->length) {
-        if (rv->priv->mergesort(fr, true, xsink)) {
+        if (rv->priv->sort(fr, true, true, xsink)) {
             return nullptr;
         }
     }
@@ -763,9 +1118,7 @@ QoreListNode* QoreListNode::sortStable(const ResolvedCallReferenceNode* fr, Exce
 
 // does a deep dereference
 bool QoreListNode::derefImpl(ExceptionSink* xsink) {
-    for (size_t i = 0; i < priv->length; i++) {
-        priv->entry[i].discard(xsink);
-    }
+    priv->releaseEntries(xsink);
 #ifdef DEBUG
     priv->length = 0;
 #endif
@@ -784,10 +1137,10 @@ QoreValue QoreListNode::min(ExceptionSink* xsink) const {
     if (!priv->length) {
         return QoreValue();
     }
-    QoreValue rv = priv->entry[0];
+    QoreValue rv = priv->entry(0);
 
     for (size_t i = 1; i < priv->length; ++i) {
-        QoreValue v = priv->entry[i];
+        QoreValue v = priv->entry(i);
         if (QoreLogicalLessThanOperatorNode::doLessThan(v, rv, xsink)) {
             rv = v;
         }
@@ -802,10 +1155,10 @@ QoreValue QoreListNode::max(ExceptionSink* xsink) const {
     if (!priv->length) {
         return QoreValue();
     }
-    QoreValue rv = priv->entry[0];
+    QoreValue rv = priv->entry(0);
 
     for (size_t i = 0; i < priv->length; ++i) {
-        QoreValue v = priv->entry[i];
+        QoreValue v = priv->entry(i);
 
         if (QoreLogicalGreaterThanOperatorNode::doGreaterThan(v, rv, xsink)) {
             rv = v;
@@ -821,10 +1174,10 @@ QoreValue QoreListNode::min(const ResolvedCallReferenceNode* fr, ExceptionSink*
     if (!priv->length) {
         return QoreValue();
     }
-    QoreValue rv = priv->entry[0];
+    QoreValue rv = priv->entry(0);
 
     for (size_t i = 1; i < priv->length; ++i) {
-        QoreValue v = priv->entry[i];
+        QoreValue v = priv->entry(i);
 
         safe_qorelist_t args(do_args(v, rv), xsink);
         ValueHolder result(fr->execValue(*args, xsink), xsink);
@@ -842,10 +1195,10 @@ QoreValue QoreListNode::max(const ResolvedCallReferenceNode* fr, ExceptionSink*
     if (!priv->length) {
         return QoreValue();
     }
-    QoreValue rv = priv->entry[0];
+    QoreValue rv = priv->entry(0);
 
     for (size_t i = 1; i < priv->length; ++i) {
-        QoreValue v = priv->entry[i];
+        QoreValue v = priv->entry(i);
 
         safe_qorelist_t args(do_args(v, rv), xsink);
         ValueHolder result(fr->execValue(*args, xsink), xsink);
@@ -863,7 +1216,7 @@ QoreListNode* QoreListNode::reverse() const {
     QoreListNode* l = priv->getCopy();
     l->priv->resize(priv->length);
     for (size_t i = 0; i < priv->length; ++i) {
-        l->priv->entry[i] = priv->entry[priv->length - i - 1].refSelf();
+        l->priv->slot(i) = priv->entry(priv->length - i - 1).refSelf();
     }
     return l;
 }
@@ -905,7 +1258,7 @@ int QoreListNode::getAsString(QoreString &str, int foff, ExceptionSink* xsink) c
             str.sprintf("[%d]=", i);
         }
 
-        QoreValue n = priv->entry[i];
+        QoreValue n = priv->entry(i);
         if (n.getAsString(str, foff != FMT_NONE ? foff + 2 : foff, xsink)) {
             return -1;
         }
@@ -0,0 +1,77 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreMemoryMap.cpp
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#include <qore/Qore.h>
+#include "qore/intern/QoreMemoryMap.h"
+
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+QoreMemoryMap* QoreMemoryMap::create(int fd, const char* path, ExceptionSink* xsink) {
+#ifdef HAVE_SYS_MMAN_H
+    struct stat sbuf;
+    if (fstat(fd, &sbuf)) {
+        xsink->raiseErrnoException("FILE-MAP-ERROR", errno, "cannot map '%s'", path);
+        return nullptr;
+    }
+
+    if (!S_ISREG(sbuf.st_mode)) {
+        xsink->raiseException("FILE-MAP-ERROR", "cannot map '%s': only regular files can be mapped", path);
+        return nullptr;
+    }
+
+    // empty files cannot be mapped, but empty views can be created
+    if (!sbuf.st_size)
+        return new QoreMemoryMap(nullptr, 0);
+
+    void* addr = mmap(nullptr, sbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        xsink->raiseErrnoException("FILE-MAP-ERROR", errno, "cannot map '%s'", path);
+        return nullptr;
+    }
+
+    return new QoreMemoryMap(addr, sbuf.st_size);
+#else
+    xsink->raiseException("FILE-MAP-ERROR", "cannot map '%s': memory-mapped files are not supported on this platform", path);
+    return nullptr;
+#endif
+}
+
+QoreMemoryMap::~QoreMemoryMap() {
+#ifdef HAVE_SYS_MMAN_H
+    if (addr)
+        munmap(addr, len);
+#endif
+}
@@ -44,6 +44,8 @@
 
 // include files for default object classes
 #include "qore/intern/QC_Socket.h"
+#include "qore/intern/QC_SocketPoller.h"
+#include "qore/intern/QC_CsvTokenizer.h"
 #include "qore/intern/QC_SSLCertificate.h"
 #include "qore/intern/QC_SSLPrivateKey.h"
 #include "qore/intern/QC_ProgramControl.h"
@@ -62,6 +64,7 @@
 #include "qore/intern/QC_Datasource.h"
 #include "qore/intern/QC_DatasourcePool.h"
 #include "qore/intern/QC_SQLStatement.h"
+#include "qore/intern/QC_SQLColumnBlock.h"
 
 // functions
 #include "qore/intern/ql_time.h"
@@ -177,7 +180,12 @@ const TypedHashDecl* hashdeclStatInfo,
       * hashdeclCallStackInfo,
       * hashdeclExceptionInfo,
       * hashdeclStatementInfo,
-      * hashdeclNetIfInfo;
+      * hashdeclNetIfInfo,
+      * hashdeclRegexCacheInfo,
+      * hashdeclThreadListInfo,
+      * hashdeclVariantCacheInfo,
+      * hashdeclMemorySizeClassInfo,
+      * hashdeclMemoryStats;
 
 DLLLOCAL void init_context_functions(QoreNamespace& ns);
 DLLLOCAL void init_RangeIterator_functions(QoreNamespace& ns);
@@ -879,6 +887,11 @@ StaticSystemNamespace::StaticSystemNamespace() : RootQoreNamespace(new qore_root
    hashdeclExceptionInfo = init_hashdecl_ExceptionInfo(qns);
    hashdeclStatementInfo = init_hashdecl_StatementInfo(qns);
    hashdeclNetIfInfo = init_hashdecl_NetIfInfo(qns);
+   hashdeclRegexCacheInfo = init_hashdecl_RegexCacheInfo(qns);
+   hashdeclThreadListInfo = init_hashdecl_ThreadListInfo(qns);
+   hashdeclVariantCacheInfo = init_hashdecl_VariantCacheInfo(qns);
+   hashdeclMemorySizeClassInfo = init_hashdecl_MemorySizeClassInfo(qns);
+   hashdeclMemoryStats = init_hashdecl_MemoryStats(qns);
 
    qore_ns_private::addNamespace(qns, get_thread_ns(qns));
 
@@ -911,6 +924,7 @@ StaticSystemNamespace::StaticSystemNamespace() : RootQoreNamespace(new qore_root
    qns.addSystemClass(initSSLCertificateClass(qns));
    qns.addSystemClass(initSSLPrivateKeyClass(qns));
    qns.addSystemClass(initSocketClass(qns));
+   qns.addSystemClass(initSocketPollerClass(qns));
    preinitBreakpointClass();  // to resolve circular dependency Program/Breakpoint class
    qns.addSystemClass(initProgramControlClass(qns));
    qns.addSystemClass(initProgramClass(qns));
@@ -953,6 +967,7 @@ StaticSystemNamespace::StaticSystemNamespace() : RootQoreNamespace(new qore_root
    qns.addSystemClass(initFileLineIteratorClass(qns));
    qns.addSystemClass(initDataLineIteratorClass(qns));
    qns.addSystemClass(initInputStreamLineIteratorClass(qns));
+   qns.addSystemClass(initCsvTokenizerClass(qns));
    qns.addSystemClass(initSingleValueIteratorClass(qns));
    qns.addSystemClass(initRangeIteratorClass(qns));
    qns.addSystemClass(initTreeMapClass(qns));
@@ -994,6 +1009,7 @@ StaticSystemNamespace::StaticSystemNamespace() : RootQoreNamespace(new qore_root
    sqlns->addSystemClass(initAbstractDatasourceClass(*sqlns));
    sqlns->addSystemClass(initDatasourceClass(*sqlns));
    sqlns->addSystemClass(initDatasourcePoolClass(*sqlns));
+   sqlns->addSystemClass(initSQLColumnBlockClass(*sqlns));
    sqlns->addSystemClass(initSQLStatementClass(*sqlns));
 
    init_dbi_functions(*sqlns);
@@ -31,6 +31,7 @@
 
 #include <qore/Qore.h>
 #include "qore/intern/qore_number_private.h"
+#include "qore/intern/QoreSlabAllocator.h"
 
 void qore_number_private::getAsString(QoreString& str, bool round, int base) const {
    // first check for zero
@@ -399,6 +400,14 @@ QoreNumberNode::~QoreNumberNode() {
    delete priv;
 }
 
+void* QoreNumberNode::operator new(size_t size) {
+   return q_slab_alloc(size);
+}
+
+void QoreNumberNode::operator delete(void* p, size_t size) {
+   q_slab_free(p, size);
+}
+
 // get the value of the type in a string context (default implementation = del = false and returns NullString)
 // if del is true, then the returned QoreString * should be deleted, if false, then it must not be
 // use the QoreStringValueHelper class (defined in QoreStringNode.h) instead of using this function directly
@@ -136,6 +136,7 @@ ParseOptionMaps::ParseOptionMaps() {
     doMap(PO_BROKEN_REFERENCES, "PO_BROKEN_REFERENCES");
     doMap(PO_NO_DEBUGGING, "PO_NO_DEBUGGING");
     doMap(PO_ALLOW_DEBUGGER, "PO_ALLOW_DEBUGGER");
+    doMap(PO_COMPILE_BYTECODE, "PO_COMPILE_BYTECODE");
 }
 
 QoreHashNode* ParseOptionMaps::getCodeToStringMap() const {
@@ -911,6 +912,8 @@ void qore_program_private::del(ExceptionSink* xsink) {
 
     // delete the namespace and all data
     qore_root_ns_private::get(*RootNS)->deleteData(!ns_vars, xsink);
+    // the addresses of the Program's classes, hashdecls and types can be reused once they are freed
+    QoreVariantCache::invalidate();
     delete RootNS;
     RootNS = nullptr;
 
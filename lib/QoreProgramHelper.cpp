@@ -31,6 +31,7 @@
 */
 
 #include <qore/Qore.h>
+#include "qore/intern/ThreadPool.h"
 
 //! creates the QoreProgram object: DEPRECATED: use QoreProgramHelper(int64, ExceptionSink&) instead
 QoreProgramHelper::QoreProgramHelper(ExceptionSink& xs) : pgm(new QoreProgram), xsink(xs) {
@@ -44,6 +45,8 @@ QoreProgramHelper::QoreProgramHelper(int64 parse_options, ExceptionSink& xs) : p
 /** QoreProgram objects are deleted when there reference count reaches 0.
  */
 QoreProgramHelper::~QoreProgramHelper() {
+   // stop the shared pool used for parallel list evaluation so that its threads do not block the wait below
+   qore_stop_shared_thread_pool();
    // waits for all background threads to execute
    thread_counter.waitForZero(&xsink);
    // waits for the current Program to terminate
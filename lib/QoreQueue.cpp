@@ -44,12 +44,16 @@ void Queue::deref(ExceptionSink* xsink) {
 
 void qore_queue_private::destructor(ExceptionSink* xsink) {
    AutoLocker al(&l);
-   if (read_waiting) {
-      xsink->raiseException("QUEUE-ERROR", "Queue deleted while there %s %d waiting thread%s for reading", read_waiting == 1 ? "is" : "are", read_waiting, read_waiting == 1 ? "" : "s");
+   if (ring)
+      ringDisable();
+   unsigned rw = read_waiting;
+   if (rw) {
+      xsink->raiseException("QUEUE-ERROR", "Queue deleted while there %s %d waiting thread%s for reading", rw == 1 ? "is" : "are", rw, rw == 1 ? "" : "s");
       read_cond.broadcast();
    }
-   if (write_waiting) {
-      xsink->raiseException("QUEUE-ERROR", "Queue deleted while there %s %d waiting thread%s for writing", write_waiting == 1 ? "is" : "are", write_waiting, write_waiting == 1 ? "" : "s");
+   unsigned ww = write_waiting;
+   if (ww) {
+      xsink->raiseException("QUEUE-ERROR", "Queue deleted while there %s %d waiting thread%s for writing", ww == 1 ? "is" : "are", ww, ww == 1 ? "" : "s");
       write_cond.broadcast();
    }
 
@@ -62,6 +66,12 @@ void qore_queue_private::destructor(ExceptionSink* xsink) {
 }
 
 void qore_queue_private::clearIntern(ExceptionSink* xsink) {
+    if (ring) {
+        QoreValue v;
+        while (ring->tryShift(v))
+            v.discard(xsink);
+        return;
+    }
     while (head) {
         printd(5, "qore_queue_private::clearIntern() this: %p deleting %p (node '%s' %s)\n", this, head, head->node.getTypeName(), head->node.getType());
         QoreQueueNode* w = head->next;
@@ -203,6 +213,19 @@ int qore_queue_private::checkWriteIntern(ExceptionSink* xsink, bool always_error
 }
 
 void qore_queue_private::pushAndTakeRef(QoreValue n) {
+   if (ring) {
+      // this is called by I/O threads posting events, so it must not block; if the ring buffer is full or the queue
+      // has an error status, the value is discarded
+      if (ringTryPush(n)) {
+         ringSignal(read_waiting, read_cond);
+         return;
+      }
+      ExceptionSink xsink;
+      n.discard(&xsink);
+      xsink.clear();
+      return;
+   }
+
    AutoLocker al(&l);
    if (len == Queue_Deleted || !err.empty())
       return;
@@ -214,8 +237,99 @@ void qore_queue_private::pushAndTakeRef(QoreValue n) {
    pushIntern(n);
 }
 
+void qore_queue_private::ringPush(ExceptionSink* xsink, QoreValue n, int timeout_ms, bool& to) {
+   ValueHolder holder(n, xsink);
+
+   while (true) {
+      // lock-free fast path
+      if (ringTryPush(*holder)) {
+         holder.release();
+         ringSignal(read_waiting, read_cond);
+         return;
+      }
+
+      // the ring is full or the queue has an error status
+      AutoLocker al(&l);
+      if (checkWriteIntern(xsink))
+         return;
+
+      // register as a waiter before checking the ring again so that no wakeup can be lost
+      ++write_waiting;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (ring->tryPush(*holder)) {
+         --write_waiting;
+         holder.release();
+         if (read_waiting)
+            read_cond.signal();
+         return;
+      }
+
+      int rc = timeout_ms ? write_cond.wait(l, timeout_ms) : write_cond.wait(l);
+      --write_waiting;
+
+      if (rc) {
+         assert(timeout_ms);
+         assert(rc == ETIMEDOUT);
+         to = true;
+         return;
+      }
+
+      if (len == Queue_Deleted) {
+         xsink->raiseException("QUEUE-ERROR", "Queue has been deleted in another thread");
+         return;
+      }
+   }
+}
+
+QoreValue qore_queue_private::ringShift(ExceptionSink* xsink, int timeout_ms, bool& to) {
+   QoreValue rv;
+
+   while (true) {
+      // lock-free fast path
+      if (ring_ok.load(std::memory_order_acquire) && ring->tryShift(rv)) {
+         ringSignal(write_waiting, write_cond);
+         return rv;
+      }
+
+      // the ring is empty or the queue has an error status
+      AutoLocker al(&l);
+      if (checkWriteIntern(xsink, true))
+         return QoreValue();
+
+      // register as a waiter before checking the ring again so that no wakeup can be lost
+      ++read_waiting;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (ring->tryShift(rv)) {
+         --read_waiting;
+         if (write_waiting)
+            write_cond.signal();
+         return rv;
+      }
+
+      int rc = timeout_ms ? read_cond.wait(l, timeout_ms) : read_cond.wait(l);
+      --read_waiting;
+
+      if (rc) {
+         assert(timeout_ms);
+         assert(rc == ETIMEDOUT);
+         to = true;
+         return QoreValue();
+      }
+
+      if (len == Queue_Deleted) {
+         xsink->raiseException("QUEUE-ERROR", "Queue has been deleted in another thread");
+         return QoreValue();
+      }
+   }
+}
+
 void qore_queue_private::push(ExceptionSink* xsink, QoreValue n, int timeout_ms, bool& to) {
    to = false;
+   if (ring) {
+      ringPush(xsink, n, timeout_ms, to);
+      return;
+   }
+
    ValueHolder holder(n, xsink);
 
    AutoLocker al(&l);
@@ -236,6 +350,8 @@ void qore_queue_private::push(ExceptionSink* xsink, QoreValue n, int timeout_ms,
 void qore_queue_private::insert(ExceptionSink* xsink, QoreValue n, int timeout_ms, bool& to) {
    to = false;
    ValueHolder holder(n, xsink);
+   if (checkRingIntern(xsink, "insert"))
+      return;
 
    AutoLocker al(&l);
    if (checkWriteIntern(xsink))
@@ -254,6 +370,9 @@ void qore_queue_private::insert(ExceptionSink* xsink, QoreValue n, int timeout_m
 
 QoreValue qore_queue_private::shift(ExceptionSink* xsink, int timeout_ms, bool& to) {
    to = false;
+   if (ring)
+      return ringShift(xsink, timeout_ms, to);
+
    SafeLocker sl(&l);
 
    if (checkWriteIntern(xsink, true))
@@ -290,6 +409,9 @@ QoreValue qore_queue_private::shift(ExceptionSink* xsink, int timeout_ms, bool&
 
 QoreValue qore_queue_private::pop(ExceptionSink* xsink, int timeout_ms, bool& to) {
    to = false;
+   if (checkRingIntern(xsink, "pop"))
+      return QoreValue();
+
    SafeLocker sl(&l);
 
    if (checkWriteIntern(xsink, true))
@@ -324,6 +446,14 @@ void qore_queue_private::clear(ExceptionSink* xsink) {
    if (checkWriteIntern(xsink))
       return;
 
+   if (ring) {
+      clearIntern(xsink);
+      // more than one slot may have been freed
+      if (write_waiting)
+         write_cond.broadcast();
+      return;
+   }
+
    if (read_waiting) {
       // the queue must be empty
       assert(!head);
@@ -346,6 +476,8 @@ void qore_queue_private::setError(const char* n_err, const QoreStringNode* n_des
    if (desc)
       desc->deref();
    desc = n_desc->stringRefSelf();
+   if (ring)
+      ringDisable();
 
    // clear the queue
    clearIntern(xsink);
@@ -367,6 +499,7 @@ void qore_queue_private::clearError() {
       desc->deref();
       desc = 0;
    }
+   ring_ok.store(true, std::memory_order_release);
 }
 
 QoreQueue::QoreQueue(int n_max) : priv(new qore_queue_private(n_max)) {
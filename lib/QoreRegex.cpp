@@ -31,6 +31,7 @@
 #include "qore/intern/qore_program_private.h"
 
 #include <memory>
+#include <climits>
 
 QoreRegex::QoreRegex() {
    init();
@@ -56,8 +57,6 @@ QoreRegex::QoreRegex(const QoreString& s, int64 opts, ExceptionSink* xsink) {
 }
 
 QoreRegex::~QoreRegex() {
-   if (p)
-      pcre_free(p);
    if (str)
       delete str;
 }
@@ -81,7 +80,9 @@ void QoreRegex::parseRT(const QoreString* pattern, ExceptionSink* xsink) {
    if (err) {
       //printd(5, "QoreRegex::parse() error parsing '%s': %s", t->getBuffer(), (char* )err);
       xsink->raiseException("REGEX-COMPILATION-ERROR", (char* )err);
+      return;
    }
+   study();
 }
 
 void QoreRegex::parse() {
@@ -98,14 +99,26 @@ bool QoreRegex::exec(const QoreString* target, ExceptionSink* xsink) const {
    if (!t)
       return false;
 
-   return exec(t->getBuffer(), t->strlen());
+   return exec(t->getBuffer(), t->strlen(), xsink);
+}
+
+// PCRE takes the length of the subject as an int
+static int check_subject_size(size_t len, ExceptionSink* xsink) {
+   if (len <= INT_MAX)
+      return 0;
+   xsink->raiseException("REGEX-ERROR", "cannot match a regular expression against " QLLD " bytes of data; the "
+      "maximum size is %d bytes", (int64)len, INT_MAX);
+   return -1;
 }
 
 // default subpattern buffer size; see pcre_exec() / pcreapi for more info
 #define OVECCOUNT 30
 // maximum subpattern buffer size; we must limit this to control the amount of stack space used; must be OVECCOUNT * a power of 2
 #define OVECMAX 480
-bool QoreRegex::exec(const char* str, size_t len) const {
+bool QoreRegex::exec(const char* str, size_t len, ExceptionSink* xsink) const {
+   if (check_subject_size(len, xsink))
+      return false;
+
    // the PCRE docs say that if we don't send an ovector here the library may have to malloc
    // memory, so, even though we don't need the results, we include the vector to avoid
    // extraneous malloc()s
@@ -120,7 +133,7 @@ bool QoreRegex::exec(const char* str, size_t len) const {
       std::vector<int> ovc(vsize, 0);
       int* ovector = &ovc[0];
 #endif
-      rc = pcre_exec(p, 0, str, len, 0, 0, ovector, vsize);
+      rc = execIntern(str, len, 0, ovector, vsize);
       if (!rc) {
          // rc == 0 means not enough space was available in ovector
          printd(5, "QoreRegex::exec() ovector too small: vsize: %d -> %d (max: %d)\n", vsize, vsize << 1, OVECMAX);
@@ -143,6 +156,13 @@ QoreListNode* QoreRegex::extractSubstrings(const QoreString* target, ExceptionSi
     if (!t)
         return 0;
 
+    return extractSubstrings(t->c_str(), t->size(), xsink);
+}
+
+QoreListNode* QoreRegex::extractSubstrings(const char* str, size_t len, ExceptionSink* xsink) const {
+    if (check_subject_size(len, xsink))
+        return nullptr;
+
     ReferenceHolder<QoreListNode> l(xsink);
 
     int offset = 0;
@@ -150,7 +170,7 @@ QoreListNode* QoreRegex::extractSubstrings(const QoreString* target, ExceptionSi
     int vsize = OVECCOUNT;
 
     while (true) {
-        if (offset >= (int)t->strlen())
+        if (offset >= (int)len)
             break;
 #ifdef HAVE_LOCAL_VARIADIC_ARRAYS
         int ovector[vsize];
@@ -158,8 +178,8 @@ QoreListNode* QoreRegex::extractSubstrings(const QoreString* target, ExceptionSi
         std::vector<int> ovc(vsize, 0);
         int* ovector = &ovc[0];
 #endif
-        int rc = pcre_exec(p, 0, t->c_str(), t->size(), offset, 0, ovector, vsize);
-        //printd(5, "QoreRegex::exec(%s) =~ /xxx/ = %d (global: %d)\n", t->c_str() + offset, rc, global);
+        int rc = execIntern(str, len, offset, ovector, vsize);
+        //printd(5, "QoreRegex::exec(%s) =~ /xxx/ = %d (global: %d)\n", str + offset, rc, global);
 
         if (!rc) {
             // rc == 0 means not enough space was available in ovector
@@ -188,7 +208,7 @@ QoreListNode* QoreRegex::extractSubstrings(const QoreString* target, ExceptionSi
                     continue;
                 }
                 QoreStringNode* tstr = new QoreStringNode;
-                tstr->concat(t->getBuffer() + ovector[pos], ovector[pos + 1] - ovector[pos]);
+                tstr->concat(str + ovector[pos], ovector[pos + 1] - ovector[pos]);
                 if (!l)
                     l = new QoreListNode(stringOrNothingTypeInfo);
                 //printd(5, "substring %d: %d - %d (len %d) tstr: '%s' (%d)\n", x, ovector[pos], ovector[pos + 1], ovector[pos + 1] - ovector[pos], tstr->c_str(), (int)tstr->size());
@@ -196,7 +216,7 @@ QoreListNode* QoreRegex::extractSubstrings(const QoreString* target, ExceptionSi
             }
 
             offset = ovector[(x - 1) * 2 + 1];
-            //printd(5, "QoreRegex::exec() offset: %d size: %d ovector[%d]: %d\n", offset, t->strlen(), (x - 1) * 2 + 1, ovector[(x - 1) * 2 + 1]);
+            //printd(5, "QoreRegex::exec() offset: %d size: %d ovector[%d]: %d\n", offset, (int)len, (x - 1) * 2 + 1, ovector[(x - 1) * 2 + 1]);
         }
         else
             break;
@@ -48,3 +48,39 @@ void QoreRegexBase::setExtended() {
 void QoreRegexBase::setMultiline() {
    options |= PCRE_MULTILINE;
 }
+
+QoreRegexBase::~QoreRegexBase() {
+#ifdef PCRE_STUDY_JIT_COMPILE
+   if (extra)
+      pcre_free_study(extra);
+#else
+   if (extra)
+      pcre_free(extra);
+#endif
+   if (p)
+      pcre_free(p);
+}
+
+void QoreRegexBase::study() {
+   assert(p);
+   assert(!extra);
+   const char* err;
+#ifdef PCRE_STUDY_JIT_COMPILE
+   // if JIT compilation is not supported, PCRE falls back to the normal study data
+   extra = pcre_study(p, PCRE_STUDY_JIT_COMPILE, &err);
+#else
+   extra = pcre_study(p, 0, &err);
+#endif
+   // errors in studying are not fatal; the pattern is then executed without the study data
+   //printd(5, "QoreRegexBase::study() this: %p extra: %p err: %s\n", this, extra, err ? err : "n/a");
+}
+
+int QoreRegexBase::execIntern(const char* subject, int len, int offset, int* ovector, int ovecsize) const {
+   int rc = pcre_exec(p, extra, subject, len, offset, 0, ovector, ovecsize);
+#ifdef PCRE_ERROR_JIT_STACKLIMIT
+   // the JIT stack is limited in size; retry with the interpreter, which is only limited by the match limits
+   if (rc == PCRE_ERROR_JIT_STACKLIMIT)
+      rc = pcre_exec(p, nullptr, subject, len, offset, 0, ovector, ovecsize);
+#endif
+   return rc;
+}
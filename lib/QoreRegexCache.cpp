@@ -0,0 +1,143 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreRegexCache.cpp
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#include <qore/Qore.h>
+#include "qore/intern/QoreRegexCache.h"
+
+QoreRegexCache qore_regex_cache;
+
+std::string QoreRegexCache::getKey(char type, const QoreString& pattern, int64 options) {
+    const QoreEncoding* enc = pattern.getEncoding();
+    std::string key;
+    key.reserve(1 + sizeof(options) + sizeof(enc) + pattern.size());
+    key.push_back(type);
+    key.append(reinterpret_cast<const char*>(&options), sizeof(options));
+    key.append(reinterpret_cast<const char*>(&enc), sizeof(enc));
+    key.append(pattern.c_str(), pattern.size());
+    return key;
+}
+
+QoreRegexCache::RegexCacheEntry* QoreRegexCache::findIntern(const std::string& key) {
+    rcmap_t::iterator i = map.find(key);
+    if (i == map.end()) {
+        ++misses;
+        return nullptr;
+    }
+    ++hits;
+    lru.splice(lru.begin(), lru, i->second);
+    return &*i->second;
+}
+
+void QoreRegexCache::addIntern(RegexCacheEntry&& e) {
+    // another thread may have compiled and added the same pattern in the meantime
+    rcmap_t::iterator i = map.find(e.key);
+    if (i != map.end()) {
+        i->second->del();
+        lru.erase(i->second);
+        map.erase(i);
+    }
+
+    lru.push_front(std::move(e));
+    map[lru.front().key] = lru.begin();
+    trimIntern();
+}
+
+void QoreRegexCache::trimIntern() {
+    while (lru.size() > max) {
+        RegexCacheEntry& last = lru.back();
+        map.erase(last.key);
+        last.del();
+        lru.pop_back();
+    }
+}
+
+void QoreRegexCache::clearIntern() {
+    for (auto& i : lru)
+        i.del();
+    lru.clear();
+    map.clear();
+}
+
+QoreRegex* QoreRegexCache::getRegex(const QoreString& pattern, int64 options, ExceptionSink* xsink) {
+    std::string key = getKey('m', pattern, options);
+    {
+        AutoLocker al(m);
+        RegexCacheEntry* e = findIntern(key);
+        if (e)
+            return e->re->refSelf();
+    }
+
+    // compile the pattern outside the lock
+    SimpleRefHolder<QoreRegex> re(new QoreRegex(pattern, options, xsink));
+    if (*xsink)
+        return nullptr;
+
+    AutoLocker al(m);
+    if (max)
+        addIntern(RegexCacheEntry(std::move(key), re->refSelf()));
+    return re.release();
+}
+
+QoreRegexSubst* QoreRegexCache::getRegexSubst(const QoreString& pattern, int64 options, ExceptionSink* xsink) {
+    std::string key = getKey('s', pattern, options);
+    {
+        AutoLocker al(m);
+        RegexCacheEntry* e = findIntern(key);
+        if (e)
+            return e->rs->refSelf();
+    }
+
+    // compile the pattern outside the lock
+    SimpleRefHolder<QoreRegexSubst> rs(new QoreRegexSubst(&pattern, (int)(options & 0xffffffff), xsink));
+    if (*xsink)
+        return nullptr;
+    if (options & QRE_GLOBAL)
+        rs->setGlobal();
+
+    AutoLocker al(m);
+    if (max)
+        addIntern(RegexCacheEntry(std::move(key), rs->refSelf()));
+    return rs.release();
+}
+
+void QoreRegexCache::setMaxSize(size_t n_max) {
+    AutoLocker al(m);
+    max = n_max;
+    trimIntern();
+}
+
+void QoreRegexCache::getInfo(size_t& n_size, size_t& n_max, int64& n_hits, int64& n_misses) {
+    AutoLocker al(m);
+    n_size = lru.size();
+    n_max = max;
+    n_hits = hits;
+    n_misses = misses;
+}
@@ -31,6 +31,7 @@
 
 #include <qore/Qore.h>
 #include "qore/intern/QC_SQLStatement.h"
+#include "qore/intern/QC_SQLColumnBlock.h"
 #include "qore/intern/DatasourceStatementHelper.h"
 #include "qore/intern/sql_statement_private.h"
 #include "qore/intern/qore_ds_private.h"
@@ -472,6 +473,38 @@ QoreHashNode* QoreSQLStatement::fetchColumns(int rows, ExceptionSink* xsink) {
    return qore_dbi_private::get(*priv->ds->getDriver())->stmt_fetch_columns(this, rows, xsink);
 }
 
+QoreSQLColumnBlock* QoreSQLStatement::fetchBlock(int rows, ExceptionSink* xsink) {
+   DBActionHelper dba(*this, xsink, DAH_ACQUIRE);
+   if (!dba)
+      return nullptr;
+
+   if (checkStatus(xsink, dba, STMT_DEFINED, "fetchBlock"))
+      return nullptr;
+
+   const qore_dbi_private* driver = qore_dbi_private::get(*priv->ds->getDriver());
+   ReferenceHolder<QoreSQLColumnBlock> rv(xsink);
+   if (driver->hasStmtFetchBlock()) {
+      rv = new QoreSQLColumnBlock;
+      if (driver->stmt_fetch_block(this, **rv, rows, xsink) || rv->check(xsink))
+         return nullptr;
+   }
+   else {
+      // drivers without native support: convert the column block returned by the driver
+      ReferenceHolder<QoreHashNode> h(driver->stmt_fetch_columns(this, rows, xsink), xsink);
+      if (!h)
+         return nullptr;
+      rv = QoreSQLColumnBlock::fromColumns(*h, xsink);
+      if (!rv)
+         return nullptr;
+   }
+
+   // no more rows are available
+   if (!rv->size())
+      return nullptr;
+
+   return rv.release();
+}
+
 QoreHashNode* QoreSQLStatement::describe(ExceptionSink* xsink) {
     DBActionHelper dba(*this, xsink, DAH_ACQUIRE);
     if (!dba)
@@ -0,0 +1,362 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreSlabAllocator.cpp
+
+    per-thread slab allocator for small node objects
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#include <qore/Qore.h>
+#include "qore/intern/QoreSlabAllocator.h"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+// the number of objects moved between a thread cache and the shared free list of a size class at once
+#define QORE_SLAB_BATCH 32
+// the maximum number of free objects kept in a thread cache for each size class
+#define QORE_SLAB_THREAD_MAX (QORE_SLAB_BATCH * 4)
+
+namespace {
+// a free object in a free list
+struct slab_free_obj {
+    slab_free_obj* next;
+};
+
+// a spin lock; the slab structures are used before static constructors have run, so they must be
+// constant-initialized, and the critical sections only move a batch of objects
+class slab_lock {
+public:
+    void lock() {
+        while (l.test_and_set(std::memory_order_acquire))
+            sched_yield();
+    }
+
+    void unlock() {
+        l.clear(std::memory_order_release);
+    }
+
+private:
+    std::atomic_flag l = ATOMIC_FLAG_INIT;
+};
+
+typedef std::lock_guard<slab_lock> slab_lock_guard;
+
+// the objects of a size class shared by all threads
+struct slab_central {
+    slab_lock l;
+    // objects returned by thread caches
+    slab_free_obj* free = nullptr;
+    int64 nfree = 0;
+    // the unused part of the current chunk
+    char* pos = nullptr;
+    char* end = nullptr;
+};
+
+// counters are only written by the owning thread and are read by q_slab_get_info()
+typedef std::atomic<int64> slab_counter_t;
+
+static inline void slab_add(slab_counter_t& c, int64 n) {
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// a thread's cache for a size class
+struct slab_thread_class {
+    slab_free_obj* free = nullptr;
+    slab_counter_t nfree{0};
+    slab_counter_t allocs{0};
+    slab_counter_t frees{0};
+};
+
+struct slab_thread_cache {
+    slab_thread_class c[QORE_SLAB_CLASSES];
+    // thread cache list links
+    slab_thread_cache* prev = nullptr;
+    slab_thread_cache* next = nullptr;
+};
+
+slab_central slab_classes[QORE_SLAB_CLASSES];
+std::atomic<int64> slab_chunks(0);
+
+// the list of thread caches and the counters of released thread caches
+slab_lock slab_cache_lock;
+slab_thread_cache* slab_caches = nullptr;
+std::atomic<int64> slab_retired_allocs[QORE_SLAB_CLASSES];
+std::atomic<int64> slab_retired_frees[QORE_SLAB_CLASSES];
+
+// releases thread caches when threads exit
+pthread_key_t slab_cache_key;
+pthread_once_t slab_cache_key_once = PTHREAD_ONCE_INIT;
+
+thread_local slab_thread_cache* slab_tcache = nullptr;
+// set when the thread's cache has been released while the thread is exiting
+thread_local bool slab_tcache_released = false;
+
+#ifdef QORE_NODE_COALLOC
+// the last co-allocated block in the thread whose private data has not been taken yet
+thread_local void* slab_coalloc_obj = nullptr;
+#endif
+}
+
+static inline unsigned slab_class(size_t size) {
+    return size ? (size - 1) / QORE_SLAB_GRANULARITY : 0;
+}
+
+// moves up to max objects from the shared free list or the current chunk of the size class to the given list;
+// returns the number of objects moved
+static int64 slab_central_get(unsigned cls, slab_free_obj*& list, int64 max) {
+    slab_central& sc = slab_classes[cls];
+    size_t size = (cls + 1) * QORE_SLAB_GRANULARITY;
+
+    slab_lock_guard g(sc.l);
+    int64 n = 0;
+    while (sc.free && n < max) {
+        slab_free_obj* o = sc.free;
+        sc.free = o->next;
+        o->next = list;
+        list = o;
+        ++n;
+    }
+    if (n) {
+        sc.nfree -= n;
+        return n;
+    }
+
+    while (n < max) {
+        if (sc.pos + size > sc.end) {
+            if (n)
+                break;
+            // the unused rest of the previous chunk is abandoned
+            char* chunk = (char*)malloc(QORE_SLAB_CHUNK_SIZE);
+            if (!chunk)
+                return 0;
+            ++slab_chunks;
+            sc.pos = chunk;
+            sc.end = chunk + QORE_SLAB_CHUNK_SIZE;
+        }
+        slab_free_obj* o = (slab_free_obj*)sc.pos;
+        sc.pos += size;
+        o->next = list;
+        list = o;
+        ++n;
+    }
+    return n;
+}
+
+// returns a list of n objects ending with last to the shared free list of the size class
+static void slab_central_put(unsigned cls, slab_free_obj* first, slab_free_obj* last, int64 n) {
+    slab_central& sc = slab_classes[cls];
+
+    slab_lock_guard g(sc.l);
+    last->next = sc.free;
+    sc.free = first;
+    sc.nfree += n;
+}
+
+// returns the objects in a thread cache to the shared free lists when the thread exits
+static void slab_release_cache(void* p) {
+    slab_thread_cache* tc = (slab_thread_cache*)p;
+
+    for (unsigned i = 0; i < QORE_SLAB_CLASSES; ++i) {
+        slab_thread_class& c = tc->c[i];
+        if (c.free) {
+            slab_free_obj* last = c.free;
+            while (last->next)
+                last = last->next;
+            slab_central_put(i, c.free, last, c.nfree.load(std::memory_order_relaxed));
+        }
+    }
+
+    {
+        slab_lock_guard g(slab_cache_lock);
+        for (unsigned i = 0; i < QORE_SLAB_CLASSES; ++i) {
+            slab_retired_allocs[i] += tc->c[i].allocs.load(std::memory_order_relaxed);
+            slab_retired_frees[i] += tc->c[i].frees.load(std::memory_order_relaxed);
+        }
+        if (tc->prev)
+            tc->prev->next = tc->next;
+        else
+            slab_caches = tc->next;
+        if (tc->next)
+            tc->next->prev = tc->prev;
+    }
+
+    delete tc;
+    slab_tcache = nullptr;
+    // objects freed later in the exiting thread (for example by other thread-local destructors) are returned to
+    // the shared free lists directly
+    slab_tcache_released = true;
+}
+
+static void slab_make_key() {
+    pthread_key_create(&slab_cache_key, slab_release_cache);
+}
+
+// returns the calling thread's cache or nullptr if it has already been released
+static slab_thread_cache* slab_get_cache() {
+    slab_thread_cache* tc = slab_tcache;
+    if (tc || slab_tcache_released)
+        return tc;
+
+    tc = new slab_thread_cache;
+    pthread_once(&slab_cache_key_once, slab_make_key);
+    pthread_setspecific(slab_cache_key, tc);
+
+    {
+        slab_lock_guard g(slab_cache_lock);
+        tc->next = slab_caches;
+        if (slab_caches)
+            slab_caches->prev = tc;
+        slab_caches = tc;
+    }
+
+    slab_tcache = tc;
+    return tc;
+}
+
+void* q_slab_alloc(size_t size) {
+    if (size > QORE_SLAB_MAX_SIZE) {
+        void* p = malloc(size);
+        if (!p)
+            throw std::bad_alloc();
+        return p;
+    }
+
+    unsigned cls = slab_class(size);
+    slab_thread_cache* tc = slab_get_cache();
+    if (!tc) {
+        slab_free_obj* o = nullptr;
+        if (!slab_central_get(cls, o, 1))
+            throw std::bad_alloc();
+        ++slab_retired_allocs[cls];
+        return o;
+    }
+
+    slab_thread_class& c = tc->c[cls];
+    if (!c.free) {
+        int64 n = slab_central_get(cls, c.free, QORE_SLAB_BATCH);
+        if (!n)
+            throw std::bad_alloc();
+        slab_add(c.nfree, n);
+    }
+
+    slab_free_obj* o = c.free;
+    c.free = o->next;
+    slab_add(c.nfree, -1);
+    slab_add(c.allocs, 1);
+    return o;
+}
+
+void q_slab_free(void* p, size_t size) {
+    if (!p)
+        return;
+    if (size > QORE_SLAB_MAX_SIZE) {
+        free(p);
+        return;
+    }
+
+    unsigned cls = slab_class(size);
+    slab_free_obj* o = (slab_free_obj*)p;
+    // objects are returned to the freeing thread's cache, so objects freed in another thread than the one that
+    // allocated them never touch the other thread's cache
+    slab_thread_cache* tc = slab_get_cache();
+    if (!tc) {
+        slab_central_put(cls, o, o, 1);
+        ++slab_retired_frees[cls];
+        return;
+    }
+
+    slab_thread_class& c = tc->c[cls];
+    o->next = c.free;
+    c.free = o;
+    slab_add(c.frees, 1);
+    slab_add(c.nfree, 1);
+
+    // return a batch to the shared free list if the thread has cached too many objects
+    if (c.nfree.load(std::memory_order_relaxed) > QORE_SLAB_THREAD_MAX) {
+        slab_free_obj* first = c.free;
+        slab_free_obj* last = first;
+        for (int i = 1; i < QORE_SLAB_BATCH; ++i)
+            last = last->next;
+        c.free = last->next;
+        slab_add(c.nfree, -QORE_SLAB_BATCH);
+        slab_central_put(cls, first, last, QORE_SLAB_BATCH);
+    }
+}
+
+#ifdef QORE_NODE_COALLOC
+void* q_slab_alloc_coalloc(size_t size, size_t priv_size) {
+    void* p = q_slab_alloc(q_slab_coalloc_size(size, priv_size));
+    slab_coalloc_obj = p;
+    return p;
+}
+
+void* q_slab_take_coalloc(const void* obj, size_t size) {
+    if (slab_coalloc_obj != obj)
+        return nullptr;
+    slab_coalloc_obj = nullptr;
+    return (char*)obj + QORE_SLAB_ROUND(size);
+}
+#endif
+
+void q_slab_get_info(std::vector<qore_slab_class_info>& info, int64& chunks) {
+    int64 allocs[QORE_SLAB_CLASSES], frees[QORE_SLAB_CLASSES], cached[QORE_SLAB_CLASSES];
+
+    {
+        slab_lock_guard g(slab_cache_lock);
+        for (unsigned i = 0; i < QORE_SLAB_CLASSES; ++i) {
+            allocs[i] = slab_retired_allocs[i].load();
+            frees[i] = slab_retired_frees[i].load();
+            cached[i] = 0;
+        }
+        for (slab_thread_cache* tc = slab_caches; tc; tc = tc->next) {
+            for (unsigned i = 0; i < QORE_SLAB_CLASSES; ++i) {
+                allocs[i] += tc->c[i].allocs.load(std::memory_order_relaxed);
+                frees[i] += tc->c[i].frees.load(std::memory_order_relaxed);
+                cached[i] += tc->c[i].nfree.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < QORE_SLAB_CLASSES; ++i) {
+        if (!allocs[i])
+            continue;
+        {
+            slab_lock_guard g(slab_classes[i].l);
+            cached[i] += slab_classes[i].nfree;
+        }
+        info.push_back({(i + 1) * QORE_SLAB_GRANULARITY, allocs[i], frees[i], cached[i]});
+    }
+
+    chunks = slab_chunks.load();
+}
@@ -37,6 +37,95 @@
 #include <qore/QoreSocket.h>
 
 #include "qore/intern/qore_socket_private.h"
+#include "qore/intern/QoreHashNodeIntern.h"
+
+#include <vector>
+
+// the longest common HTTP header field name
+#define QORE_HTTP_HEADER_KEY_MAXLEN 20
+
+// common HTTP header field names; hash keys for these fields are not lowercased or hashed for each header received
+static qore_http_header_key q_http_header_keys[] = {
+   {"accept", 0, 0, QHH_OTHER},
+   {"accept-charset", 0, 0, QHH_ACCEPT_CHARSET},
+   {"accept-encoding", 0, 0, QHH_ACCEPT_ENCODING},
+   {"accept-language", 0, 0, QHH_OTHER},
+   {"accept-ranges", 0, 0, QHH_OTHER},
+   {"age", 0, 0, QHH_OTHER},
+   {"allow", 0, 0, QHH_OTHER},
+   {"authorization", 0, 0, QHH_OTHER},
+   {"cache-control", 0, 0, QHH_OTHER},
+   {"connection", 0, 0, QHH_CONNECTION},
+   {"content-disposition", 0, 0, QHH_OTHER},
+   {"content-encoding", 0, 0, QHH_OTHER},
+   {"content-language", 0, 0, QHH_OTHER},
+   {"content-length", 0, 0, QHH_OTHER},
+   {"content-location", 0, 0, QHH_OTHER},
+   {"content-type", 0, 0, QHH_CONTENT_TYPE},
+   {"cookie", 0, 0, QHH_OTHER},
+   {"date", 0, 0, QHH_OTHER},
+   {"etag", 0, 0, QHH_OTHER},
+   {"expect", 0, 0, QHH_OTHER},
+   {"expires", 0, 0, QHH_OTHER},
+   {"host", 0, 0, QHH_OTHER},
+   {"if-match", 0, 0, QHH_OTHER},
+   {"if-modified-since", 0, 0, QHH_OTHER},
+   {"if-none-match", 0, 0, QHH_OTHER},
+   {"keep-alive", 0, 0, QHH_OTHER},
+   {"last-modified", 0, 0, QHH_OTHER},
+   {"location", 0, 0, QHH_OTHER},
+   {"origin", 0, 0, QHH_OTHER},
+   {"pragma", 0, 0, QHH_OTHER},
+   {"proxy-authorization", 0, 0, QHH_OTHER},
+   {"range", 0, 0, QHH_OTHER},
+   {"referer", 0, 0, QHH_OTHER},
+   {"server", 0, 0, QHH_OTHER},
+   {"set-cookie", 0, 0, QHH_OTHER},
+   {"soapaction", 0, 0, QHH_OTHER},
+   {"transfer-encoding", 0, 0, QHH_TRANSFER_ENCODING},
+   {"upgrade", 0, 0, QHH_OTHER},
+   {"user-agent", 0, 0, QHH_OTHER},
+   {"vary", 0, 0, QHH_OTHER},
+   {"via", 0, 0, QHH_OTHER},
+   {"www-authenticate", 0, 0, QHH_OTHER},
+   {"x-forwarded-for", 0, 0, QHH_OTHER},
+   {"x-forwarded-proto", 0, 0, QHH_OTHER},
+   {"x-requested-with", 0, 0, QHH_OTHER},
+};
+
+typedef std::vector<const qore_http_header_key*> qore_http_header_key_list_t;
+
+// common HTTP header field names indexed by length
+class QoreHttpHeaderKeyMap {
+public:
+   DLLLOCAL QoreHttpHeaderKeyMap() {
+      for (auto& k : q_http_header_keys) {
+         k.len = strlen(k.name);
+         assert(k.len <= QORE_HTTP_HEADER_KEY_MAXLEN);
+         k.hash = HashMember::getHash(k.name);
+         by_len[k.len].push_back(&k);
+      }
+   }
+
+   DLLLOCAL const qore_http_header_key* find(const char* name, size_t len) const {
+      if (len > QORE_HTTP_HEADER_KEY_MAXLEN)
+         return nullptr;
+      for (auto& k : by_len[len]) {
+         if (!strncasecmp(k->name, name, len))
+            return k;
+      }
+      return nullptr;
+   }
+
+private:
+   qore_http_header_key_list_t by_len[QORE_HTTP_HEADER_KEY_MAXLEN + 1];
+};
+
+static QoreHttpHeaderKeyMap q_http_header_key_map;
+
+const qore_http_header_key* q_find_http_header_key(const char* name, size_t len) {
+   return q_http_header_key_map.find(name, len);
+}
 
 void se_in_op(const char* cname, const char* meth, ExceptionSink* xsink) {
    assert(xsink);
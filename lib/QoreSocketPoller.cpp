@@ -0,0 +1,329 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreSocketPoller.cpp
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#include <qore/Qore.h>
+#include "qore/intern/QoreSocketPoller.h"
+#include "qore/intern/QC_Socket.h"
+#include "qore/intern/qore_socket_private.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
+#include <vector>
+
+QoreSocketPoller::QoreSocketPoller(ExceptionSink* xsink) {
+#ifdef _Q_WINDOWS
+    xsink->raiseException("SOCKETPOLLER-ERROR", "the SocketPoller class is not supported on this platform");
+#else
+    if (pipe(wfd)) {
+        xsink->raiseErrnoException("SOCKETPOLLER-ERROR", errno, "failed to create wakeup pipe");
+        return;
+    }
+    for (int i = 0; i < 2; ++i) {
+        fcntl(wfd[i], F_SETFL, fcntl(wfd[i], F_GETFL) | O_NONBLOCK);
+        fcntl(wfd[i], F_SETFD, FD_CLOEXEC);
+    }
+
+#ifdef HAVE_SYS_EPOLL_H
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        xsink->raiseErrnoException("SOCKETPOLLER-ERROR", errno, "epoll_create1() failed");
+        return;
+    }
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = 0;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, wfd[0], &ev))
+        xsink->raiseErrnoException("SOCKETPOLLER-ERROR", errno, "failed to add wakeup descriptor to epoll set");
+#endif
+#endif
+}
+
+QoreSocketPoller::~QoreSocketPoller() {
+    assert(smap.empty());
+#ifndef _Q_WINDOWS
+#ifdef HAVE_SYS_EPOLL_H
+    if (epfd >= 0)
+        close(epfd);
+#endif
+    if (wfd[0] >= 0) {
+        close(wfd[0]);
+        close(wfd[1]);
+    }
+#endif
+}
+
+void QoreSocketPoller::deref(ExceptionSink* xsink) {
+    if (ROdereference()) {
+        for (auto& i : smap) {
+            i.second.sock->deref(xsink);
+            i.second.arg.discard(xsink);
+        }
+        smap.clear();
+        delete this;
+    }
+}
+
+const char* QoreSocketPoller::getMethod() {
+#ifdef HAVE_SYS_EPOLL_H
+    return "epoll";
+#else
+    return "poll";
+#endif
+}
+
+int QoreSocketPoller::getSocketFd(QoreSocketObject* sock, bool* buffered) {
+    AutoLocker al(sock->priv->m);
+    qore_socket_private* spriv = qore_socket_private::get(*sock->priv->socket);
+    if (buffered)
+        *buffered = spriv->hasBufferedData();
+    return spriv->sock;
+}
+
+int QoreSocketPoller::add(QoreSocketObject* sock, QoreValue arg, ExceptionSink* xsink) {
+    ReferenceHolder<QoreSocketObject> holder(sock, xsink);
+    ValueHolder val(arg, xsink);
+
+    bool buffered = false;
+    int fd = getSocketFd(sock, &buffered);
+    if (fd == QORE_INVALID_SOCKET) {
+        xsink->raiseException("SOCKET-NOT-OPEN", "the socket must be open to be added to a SocketPoller");
+        return -1;
+    }
+
+    AutoLocker al(m);
+    if (sidmap.find(sock) != sidmap.end()) {
+        xsink->raiseException("SOCKETPOLLER-ERROR", "the socket is already registered with this SocketPoller");
+        return -1;
+    }
+
+    int64 id = next_id++;
+#ifdef HAVE_SYS_EPOLL_H
+    if (!buffered) {
+        // one-shot registrations are disabled by the kernel when they fire, so ready sockets do not need to be
+        // removed from the set with an extra system call; a disabled registration is reenabled here
+        epoll_event ev;
+        ev.events = EPOLLIN | EPOLLONESHOT;
+        ev.data.u64 = id;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) && (errno != EEXIST || epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev))) {
+            xsink->raiseErrnoException("SOCKETPOLLER-ERROR", errno, "failed to add socket %d to epoll set", fd);
+            return -1;
+        }
+    }
+#endif
+
+    smap[id] = {holder.release(), val.release(), fd};
+    sidmap[sock] = id;
+
+    bool wake = false;
+    if (buffered) {
+        ready.push_back(id);
+        wake = true;
+    }
+#ifndef HAVE_SYS_EPOLL_H
+    // the descriptor set is rebuilt for every wait
+    wake = true;
+#endif
+    if (wake && waiting)
+        wakeup();
+    return 0;
+}
+
+bool QoreSocketPoller::remove(QoreSocketObject* sock, ExceptionSink* xsink) {
+    int fd = getSocketFd(sock);
+
+    QoreValue arg;
+    {
+        AutoLocker al(m);
+        sidmap_t::iterator si = sidmap.find(sock);
+        if (si == sidmap.end())
+            return false;
+
+        spmap_t::iterator i = smap.find(si->second);
+        assert(i != smap.end());
+#ifdef HAVE_SYS_EPOLL_H
+        // if the socket has been closed, the kernel has already removed it from the set, and the descriptor may
+        // now belong to another socket
+        if (fd == i->second.fd)
+            epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+#endif
+        arg = i->second.arg;
+        smap.erase(i);
+        sidmap.erase(si);
+    }
+
+    // release the poller's references outside the lock
+    sock->deref(xsink);
+    arg.discard(xsink);
+    return true;
+}
+
+void QoreSocketPoller::takeEntryIntern(spmap_t::iterator i, QoreListNode* l, ExceptionSink* xsink) {
+    QoreSocketObject* sock = i->second.sock;
+    QoreValue arg = i->second.arg;
+    sidmap.erase(sock);
+    smap.erase(i);
+
+    sock->deref(xsink);
+    l->push(arg, xsink);
+}
+
+QoreListNode* QoreSocketPoller::wait(int timeout_ms, ExceptionSink* xsink) {
+    ReferenceHolder<QoreListNode> rv(new QoreListNode(autoTypeInfo), xsink);
+
+#ifndef HAVE_SYS_EPOLL_H
+    std::vector<pollfd> fds;
+    std::vector<int64> ids;
+#endif
+    {
+        AutoLocker al(m);
+        if (waiting) {
+            xsink->raiseException("SOCKETPOLLER-ERROR", "another thread is already waiting on this SocketPoller");
+            return nullptr;
+        }
+        // return sockets with buffered data immediately
+        if (!ready.empty()) {
+            while (!ready.empty()) {
+                spmap_t::iterator i = smap.find(ready.front());
+                ready.pop_front();
+                if (i != smap.end())
+                    takeEntryIntern(i, *rv, xsink);
+            }
+            return rv.release();
+        }
+        waiting = true;
+
+#ifndef HAVE_SYS_EPOLL_H
+        fds.reserve(smap.size() + 1);
+        ids.reserve(smap.size() + 1);
+        fds.push_back({wfd[0], POLLIN, 0});
+        ids.push_back(0);
+        for (auto& i : smap) {
+            fds.push_back({i.second.fd, POLLIN, 0});
+            ids.push_back(i.first);
+        }
+#endif
+    }
+
+#ifdef HAVE_SYS_EPOLL_H
+    epoll_event events[QORE_SOCKET_POLLER_EVENTS];
+    int rc = epoll_wait(epfd, events, QORE_SOCKET_POLLER_EVENTS, timeout_ms);
+#elif defined(_Q_WINDOWS)
+    int rc = 0;
+#else
+    int rc = poll(&fds[0], fds.size(), timeout_ms);
+#endif
+    int err = errno;
+
+    AutoLocker al(m);
+    waiting = false;
+    if (rc < 0) {
+        // a signal interrupted the wait; return an empty list
+        if (err == EINTR)
+            return rv.release();
+        xsink->raiseErrnoException("SOCKETPOLLER-ERROR", err, "error waiting for socket events");
+        return nullptr;
+    }
+
+#ifdef HAVE_SYS_EPOLL_H
+    for (int j = 0; j < rc; ++j) {
+        int64 id = (int64)events[j].data.u64;
+#else
+    for (size_t j = 0; rc > 0 && j < fds.size(); ++j) {
+        if (!fds[j].revents)
+            continue;
+        --rc;
+        int64 id = ids[j];
+#endif
+        if (!id) {
+            drainWakeup();
+            continue;
+        }
+        // the socket may have been removed while waiting
+        spmap_t::iterator i = smap.find(id);
+        if (i != smap.end())
+            takeEntryIntern(i, *rv, xsink);
+    }
+
+    // return any sockets with buffered data added while waiting
+    while (!ready.empty()) {
+        spmap_t::iterator i = smap.find(ready.front());
+        ready.pop_front();
+        if (i != smap.end())
+            takeEntryIntern(i, *rv, xsink);
+    }
+
+    return rv.release();
+}
+
+QoreListNode* QoreSocketPoller::clear(ExceptionSink* xsink) {
+    ReferenceHolder<QoreListNode> rv(new QoreListNode(autoTypeInfo), xsink);
+
+    AutoLocker al(m);
+    while (!smap.empty()) {
+        spmap_t::iterator i = smap.begin();
+#ifdef HAVE_SYS_EPOLL_H
+        if (getSocketFd(i->second.sock) == i->second.fd)
+            epoll_ctl(epfd, EPOLL_CTL_DEL, i->second.fd, nullptr);
+#endif
+        takeEntryIntern(i, *rv, xsink);
+    }
+    ready.clear();
+
+    return rv.release();
+}
+
+void QoreSocketPoller::wakeup() {
+#ifndef _Q_WINDOWS
+    char c = 0;
+    // the pipe is non-blocking; if it is full, a wakeup is already pending
+    if (write(wfd[1], &c, 1) < 0) {
+    }
+#endif
+}
+
+void QoreSocketPoller::drainWakeup() {
+#ifndef _Q_WINDOWS
+    char buf[64];
+    while (read(wfd[0], buf, sizeof(buf)) > 0) {
+    }
+#endif
+}
+
+size_t QoreSocketPoller::size() {
+    AutoLocker al(m);
+    return smap.size();
+}
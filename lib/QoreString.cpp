@@ -47,6 +47,10 @@
 #include <string>
 #include <map>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #ifdef DEBUG_TESTS
 #  include "tests/QoreString_tests.cpp"
 #endif
@@ -596,6 +600,84 @@ int qore_string_private::concatEncodeUriRequest(ExceptionSink* xsink, const qore
 }
 
 
+// returns true if the encoding is a known superset of 7-bit ASCII where every byte < 0x80 represents the same ASCII character
+/* note that encodings created dynamically are flagged as ASCII-compatible but are not necessarily ASCII supersets
+   (ex: ISO-2022-JP, EBCDIC)
+*/
+static bool q_is_ascii_superset(const QoreEncoding* enc) {
+   return enc == QCS_UTF8 || enc == QCS_USASCII
+      || enc == QCS_ISO_8859_1 || enc == QCS_ISO_8859_2 || enc == QCS_ISO_8859_3 || enc == QCS_ISO_8859_4
+      || enc == QCS_ISO_8859_5 || enc == QCS_ISO_8859_6 || enc == QCS_ISO_8859_7 || enc == QCS_ISO_8859_8
+      || enc == QCS_ISO_8859_9 || enc == QCS_ISO_8859_10 || enc == QCS_ISO_8859_11 || enc == QCS_ISO_8859_13
+      || enc == QCS_ISO_8859_14 || enc == QCS_ISO_8859_15 || enc == QCS_ISO_8859_16
+      || enc == QCS_KOI8_R || enc == QCS_KOI8_U;
+}
+
+// returns the length of the initial run of 7-bit ASCII bytes in the buffer
+static qore_size_t q_ascii_prefix_len(const char* p, qore_size_t len) {
+   const char* start = p;
+   const char* end = p + len;
+#ifdef __SSE2__
+   while (end - p >= 16) {
+      int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+      if (mask)
+         return (p - start) + __builtin_ctz(mask);
+      p += 16;
+   }
+#endif
+   while (end - p >= 8) {
+      uint64_t w;
+      memcpy(&w, p, 8);
+      if (w & 0x8080808080808080ULL)
+         break;
+      p += 8;
+   }
+   while (p < end && !(*p & 0x80))
+      ++p;
+   return p - start;
+}
+
+// converts ISO-8859-1 to UTF-8 without iconv; every ISO-8859-1 character has a UTF-8 representation
+static void q_latin1_to_utf8(const char* src, qore_size_t src_len, qore_size_t off, qore_string_private& targ) {
+   targ.allocate(off + (src_len - off) * 2 + 1);
+   char* ob = targ.buf;
+   memcpy(ob, src, off);
+   ob += off;
+   for (const unsigned char* p = (const unsigned char*)src + off, * e = (const unsigned char*)src + src_len; p < e; ++p) {
+      if (*p < 0x80)
+         *ob++ = *p;
+      else {
+         *ob++ = (char)(0xc0 | (*p >> 6));
+         *ob++ = (char)(0x80 | (*p & 0x3f));
+      }
+   }
+   targ.len = ob - targ.buf;
+   targ.buf[targ.len] = '\0';
+}
+
+// converts UTF-8 to ISO-8859-1 without iconv; returns -1 if the input cannot be converted, in which case iconv must
+// be used to report the error
+static int q_utf8_to_latin1(const char* src, qore_size_t src_len, qore_size_t off, qore_string_private& targ) {
+   targ.allocate(src_len + 1);
+   char* ob = targ.buf;
+   memcpy(ob, src, off);
+   ob += off;
+   for (const unsigned char* p = (const unsigned char*)src + off, * e = (const unsigned char*)src + src_len; p < e; ++p) {
+      if (*p < 0x80)
+         *ob++ = *p;
+      // 0xc2 and 0xc3 are the lead bytes for U+0080 - U+00FF
+      else if ((*p & 0xfe) == 0xc2 && (p + 1) < e && (p[1] & 0xc0) == 0x80) {
+         *ob++ = (char)(((*p & 0x03) << 6) | (p[1] & 0x3f));
+         ++p;
+      }
+      else
+         return -1;
+   }
+   targ.len = ob - targ.buf;
+   targ.buf[targ.len] = '\0';
+   return 0;
+}
+
 // static function
 int qore_string_private::convert_encoding_intern(const char* src, qore_size_t src_len, const QoreEncoding* from, QoreString& targ, const QoreEncoding* nccs, ExceptionSink* xsink) {
    assert(targ.priv->getEncoding() == nccs);
@@ -603,6 +685,30 @@ int qore_string_private::convert_encoding_intern(const char* src, qore_size_t sr
 
    //printd(5, "qore_string_private::convert_encoding_intern() %s -> %s len: " QSD " src='%s'\n", from->getCode(), nccs->getCode(), src_len, src);
 
+   // the initial run of ASCII characters is copied directly if both encodings are ASCII supersets
+   qore_size_t off = 0;
+   if (q_is_ascii_superset(from) && q_is_ascii_superset(nccs)) {
+      off = q_ascii_prefix_len(src, src_len);
+      if (off == src_len) {
+         targ.priv->allocate(src_len + 1);
+         memcpy(targ.priv->buf, src, src_len);
+         targ.priv->buf[src_len] = '\0';
+         targ.priv->len = src_len;
+         return 0;
+      }
+
+      if (from == QCS_ISO_8859_1 && nccs == QCS_UTF8) {
+         q_latin1_to_utf8(src, src_len, off, *targ.priv);
+         return 0;
+      }
+
+      if (from == QCS_UTF8 && nccs == QCS_ISO_8859_1) {
+         if (!q_utf8_to_latin1(src, src_len, off, *targ.priv))
+            return 0;
+         targ.priv->len = 0;
+      }
+   }
+
    IconvHelper c(nccs, from, xsink);
    if (xsink && *xsink)
       return -1;
@@ -610,11 +716,12 @@ int qore_string_private::convert_encoding_intern(const char* src, qore_size_t sr
    // now convert value
    qore_size_t al = src_len + STR_CLASS_BLOCK;
    targ.allocate(al + 1);
+   memcpy(targ.priv->buf, src, off);
    while (true) {
-      size_t ilen = src_len;
-      size_t olen = al;
-      char* ib = (char*)src;
-      char* ob = targ.priv->buf;
+      size_t ilen = src_len - off;
+      size_t olen = al - off;
+      char* ib = (char*)src + off;
+      char* ob = targ.priv->buf + off;
       size_t rc = c.iconv(&ib, &ilen, &ob, &olen);
       if (rc == (size_t)-1) {
          switch (errno) {
@@ -1000,53 +1107,31 @@ QoreStringMaker::QoreStringMaker(const QoreEncoding* enc, const char* fmt, ...)
 
 QoreString::QoreString() : priv(new qore_string_private) {
    priv->len = 0;
-   priv->allocated = STR_CLASS_BLOCK;
-   priv->buf = (char*)malloc(priv->allocated * sizeof(char));
+   priv->initBuffer(1);
    priv->buf[0] = '\0';
    priv->charset = QCS_DEFAULT;
 }
 
-// FIXME: this is not very efficient with the array offsets...
 QoreString::QoreString(const char* str) : priv(new qore_string_private) {
-   priv->len = 0;
-   priv->allocated = STR_CLASS_BLOCK;
-   priv->buf = (char*)malloc(priv->allocated * sizeof(char));
-   if (str) {
-      while (str[priv->len]) {
-         priv->check_char(priv->len);
-         priv->buf[priv->len] = str[priv->len];
-         priv->len++;
-      }
-      priv->check_char(priv->len);
-      priv->buf[priv->len] = '\0';
-   }
-   else
-      priv->buf[0] = '\0';
+   priv->len = str ? ::strlen(str) : 0;
+   priv->initBuffer(priv->len + 1);
+   if (priv->len)
+      memcpy(priv->buf, str, priv->len);
+   priv->buf[priv->len] = '\0';
    priv->charset = QCS_DEFAULT;
 }
 
-// FIXME: this is not very efficient with the array offsets...
 QoreString::QoreString(const char* str, const QoreEncoding* new_qorecharset) : priv(new qore_string_private) {
-   priv->len = 0;
-   priv->allocated = STR_CLASS_BLOCK;
-   priv->buf = (char*)malloc(priv->allocated * sizeof(char));
-   if (str) {
-      while (str[priv->len]) {
-         priv->check_char(priv->len);
-         priv->buf[priv->len] = str[priv->len];
-         priv->len++;
-      }
-      priv->check_char(priv->len);
-      priv->buf[priv->len] = '\0';
-   }
-   else
-      priv->buf[0] = '\0';
+   priv->len = str ? ::strlen(str) : 0;
+   priv->initBuffer(priv->len + 1);
+   if (priv->len)
+      memcpy(priv->buf, str, priv->len);
+   priv->buf[priv->len] = '\0';
    priv->charset = new_qorecharset;
 }
 
 QoreString::QoreString(const std::string& str, const QoreEncoding* new_encoding) : priv(new qore_string_private) {
-   priv->allocated = str.size() + 1 + STR_CLASS_BLOCK;
-   priv->buf = (char*)malloc(priv->allocated * sizeof(char));
+   priv->initBuffer(str.size() + 1);
    memcpy(priv->buf, str.c_str(), str.size() + 1);
    priv->len = str.size();
    priv->charset = new_encoding;
@@ -1054,16 +1139,14 @@ QoreString::QoreString(const std::string& str, const QoreEncoding* new_encoding)
 
 QoreString::QoreString(const QoreEncoding* new_qorecharset) : priv(new qore_string_private) {
    priv->len = 0;
-   priv->allocated = STR_CLASS_BLOCK;
-   priv->buf = (char*)malloc(priv->allocated * sizeof(char));
+   priv->initBuffer(1);
    priv->buf[0] = '\0';
    priv->charset = new_qorecharset;
 }
 
 QoreString::QoreString(const char* str, qore_size_t size, const QoreEncoding* new_qorecharset) : priv(new qore_string_private) {
    priv->len = size;
-   priv->allocated = size + STR_CLASS_EXTRA;
-   priv->buf = (char*)malloc(sizeof(char) * priv->allocated);
+   priv->initBuffer(size < QORE_STRING_SSO_SIZE ? size + 1 : size + STR_CLASS_EXTRA);
    memcpy(priv->buf, str, size);
    priv->buf[size] = '\0';
    priv->charset = new_qorecharset;
@@ -1079,8 +1162,7 @@ QoreString::QoreString(const QoreString* str, qore_size_t size) : priv(new qore_
    if (size >= str->priv->len)
       size = str->priv->len;
    priv->len = size;
-   priv->allocated = size + STR_CLASS_EXTRA;
-   priv->buf = (char*)malloc(sizeof(char) * priv->allocated);
+   priv->initBuffer(size < QORE_STRING_SSO_SIZE ? size + 1 : size + STR_CLASS_EXTRA);
    if (size)
       memcpy(priv->buf, str->priv->buf, size);
    priv->buf[size] = '\0';
@@ -1089,25 +1171,21 @@ QoreString::QoreString(const QoreString* str, qore_size_t size) : priv(new qore_
 
 QoreString::QoreString(char c) : priv(new qore_string_private) {
    priv->len = 1;
-   priv->allocated = STR_CLASS_BLOCK;
-   priv->buf = (char*)malloc(sizeof(char) * priv->allocated);
+   priv->initBuffer(2);
    priv->buf[0] = c;
    priv->buf[1] = '\0';
    priv->charset = QCS_DEFAULT;
 }
 
 QoreString::QoreString(int64 i) : priv(new qore_string_private) {
-   priv->allocated = MAX_BIGINT_STRING_LEN + 1;
-   priv->buf = (char*)malloc(sizeof(char) * priv->allocated);
-   priv->len = ::snprintf(priv->buf, MAX_BIGINT_STRING_LEN, QLLD, i);
-   // terminate string just in case
-   priv->buf[MAX_BIGINT_STRING_LEN] = '\0';
+   // a 64-bit integer always fits in the inline buffer
+   priv->initBuffer(QORE_STRING_SSO_SIZE);
+   priv->len = ::snprintf(priv->buf, QORE_STRING_SSO_SIZE, QLLD, i);
    priv->charset = QCS_DEFAULT;
 }
 
 QoreString::QoreString(bool b) : priv(new qore_string_private) {
-   priv->allocated = 2;
-   priv->buf = (char*)malloc(sizeof(char) * priv->allocated);
+   priv->initBuffer(2);
    priv->buf[0] = b ? '1' : '0';
    priv->buf[1] = 0;
    priv->len = 1;
@@ -1115,9 +1193,9 @@ QoreString::QoreString(bool b) : priv(new qore_string_private) {
 }
 
 QoreString::QoreString(double f) : priv(new qore_string_private) {
-   priv->allocated = MAX_FLOAT_STRING_LEN + 1;
-   priv->buf = (char*)malloc(sizeof(char) * priv->allocated);
-   priv->len = ::snprintf(priv->buf, MAX_FLOAT_STRING_LEN, "%.9g", f);
+   // "%.9g" output always fits in the inline buffer
+   priv->initBuffer(QORE_STRING_SSO_SIZE);
+   priv->len = ::snprintf(priv->buf, QORE_STRING_SSO_SIZE, "%.9g", f);
    // snprintf() always terminates the string
    priv->charset = QCS_DEFAULT;
    // issue 1556: external modules that call setlocale() can change
@@ -1126,8 +1204,7 @@ QoreString::QoreString(double f) : priv(new qore_string_private) {
 }
 
 QoreString::QoreString(const DateTime *d) : priv(new qore_string_private) {
-   priv->allocated = 15;
-   priv->buf = (char*)malloc(sizeof(char) * priv->allocated);
+   priv->initBuffer(15);
 
    qore_tm info;
    d->getInfo(info);
@@ -1137,16 +1214,14 @@ QoreString::QoreString(const DateTime *d) : priv(new qore_string_private) {
 }
 
 QoreString::QoreString(const BinaryNode *b) : priv(new qore_string_private) {
-   priv->allocated = b->size() + (b->size() * 4) / 10 + 10; // estimate for base64 encoding
-   priv->buf = (char*)malloc(sizeof(char) * priv->allocated);
+   priv->initBuffer(b->size() + (b->size() * 4) / 10 + 10); // estimate for base64 encoding
    priv->len = 0;
    priv->charset = QCS_DEFAULT;
    concatBase64(b, -1);
 }
 
 QoreString::QoreString(const BinaryNode *b, qore_size_t maxlinelen) : priv(new qore_string_private) {
-   priv->allocated = b->size() + (b->size() * 4) / 10 + 10; // estimate for base64 encoding
-   priv->buf = (char*)malloc(sizeof(char) * priv->allocated);
+   priv->initBuffer(b->size() + (b->size() * 4) / 10 + 10); // estimate for base64 encoding
    priv->len = 0;
    priv->charset = QCS_DEFAULT;
    concatBase64(b, maxlinelen);
@@ -1385,8 +1460,7 @@ void QoreString::reserve(qore_size_t size) {
 }
 
 void QoreString::take(char* str) {
-   if (priv->buf)
-      free(priv->buf);
+   priv->freeBuffer();
    priv->buf = str;
    if (str) {
       priv->len = ::strlen(str);
@@ -1404,16 +1478,14 @@ void QoreString::take(char* str, const QoreEncoding* new_qorecharset) {
 }
 
 void QoreString::take(char* str, qore_size_t size) {
-   if (priv->buf)
-      free(priv->buf);
+   priv->freeBuffer();
    priv->buf = str;
    priv->len = size;
    priv->allocated = size + 1;
 }
 
 void QoreString::take(char* str, qore_size_t size, const QoreEncoding* enc) {
-   if (priv->buf)
-      free(priv->buf);
+   priv->freeBuffer();
    priv->buf = str;
    priv->len = size;
    priv->allocated = size + 1;
@@ -1422,8 +1494,7 @@ void QoreString::take(char* str, qore_size_t size, const QoreEncoding* enc) {
 }
 
 void QoreString::takeAndTerminate(char* str, qore_size_t size) {
-   if (priv->buf)
-      free(priv->buf);
+   priv->freeBuffer();
    priv->buf = str;
    priv->len = size;
    priv->allocated = size + 1;
@@ -1439,10 +1510,7 @@ void QoreString::takeAndTerminate(char* str, qore_size_t size, const QoreEncodin
 // NOTE: could be dangerous if we refer to the priv->buffer after this
 // call and it's NULL (the only way the priv->buffer can become NULL)
 char* QoreString::giveBuffer() {
-   char* rv = priv->buf;
-   priv->buf = 0;
-   priv->len = 0;
-   priv->allocated = 0;
+   char* rv = priv->giveBuffer();
    // reset character set, just in case the string will be reused
    // (normally not after this call)
    priv->charset = QCS_DEFAULT;
@@ -1457,11 +1525,12 @@ void QoreString::clear() {
 }
 
 void QoreString::reset() {
-   char* b = giveBuffer();
-   if (b)
-      free(b);
-   priv->check_char(0);
+   priv->freeBuffer();
+   priv->len = 0;
+   priv->initBuffer(1);
    priv->buf[0] = '\0';
+   // reset character set, just in case the string will be reused
+   priv->charset = QCS_DEFAULT;
 }
 
 void QoreString::set(const char* str, const QoreEncoding* new_qorecharset) {
@@ -1496,8 +1565,7 @@ void QoreString::set(const std::string& str, const QoreEncoding* ne) {
 }
 
 void QoreString::set(char* nbuf, size_t nlen, size_t nallocated, const QoreEncoding* enc) {
-   if (priv->buf)
-      free(priv->buf);
+   priv->freeBuffer();
 
    assert(nallocated >= nlen);
    priv->buf = nbuf;
@@ -1518,18 +1586,34 @@ void QoreString::replaceAll(const char* old_str, const char* new_str) {
    assert(old_str);
    assert(new_str);
 
-   int old_len = ::strlen(old_str);
-   int new_len = ::strlen(new_str);
+   size_t old_len = ::strlen(old_str);
+   if (!old_len || old_len > priv->len)
+      return;
+   size_t new_len = ::strlen(new_str);
+
+   // build the result in a single pass instead of splicing the string for each occurrence
+   QoreSubstringSearch search(old_str, old_len);
+   const char* p = priv->buf;
+   const char* end = priv->buf + priv->len;
+   const char* f = search.find(p, end - p);
+   if (!f)
+      return;
 
-   qore_offset_t start = 0;
-   while (true) {
-      qore_offset_t i = bindex(old_str, start);
-      if (i < 0)
-         break;
+   QoreString tmp(priv->getEncoding());
+   tmp.reserve(priv->len);
+   do {
+      if (f != p)
+         tmp.concat(p, f - p);
+      if (new_len)
+         tmp.concat(new_str, new_len);
+      p = f + old_len;
+   } while ((f = search.find(p, end - p)));
 
-      replace(i, old_len, new_str);
-      start = i + new_len;
-   }
+   if (p < end)
+      tmp.concat(p, end - p);
+
+   qore_size_t tlen = tmp.size();
+   take(tmp.giveBuffer(), tlen);
 }
 
 void QoreString::replace(qore_size_t offset, qore_size_t dlen, const char* str) {
@@ -2121,9 +2205,8 @@ void QoreString::concat(char c) {
 int QoreString::vsnprintf(size_t size, const char* fmt, va_list args) {
    // ensure minimum space is free
    if ((priv->allocated - priv->len) < (unsigned)size) {
-      priv->allocated += (size + STR_CLASS_EXTRA);
       // resize priv->buffer
-      priv->buf = (char*)realloc(priv->buf, priv->allocated * sizeof(char));
+      priv->reallocBuffer(priv->allocated + size + STR_CLASS_EXTRA);
    }
    // copy formatted string to priv->buffer
    int i = ::vsnprintf(priv->buf + priv->len, size, fmt, args);
@@ -56,6 +56,14 @@ QoreStringNode::~QoreStringNode() {
    //sset.del(this);
 }
 
+void* QoreStringNode::operator new(size_t size) {
+   return q_slab_alloc(size);
+}
+
+void QoreStringNode::operator delete(void* p, size_t size) {
+   q_slab_free(p, size);
+}
+
 QoreStringNode::QoreStringNode(const char *str, const QoreEncoding *enc) : SimpleValueQoreNode(NT_STRING), QoreString(str, enc) {
    //sset.add(this);
 }
@@ -0,0 +1,82 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    QoreSubstringSearch.cpp
+
+    byte-oriented substring search
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#include <qore/Qore.h>
+#include "qore/intern/QoreSubstringSearch.h"
+
+const char* QoreSubstringSearch::findSkip(const char* hay, size_t hlen) {
+    size_t last = nlen - 1;
+    if (!have_skip) {
+        // each byte shifts the window so that its last occurrence in the needle before the final byte is aligned
+        for (unsigned i = 0; i < 256; ++i)
+            skip[i] = nlen;
+        for (size_t i = 0; i < last; ++i)
+            skip[(unsigned char)needle[i]] = last - i;
+        have_skip = true;
+    }
+
+    unsigned char lc = (unsigned char)needle[last];
+    size_t end = hlen - nlen;
+    size_t i = 0;
+    while (i <= end) {
+        unsigned char c = (unsigned char)hay[i + last];
+        if (c == lc && !memcmp(hay + i, needle, last))
+            return hay + i;
+        i += skip[c];
+    }
+    return nullptr;
+}
+
+const char* QoreSubstringSearch::rfindSkip(const char* hay, size_t hlen) {
+    if (!have_rskip) {
+        // each byte shifts the window so that its first occurrence in the needle after the first byte is aligned
+        for (unsigned i = 0; i < 256; ++i)
+            rskip[i] = nlen;
+        for (size_t i = nlen - 1; i; --i)
+            rskip[(unsigned char)needle[i]] = i;
+        have_rskip = true;
+    }
+
+    unsigned char fc = (unsigned char)needle[0];
+    size_t i = hlen - nlen;
+    while (true) {
+        unsigned char c = (unsigned char)hay[i];
+        if (c == fc && !memcmp(hay + i + 1, needle + 1, nlen - 1))
+            return hay + i;
+        size_t s = rskip[c];
+        if (s > i)
+            break;
+        i -= s;
+    }
+    return nullptr;
+}
@@ -52,10 +52,11 @@
 
 #include <memory>
 #include <map>
+#include <algorithm>
 
 #define QB(x) ((x) ? "true" : "false")
 
-QoreZoneInfo::QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink *xsink) : AbstractQoreZoneInfo(n_name), first_pos(-1), valid(false), std_abbr(0) {
+QoreZoneInfo::QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink *xsink) : AbstractQoreZoneInfo(n_name), valid(false), std_abbr(0) {
    printd(5, "QoreZoneInfo::QoreZoneInfo() this: %p root: %s name: %s\n", this, root.getBuffer(), name.c_str());
 
    std::string fn = root.getBuffer();
@@ -77,12 +78,91 @@ QoreZoneInfo::QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink
       return;
    }
 
-   // skip 16 reserved bytes
+   // version: '\0' for version 1, '2' or higher for files with 64-bit data and a POSIX TZ footer
+   unsigned char version;
+   if (f.readu1(&version, xsink))
+      return;
+
+   // skip 15 reserved bytes
    if (f.setPos(20) != 20) {
       xsink->raiseErrnoException("TZINFO-ERROR", errno, "failed to position file at tzinfo header");
       return;
    }
 
+   bool v2 = version >= '2';
+   if (v2) {
+      // skip the version 1 data block, which is followed by a second header and the 64-bit data block
+      unsigned cnt[6];
+      for (unsigned i = 0; i < 6; ++i) {
+         if (f.readu4(&cnt[i], xsink))
+            return;
+      }
+      // the version 1 data block has 4-byte transition times and 8-byte leap second records
+      qore_size_t pos = 44 + cnt[3] * 5 + cnt[4] * 6 + cnt[5] + cnt[2] * 8 + cnt[1] + cnt[0];
+      if (f.setPos(pos) != pos) {
+         xsink->raiseErrnoException("TZINFO-ERROR", errno, "failed to position file at version 2 tzinfo header");
+         return;
+      }
+
+      if (f.read(str, 4, xsink))
+         return;
+
+      if (strcmp("TZif", str.getBuffer())) {
+         xsink->raiseException("TZINFO-ERROR", "%s: invalid version 2 header magic", fn.c_str());
+         return;
+      }
+
+      pos += 20;
+      if (f.setPos(pos) != pos) {
+         xsink->raiseErrnoException("TZINFO-ERROR", errno, "failed to position file at version 2 tzinfo header");
+         return;
+      }
+   }
+
+   if (readData(f, v2, xsink))
+      return;
+
+   if (v2)
+      readFooter(f, fn);
+
+   // scan time bands from the end to get the default UTC offset for this zone
+   // if we start from the first, we'll get some historical offset which may be different than the modern offset
+   {
+      unsigned i = tti.size();
+      while (i) {
+         --i;
+         if (utcoff == -1 && !tti[i].isdst && tti[i].utcoff != -1) {
+            utcoff = tti[i].utcoff;
+            //printd(5, "QoreZoneInfo::QoreZoneInfo() tti[%d] %s: utcoff: %d isdst: %s isstd: %s isutc: %s\n", i, tti[i].abbr.c_str(), tti[i].utcoff, QB(tti[i].isdst), QB(tti[i].isstd), QB(tti[i].isutc));
+            break;
+         }
+      }
+   }
+
+   // times before the first transition use the default UTC offset and the first standard time abbreviation
+   std_info.utcoff = utcoff;
+   std_info.abbr = std_abbr ? std_abbr : "";
+   std_info.isdst = false;
+   std_info.isstd = false;
+   std_info.isutc = false;
+
+#if 0
+   for (unsigned i = 0, e = QoreDSTTransitions.size(); i < e; ++i) {
+      DateTime d(QoreDSTTransitions[i].time);
+      str.clear();
+      d.format(str, "Dy Mon DD YYYY HH:mm:SS");
+      QoreTransitionInfo &trans = *QoreDSTTransitions[i].trans;
+      DateTime local(d.getEpochSeconds() + trans.utcoff);
+      QoreString lstr;
+      local.format(lstr, "Dy Mon DD YYYY HH:mm:SS");
+      printd(0, "QoreZoneInfo::QoreZoneInfo() trans[%3d] time: " QLLD " %s UTC = %s %s isdst: %d isstd: %d isutc: %d utcoff: %d\n", i, QoreDSTTransitions[i].time, str.getBuffer(), lstr.getBuffer(), trans.abbr.c_str(), trans.isdst, trans.isstd, trans.isutc, trans.utcoff);
+   }
+#endif
+
+   valid = true;
+}
+
+int QoreZoneInfo::readData(QoreFile& f, bool v2, ExceptionSink* xsink) {
    // file header variables
    unsigned tzh_ttisutccnt,  // The number of UTC/local indicators stored in the file
       tzh_ttisstdcnt,        // The number of standard/wall indicators stored in the file
@@ -93,40 +173,45 @@ QoreZoneInfo::QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink
 
    // read in header count variables
    if (f.readu4(&tzh_ttisutccnt, xsink))
-      return;
+      return -1;
 
    if (f.readu4(&tzh_ttisstdcnt, xsink))
-      return;
+      return -1;
 
    if (f.readu4(&tzh_leapcnt, xsink))
-      return;
+      return -1;
 
    if (f.readu4(&tzh_timecnt, xsink))
-      return;
+      return -1;
 
    if (f.readu4(&tzh_typecnt, xsink))
-      return;
+      return -1;
 
    if (f.readu4(&tzh_charcnt, xsink))
-      return;
+      return -1;
 
-   printd(5, "QoreZoneInfo::QoreZoneInfo() tzh_ttisutccnt: %d tzh_ttisstdcnt: %d tzh_leapcnt: %d tzh_timecnt: %d tzh_typecnt: %d tzh_charcnt: %d\n", tzh_ttisutccnt, tzh_ttisstdcnt, tzh_leapcnt, tzh_timecnt, tzh_typecnt, tzh_charcnt);
+   printd(5, "QoreZoneInfo::readData() v2: %d tzh_ttisutccnt: %d tzh_ttisstdcnt: %d tzh_leapcnt: %d tzh_timecnt: %d tzh_typecnt: %d tzh_charcnt: %d\n", v2, tzh_ttisutccnt, tzh_ttisstdcnt, tzh_leapcnt, tzh_timecnt, tzh_typecnt, tzh_charcnt);
 
    if (tzh_ttisutccnt > tzh_typecnt) {
       xsink->raiseException("TZINFO-ERROR", "tzh_ttisutccnt (%d) > tzh_typecnt (%d)", tzh_ttisutccnt, tzh_typecnt);
-      return;
+      return -1;
    }
 
    QoreDSTTransitions.resize(tzh_timecnt);
 
-   // read in QoreDSTTransition time values
+   // read in QoreDSTTransition time values; version 2+ data blocks have 64-bit times
    for (unsigned i = 0; i < tzh_timecnt; ++i) {
-      if (f.readi4(&QoreDSTTransitions[i].time, xsink))
-	 return;
-
-      if (first_pos == -1 && QoreDSTTransitions[i].time >= 0)
-         first_pos = i;
-      //printd(5, "QoreZoneInfo::QoreZoneInfo() trans_time[%d]: %u\n", i, QoreDSTTransitions[i].time);
+      if (v2) {
+         if (f.readi8(&QoreDSTTransitions[i].time, xsink))
+            return -1;
+      }
+      else {
+         int t;
+         if (f.readi4(&t, xsink))
+            return -1;
+         QoreDSTTransitions[i].time = t;
+      }
+      //printd(5, "QoreZoneInfo::readData() trans_time[%d]: %lld\n", i, QoreDSTTransitions[i].time);
    }
 
    // for QoreDSTTransition type pointers
@@ -136,12 +221,12 @@ QoreZoneInfo::QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink
    // read in QoreDSTTransition type array
    for (unsigned i = 0; i < tzh_timecnt; ++i) {
       if (f.readu1(&trans_type[i], xsink))
-	 return;
+	 return -1;
       if (trans_type[i] >= tzh_typecnt) {
 	 xsink->raiseException("TZINFO-ERROR", "QoreDSTTransition type index %d (%d) is greater than tzh_typecnt (%d)", i, trans_type[i], tzh_typecnt);
-	 return;
+	 return -1;
       }
-      //printd(5, "QoreZoneInfo::QoreZoneInfo() trans_type[%d]: %d\n", i, trans_type[i]);
+      //printd(5, "QoreZoneInfo::readData() trans_type[%d]: %d\n", i, trans_type[i]);
    }
 
    // allocate QoreTransitionInfo array
@@ -154,20 +239,20 @@ QoreZoneInfo::QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink
    // read in QoreTransitionInfo data
    for (unsigned i = 0; i < tzh_typecnt; ++i) {
       if (f.readi4(&tti[i].utcoff, xsink))
-	 return;
+	 return -1;
 
-      //printd(5, "QoreZoneInfo::QoreZoneInfo() utcoff: %d\n", tti[i].utcoff);
+      //printd(5, "QoreZoneInfo::readData() utcoff: %d\n", tti[i].utcoff);
 
       unsigned char c;
       if (f.readu1(&c, xsink))
-	 return;
+	 return -1;
 
       tti[i].isdst = c;
       if (c && !has_dst)
          has_dst = true;
 
       if (f.readu1(&c, xsink))
-	 return;
+	 return -1;
 
       ai.push_back(c);
    }
@@ -183,11 +268,9 @@ QoreZoneInfo::QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink
             --prev;
             if (t.trans->utcoff == prev->trans->utcoff) {
                // invalid transition found
-               printd(1, "QoreZoneInfo::QoreZoneInfo() skipping invalid transition [%d] at %d\n", i, t.time);
+               printd(1, "QoreZoneInfo::readData() skipping invalid transition [%d] at " QLLD "\n", i, t.time);
                QoreDSTTransitions.erase(di);
                di = prev;
-               if ((int)i < first_pos)
-                 --first_pos;
             }
          }
          ++di;
@@ -195,8 +278,9 @@ QoreZoneInfo::QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink
    }
 
    // read in abbreviation list
+   QoreString str;
    if (f.read(str, tzh_charcnt, xsink))
-      return;
+      return -1;
 
    // set abbreviations
    for (unsigned i = 0; i < tzh_typecnt; ++i) {
@@ -205,19 +289,28 @@ QoreZoneInfo::QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink
          std_abbr = tti[i].abbr.c_str();
    }
 
-   // read in leap info
+   // read in leap info; version 2+ data blocks have 64-bit times
    leapinfo.resize(tzh_leapcnt);
    for (unsigned i = 0; i < tzh_leapcnt; ++i) {
-      if (f.readi4(&leapinfo[i].ttime, xsink)
-	  || f.readi4(&leapinfo[i].total, xsink))
-	 return;
+      if (v2) {
+         if (f.readi8(&leapinfo[i].ttime, xsink))
+            return -1;
+      }
+      else {
+         int t;
+         if (f.readi4(&t, xsink))
+            return -1;
+         leapinfo[i].ttime = t;
+      }
+      if (f.readi4(&leapinfo[i].total, xsink))
+	 return -1;
    }
 
    // read in std indicator array
    for (unsigned i = 0; i < tzh_ttisstdcnt; ++i) {
       unsigned char c;
       if (f.readu1(&c, xsink))
-	 return;
+	 return -1;
 
       tti[i].isstd = c;
    }
@@ -230,7 +323,7 @@ QoreZoneInfo::QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink
    for (unsigned i = 0; i < tzh_ttisutccnt; ++i) {
       unsigned char c;
       if (f.readu1(&c, xsink))
-	 return;
+	 return -1;
 
       tti[i].isutc = c;
    }
@@ -239,34 +332,40 @@ QoreZoneInfo::QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink
    for (unsigned i = tzh_ttisutccnt; i < tzh_typecnt; ++i)
       tti[i].isutc = false;
 
-   // scan time bands from the end to get the default UTC offset for this zone
-   // if we start from the first, we'll get some historical offset which may be different than the modern offset
-   {
-      unsigned i = tzh_typecnt;
-      while (i) {
-         --i;
-         if (utcoff == -1 && !tti[i].isdst && tti[i].utcoff != -1) {
-            utcoff = tti[i].utcoff;
-            //printd(5, "QoreZoneInfo::QoreZoneInfo() tti[%d] %s: utcoff: %d isdst: %s isstd: %s isutc: %s\n", i, tti[i].abbr.c_str(), tti[i].utcoff, QB(tti[i].isdst), QB(tti[i].isstd), QB(tti[i].isutc));
-            break;
-         }
+   return 0;
+}
+
+void QoreZoneInfo::readFooter(QoreFile& f, const std::string& fn) {
+   // the footer is a POSIX TZ string enclosed in newlines; a missing or invalid footer is ignored
+   ExceptionSink xsink;
+   unsigned char c;
+   if (f.readu1(&c, &xsink) || c != '\n') {
+      xsink.clear();
+      return;
+   }
+
+   std::string tz;
+   while (true) {
+      if (f.readu1(&c, &xsink)) {
+         xsink.clear();
+         return;
       }
+      if (c == '\n')
+         break;
+      tz += c;
    }
 
-#if 0
-   for (unsigned i = 0, e = QoreDSTTransitions.size(); i < e; ++i) {
-      DateTime d((int64)QoreDSTTransitions[i].time);
-      str.clear();
-      d.format(str, "Dy Mon DD YYYY HH:mm:SS");
-      QoreTransitionInfo &trans = *QoreDSTTransitions[i].trans;
-      DateTime local(d.getEpochSeconds() + trans.utcoff);
-      QoreString lstr;
-      local.format(lstr, "Dy Mon DD YYYY HH:mm:SS");
-      printd(0, "QoreZoneInfo::QoreZoneInfo() trans[%3d] time: %d %s UTC = %s %s isdst: %d isstd: %d isutc: %d utcoff: %d\n", i, QoreDSTTransitions[i].time, str.getBuffer(), lstr.getBuffer(), trans.abbr.c_str(), trans.isdst, trans.isstd, trans.isutc, trans.utcoff);
+   if (tz.empty())
+      return;
+
+   std::unique_ptr<QorePosixTZRule> r(new QorePosixTZRule);
+   if (r->parse(tz.c_str())) {
+      printd(1, "QoreZoneInfo::readFooter() %s: ignoring invalid POSIX TZ rule '%s'\n", fn.c_str(), tz.c_str());
+      return;
    }
-#endif
 
-   valid = true;
+   printd(5, "QoreZoneInfo::readFooter() %s: POSIX TZ rule '%s'\n", fn.c_str(), tz.c_str());
+   rule = std::move(r);
 }
 
 int QoreTimeZoneManager::process(const char *fn) {
@@ -343,49 +442,294 @@ int QoreTimeZoneManager::processIntern(const char *fn, ExceptionSink *xsink) {
    return processFile(fn, false, xsink) ? 0 : -1;
 }
 
-int QoreZoneInfo::getUTCOffsetImpl(int64 epoch_offset, bool &is_dst, const char *&zone_name) const {
-   //printf("QoreZoneInfo::getUTCOffsetImpl() epoch_offset: %lld first_pos: %d time: %lld\n", epoch_offset, first_pos, first_pos > 0 ? QoreDSTTransitions[first_pos - 1].time : -1ll);
-   unsigned i = 0;
-   if (first_pos > 0 && epoch_offset >= QoreDSTTransitions[first_pos - 1].time) {
-      i = first_pos - 1;
-      unsigned end = QoreDSTTransitions.size() - 1;
-      while (i < end) {
-         if (QoreDSTTransitions[i].time <= epoch_offset && QoreDSTTransitions[i + 1].time > epoch_offset) {
-            zone_name = QoreDSTTransitions[i].trans->abbr.c_str();
-            is_dst = QoreDSTTransitions[i].trans->isdst;
-
-            //printf("QoreZoneInfo::getUTCOffsetImpl(epoch: %lld) tt[<=]: %d tt[>]: %d zone_name: %s is_dst: %d utcoff: %d\n", epoch_offset, QoreDSTTransitions[i].time, QoreDSTTransitions[i + 1].time, zone_name, is_dst, QoreDSTTransitions[i].trans->utcoff);
-            return QoreDSTTransitions[i].trans->utcoff;
-         }
-         ++i;
+// parses a time zone abbreviation in a POSIX TZ rule: either at least 3 letters or a quoted string: "<+03>"
+static int tz_parse_name(const char*& p, std::string& name) {
+   if (*p == '<') {
+      const char* e = strchr(p + 1, '>');
+      if (!e)
+         return -1;
+      name.assign(p + 1, e - p - 1);
+      p = e + 1;
+   }
+   else {
+      const char* s = p;
+      while (isalpha(*p))
+         ++p;
+      name.assign(s, p - s);
+   }
+   return name.size() < 3 ? -1 : 0;
+}
+
+// parses an unsigned decimal number in the given range
+static int tz_parse_int(const char*& p, int& val, int min, int max) {
+   if (!isdigit(*p))
+      return -1;
+   val = 0;
+   while (isdigit(*p)) {
+      val = val * 10 + (*p - '0');
+      if (val > max)
+         return -1;
+      ++p;
+   }
+   return val < min ? -1 : 0;
+}
+
+// parses a time in a POSIX TZ rule: [+|-]hh[:mm[:ss]] and returns the value in seconds
+static int tz_parse_time(const char*& p, int& secs) {
+   int sign = 1;
+   if (*p == '+')
+      ++p;
+   else if (*p == '-') {
+      sign = -1;
+      ++p;
+   }
+
+   int h, m = 0, s = 0;
+   if (tz_parse_int(p, h, 0, 167))
+      return -1;
+   if (*p == ':') {
+      ++p;
+      if (tz_parse_int(p, m, 0, 59))
+         return -1;
+      if (*p == ':') {
+         ++p;
+         if (tz_parse_int(p, s, 0, 59))
+            return -1;
       }
-      // not found, time zone unknown
-      is_dst = false;
-      zone_name = std_abbr;
+   }
+
+   secs = sign * (h * SECS_PER_HOUR + m * SECS_PER_MINUTE + s);
+   return 0;
+}
+
+// parses a transition date in a POSIX TZ rule: "Jn", "n" or "Mm.w.d" followed by an optional "/time"
+static int tz_parse_date(const char*& p, QorePosixTZDate& d) {
+   if (*p == 'M') {
+      ++p;
+      d.type = 'M';
+      if (tz_parse_int(p, d.month, 1, 12) || *p++ != '.'
+          || tz_parse_int(p, d.week, 1, 5) || *p++ != '.'
+          || tz_parse_int(p, d.day, 0, 6))
+         return -1;
+   }
+   else if (*p == 'J') {
+      ++p;
+      d.type = 'J';
+      if (tz_parse_int(p, d.day, 1, 365))
+         return -1;
+   }
+   else {
+      d.type = 'D';
+      if (tz_parse_int(p, d.day, 0, 365))
+         return -1;
+   }
+
+   // the default transition time is 02:00:00 local time
+   if (*p != '/') {
+      d.time = 2 * SECS_PER_HOUR;
+      return 0;
+   }
+   ++p;
+   return tz_parse_time(p, d.time);
+}
+
+// returns the transition time in seconds from the epoch for the given year in the local time of the transition
+static int64 tz_get_date(const QorePosixTZDate& d, int year) {
+   int64 days;
+   switch (d.type) {
+      case 'J':
+         // Feb 29 is never counted, so day 60 is always Mar 1
+         days = d.day - 1;
+         if (d.day >= 60 && qore_date_info::isLeapYear(year))
+            ++days;
+         break;
+
+      case 'D':
+         days = d.day;
+         break;
+
+      default: {
+         // find the first matching day of the week in the month, then add the weeks; week 5 is the last week
+         int wday = qore_date_info::getDayOfWeek(year, d.month, 1);
+         int mday = 1 + (d.day - wday + 7) % 7 + (d.week - 1) * 7;
+         int last = qore_date_info::getLastDayOfMonth(d.month, year);
+         while (mday > last)
+            mday -= 7;
+         return qore_date_info::getEpochSeconds(year, d.month, mday) + d.time;
+      }
+   }
+   return qore_date_info::getEpochSeconds(year, 1, 1) + days * SECS_PER_DAY + d.time;
+}
+
+int QorePosixTZRule::parse(const char* p) {
+   int off;
+   if (tz_parse_name(p, std_info.abbr) || tz_parse_time(p, off))
+      return -1;
+
+   // POSIX TZ offsets are positive west of Greenwich
+   std_info.utcoff = -off;
+   std_info.isdst = false;
+   std_info.isstd = false;
+   std_info.isutc = false;
+
+   has_dst = *p;
+   if (!has_dst)
+      return 0;
+
+   if (tz_parse_name(p, dst_info.abbr))
+      return -1;
+
+   // the default DST offset is one hour ahead of standard time
+   if (*p && *p != ',') {
+      if (tz_parse_time(p, off))
+         return -1;
+      dst_info.utcoff = -off;
+   }
+   else
+      dst_info.utcoff = std_info.utcoff + SECS_PER_HOUR;
+   dst_info.isdst = true;
+   dst_info.isstd = false;
+   dst_info.isutc = false;
 
-      //printf("QoreZoneInfo::getUTCOffsetImpl(epoch: %lld) NOT FOUND zone_name: %s is_dst: %d utcoff: %d\n", epoch_offset, zone_name, is_dst, utcoff);
+   // use the POSIX default (US) rules if no rule is given
+   if (!*p)
+      p = ",M3.2.0,M11.1.0";
 
-      return utcoff;
+   if (*p++ != ',' || tz_parse_date(p, start) || *p++ != ',' || tz_parse_date(p, end) || *p)
+      return -1;
+
+   return 0;
+}
+
+void QorePosixTZRule::getTransitions(int year, int64& dst_start, int64& dst_end) const {
+   // DST starts in local standard time and ends in local daylight savings time
+   dst_start = tz_get_date(start, year) - std_info.utcoff;
+   dst_end = tz_get_date(end, year) - dst_info.utcoff;
+}
+
+const QoreTransitionInfo* QorePosixTZRule::get(int64 epoch_offset) const {
+   if (!has_dst)
+      return &std_info;
+
+   // get the transitions for the year in local standard time
+   qore_simple_tm tm;
+   tm.set(epoch_offset + std_info.utcoff, 0);
+   int64 dst_start, dst_end;
+   getTransitions(tm.year, dst_start, dst_end);
+
+   // northern hemisphere: DST is in the middle of the year
+   if (dst_start < dst_end)
+      return epoch_offset >= dst_start && epoch_offset < dst_end ? &dst_info : &std_info;
+   // southern hemisphere: DST spans the new year
+   return epoch_offset >= dst_end && epoch_offset < dst_start ? &std_info : &dst_info;
+}
+
+#define QORE_TZ_CACHE_ZONES 4
+#define QORE_TZ_CACHE_TRANS 4
+
+// per-thread cache of the transitions in one UTC year for a time zone
+struct qore_tz_year_cache {
+   const QoreZoneInfo* zone = nullptr;
+   // the cached year in seconds from the epoch: [start, end)
+   int64 start = 0,
+      end = 0;
+   // the number of transitions in the year
+   unsigned n = 0;
+   // transition times
+   int64 time[QORE_TZ_CACHE_TRANS];
+   // info[0] applies from the start of the year, info[i] from time[i - 1]
+   const QoreTransitionInfo* info[QORE_TZ_CACHE_TRANS + 1];
+
+   DLLLOCAL const QoreTransitionInfo* get(int64 epoch_offset) const {
+      unsigned i = 0;
+      while (i < n && epoch_offset >= time[i])
+         ++i;
+      return info[i];
    }
+};
 
-   i = first_pos + 1;
-   while (i > 0) {
-      if (QoreDSTTransitions[i].time > epoch_offset && QoreDSTTransitions[i - 1].time <= epoch_offset) {
-         zone_name = QoreDSTTransitions[i].trans->abbr.c_str();
-         is_dst = QoreDSTTransitions[i].trans->isdst;
+// a few zones are cached per thread so that code converting between zones does not thrash the cache
+static thread_local qore_tz_year_cache tz_year_cache[QORE_TZ_CACHE_ZONES];
 
-         //printf("QoreZoneInfo::getUTCOffsetImpl(epoch: %lld) i: %d tt[<=]: %d tt[>]: %d zone_name: %s is_dst: %d utcoff: %d\n", epoch_offset, i, QoreDSTTransitions[i].time, QoreDSTTransitions[i + 1].time, zone_name, is_dst, QoreDSTTransitions[i].trans->utcoff);
-         return QoreDSTTransitions[i].trans->utcoff;
+static qore_tz_year_cache& tz_get_year_cache(const QoreZoneInfo* zone) {
+   return tz_year_cache[((uintptr_t)zone / sizeof(QoreZoneInfo)) % QORE_TZ_CACHE_ZONES];
+}
+
+const QoreTransitionInfo* QoreZoneInfo::getTransitionInfo(int64 epoch_offset) const {
+   // find the first transition after the given time
+   dst_transition_vec_t::const_iterator i = std::upper_bound(QoreDSTTransitions.begin(), QoreDSTTransitions.end(),
+      epoch_offset, [] (int64 e, const QoreDSTTransition& trans) -> bool { return e < trans.time; });
+
+   // times after the last transition use the POSIX TZ rule, if any
+   if (i == QoreDSTTransitions.end() && rule)
+      return rule->get(epoch_offset);
+
+   // times before the first transition use standard time
+   if (i == QoreDSTTransitions.begin())
+      return &std_info;
+
+   return (--i)->trans;
+}
+
+const QoreTransitionInfo* QoreZoneInfo::cacheYear(int64 epoch_offset) const {
+   qore_simple_tm tm;
+   tm.set(epoch_offset, 0);
+   int64 start = qore_date_info::getEpochSeconds(tm.year, 1, 1);
+   int64 end = qore_date_info::getEpochSeconds(tm.year + 1, 1, 1);
+
+   // collect all transition times in the year; the rule can add up to two transitions per local year
+   int64 t[QORE_TZ_CACHE_TRANS + 6];
+   unsigned n = 0;
+
+   dst_transition_vec_t::const_iterator i = std::upper_bound(QoreDSTTransitions.begin(), QoreDSTTransitions.end(),
+      start, [] (int64 e, const QoreDSTTransition& trans) -> bool { return e < trans.time; });
+   for (; i != QoreDSTTransitions.end() && i->time < end; ++i) {
+      // do not cache years with many transitions
+      if (n == QORE_TZ_CACHE_TRANS)
+         return getTransitionInfo(epoch_offset);
+      t[n++] = i->time;
+   }
+
+   if (rule && rule->has_dst && (QoreDSTTransitions.empty() || QoreDSTTransitions.back().time < end)) {
+      int64 after = QoreDSTTransitions.empty() ? start : std::max(start, QoreDSTTransitions.back().time);
+      // the local year can differ from the UTC year around the new year
+      for (int year = tm.year - 1; year <= tm.year + 1; ++year) {
+         int64 dst_start, dst_end;
+         rule->getTransitions(year, dst_start, dst_end);
+         if (dst_start > after && dst_start < end)
+            t[n++] = dst_start;
+         if (dst_end > after && dst_end < end)
+            t[n++] = dst_end;
       }
-      --i;
+      std::sort(t, t + n);
+      n = std::unique(t, t + n) - t;
+      if (n > QORE_TZ_CACHE_TRANS)
+         return getTransitionInfo(epoch_offset);
    }
-   // not found, time zone unknown
-   is_dst = false;
-   zone_name = std_abbr;
 
-   //printf("QoreZoneInfo::getUTCOffsetImpl(epoch: %lld) NOT FOUND zone_name: %s is_dst: %d utcoff: %d\n", epoch_offset, zone_name, is_dst, utcoff);
+   qore_tz_year_cache& c = tz_get_year_cache(this);
+   c.zone = this;
+   c.start = start;
+   c.end = end;
+   c.n = n;
+   c.info[0] = getTransitionInfo(start);
+   for (unsigned j = 0; j < n; ++j) {
+      c.time[j] = t[j];
+      c.info[j + 1] = getTransitionInfo(t[j]);
+   }
+   return c.get(epoch_offset);
+}
 
-   return utcoff;
+int QoreZoneInfo::getUTCOffsetImpl(int64 epoch_offset, bool &is_dst, const char *&zone_name) const {
+   const qore_tz_year_cache& c = tz_get_year_cache(this);
+   const QoreTransitionInfo* trans = (c.zone == this && epoch_offset >= c.start && epoch_offset < c.end)
+      ? c.get(epoch_offset)
+      : cacheYear(epoch_offset);
+
+   zone_name = trans->abbr.c_str();
+   is_dst = trans->isdst;
+   //printf("QoreZoneInfo::getUTCOffsetImpl(epoch: %lld) zone_name: %s is_dst: %d utcoff: %d\n", epoch_offset, zone_name, is_dst, trans->utcoff);
+   return trans->utcoff;
 }
 
 // format: S00[[:]00[[:]00]] (S is + or -)
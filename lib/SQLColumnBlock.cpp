@@ -0,0 +1,435 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+    SQLColumnBlock.cpp
+
+    Qore Programming Language
+
+    Copyright (C) 2003 - 2018 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+    Note that the Qore library is released under a choice of three open-source
+    licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+    information.
+*/
+
+#include <qore/Qore.h>
+#include "qore/intern/QC_SQLColumnBlock.h"
+#include "qore/intern/QoreHashNodeIntern.h"
+
+void sql_column_block_column::reserve(size_t rows) {
+    nulls.reserve(rows);
+    switch (type) {
+        case SQL_COL_INT:
+        case SQL_COL_BOOL:
+            ival.reserve(rows);
+            break;
+        case SQL_COL_FLOAT:
+            fval.reserve(rows);
+            break;
+        case SQL_COL_DATE:
+            ival.reserve(rows);
+            us.reserve(rows);
+            zone.reserve(rows);
+            break;
+        case SQL_COL_STRING:
+            offset.reserve(rows);
+            break;
+        case SQL_COL_ANY:
+            val.reserve(rows);
+            break;
+    }
+}
+
+void sql_column_block_column::appendNull() {
+    // keep the value buffers aligned with the row index
+    switch (type) {
+        case SQL_COL_INT:
+        case SQL_COL_BOOL:
+            ival.push_back(0);
+            break;
+        case SQL_COL_FLOAT:
+            fval.push_back(0.0);
+            break;
+        case SQL_COL_DATE:
+            ival.push_back(0);
+            us.push_back(0);
+            zone.push_back(nullptr);
+            break;
+        case SQL_COL_STRING:
+            offset.push_back(arena.size());
+            break;
+        case SQL_COL_ANY:
+            val.push_back(QoreValue());
+            break;
+    }
+    nulls.push_back(true);
+}
+
+QoreValue sql_column_block_column::get(size_t row) const {
+    assert(row < size());
+    if (nulls[row])
+        return null();
+
+    switch (type) {
+        case SQL_COL_INT:
+            return ival[row];
+        case SQL_COL_FLOAT:
+            return fval[row];
+        case SQL_COL_BOOL:
+            return (bool)ival[row];
+        case SQL_COL_DATE:
+            return DateTimeNode::makeAbsolute(zone[row], ival[row], us[row]);
+        case SQL_COL_STRING: {
+            size_t start = row ? offset[row - 1] : 0;
+            return new QoreStringNode(arena.data() + start, offset[row] - start, enc);
+        }
+        case SQL_COL_ANY:
+            return val[row].refSelf();
+    }
+    assert(false);
+    return QoreValue();
+}
+
+QoreListNode* sql_column_block_column::getList() const {
+    ReferenceHolder<QoreListNode> rv(new QoreListNode(autoTypeInfo), nullptr);
+    for (size_t i = 0, e = size(); i < e; ++i) {
+        rv->push(get(i), nullptr);
+    }
+    return rv.release();
+}
+
+void sql_column_block_column::clear(ExceptionSink* xsink) {
+    for (auto& i : val) {
+        i.discard(xsink);
+    }
+    val.clear();
+}
+
+void sql_column_block_private::clear(ExceptionSink* xsink) {
+    for (auto& i : cols) {
+        i->clear(xsink);
+        delete i;
+    }
+    cols.clear();
+    cmap.clear();
+}
+
+SQLColumnBlock::SQLColumnBlock() : priv(new sql_column_block_private) {
+}
+
+SQLColumnBlock::~SQLColumnBlock() {
+    delete priv;
+}
+
+int SQLColumnBlock::addColumn(const char* name, sql_column_type_e type, const QoreEncoding* enc, ExceptionSink* xsink) {
+    if (priv->find(name) >= 0) {
+        xsink->raiseException("DBI-FETCH-BLOCK-ERROR", "column '%s' is defined more than once", name);
+        return -1;
+    }
+    // columns must be defined before any rows are added
+    assert(!priv->size());
+    unsigned rv = priv->cols.size();
+    priv->cols.push_back(new sql_column_block_column(name, type, enc ? enc : QCS_DEFAULT));
+    priv->cmap[name] = rv;
+    return (int)rv;
+}
+
+unsigned SQLColumnBlock::columnCount() const {
+    return priv->cols.size();
+}
+
+size_t SQLColumnBlock::size() const {
+    return priv->size();
+}
+
+void SQLColumnBlock::reserve(size_t rows) {
+    for (auto& i : priv->cols) {
+        i->reserve(rows);
+    }
+}
+
+void SQLColumnBlock::appendNull(unsigned col) {
+    assert(col < priv->cols.size());
+    priv->cols[col]->appendNull();
+}
+
+void SQLColumnBlock::appendInt(unsigned col, int64 v) {
+    assert(col < priv->cols.size());
+    sql_column_block_column& c = *priv->cols[col];
+    assert(c.type == SQL_COL_INT);
+    c.ival.push_back(v);
+    c.nulls.push_back(false);
+}
+
+void SQLColumnBlock::appendFloat(unsigned col, double v) {
+    assert(col < priv->cols.size());
+    sql_column_block_column& c = *priv->cols[col];
+    assert(c.type == SQL_COL_FLOAT);
+    c.fval.push_back(v);
+    c.nulls.push_back(false);
+}
+
+void SQLColumnBlock::appendBool(unsigned col, bool v) {
+    assert(col < priv->cols.size());
+    sql_column_block_column& c = *priv->cols[col];
+    assert(c.type == SQL_COL_BOOL);
+    c.ival.push_back(v);
+    c.nulls.push_back(false);
+}
+
+void SQLColumnBlock::appendDate(unsigned col, int64 seconds, int us, const AbstractQoreZoneInfo* zone) {
+    assert(col < priv->cols.size());
+    sql_column_block_column& c = *priv->cols[col];
+    assert(c.type == SQL_COL_DATE);
+    c.ival.push_back(seconds);
+    c.us.push_back(us);
+    c.zone.push_back(zone);
+    c.nulls.push_back(false);
+}
+
+void SQLColumnBlock::appendString(unsigned col, const char* str, size_t len) {
+    assert(col < priv->cols.size());
+    sql_column_block_column& c = *priv->cols[col];
+    assert(c.type == SQL_COL_STRING);
+    c.arena.append(str, len);
+    c.offset.push_back(c.arena.size());
+    c.nulls.push_back(false);
+}
+
+void SQLColumnBlock::appendValue(unsigned col, QoreValue v) {
+    assert(col < priv->cols.size());
+    sql_column_block_column& c = *priv->cols[col];
+    assert(c.type == SQL_COL_ANY);
+    c.val.push_back(v);
+    c.nulls.push_back(false);
+}
+
+void SQLColumnBlock::clear(ExceptionSink* xsink) {
+    priv->clear(xsink);
+}
+
+// returns the storage type for a list of values; values must all have the same type to be stored in a typed column
+static sql_column_type_e get_column_type(const QoreListNode* l, const QoreEncoding*& enc) {
+    int rv = -1;
+    enc = QCS_DEFAULT;
+    ConstListIterator li(l);
+    while (li.next()) {
+        const QoreValue v = li.getValue();
+        sql_column_type_e t;
+        switch (v.getType()) {
+            case NT_NULL:
+                continue;
+            case NT_INT:
+                t = SQL_COL_INT;
+                break;
+            case NT_FLOAT:
+                t = SQL_COL_FLOAT;
+                break;
+            case NT_BOOLEAN:
+                t = SQL_COL_BOOL;
+                break;
+            case NT_DATE:
+                if (v.get<const DateTimeNode>()->isRelative())
+                    return SQL_COL_ANY;
+                t = SQL_COL_DATE;
+                break;
+            case NT_STRING: {
+                const QoreEncoding* e = v.get<const QoreStringNode>()->getEncoding();
+                if (rv == -1)
+                    enc = e;
+                else if (e != enc)
+                    return SQL_COL_ANY;
+                t = SQL_COL_STRING;
+                break;
+            }
+            default:
+                return SQL_COL_ANY;
+        }
+        if (rv == -1)
+            rv = t;
+        else if (rv != t)
+            return SQL_COL_ANY;
+    }
+    return rv == -1 ? SQL_COL_ANY : (sql_column_type_e)rv;
+}
+
+QoreSQLColumnBlock* QoreSQLColumnBlock::fromColumns(const QoreHashNode* h, ExceptionSink* xsink) {
+    ReferenceHolder<QoreSQLColumnBlock> rv(new QoreSQLColumnBlock, xsink);
+
+    ConstHashIterator hi(h);
+    while (hi.next()) {
+        const QoreValue v = hi.get();
+        if (v.getType() != NT_LIST) {
+            xsink->raiseException("SQLCOLUMNBLOCK-ERROR", "column '%s' has type '%s'; expecting 'list'", hi.getKey(),
+                v.getTypeName());
+            return nullptr;
+        }
+        const QoreListNode* l = v.get<const QoreListNode>();
+        if (rv->priv->cols.size() && l->size() != rv->size()) {
+            xsink->raiseException("SQLCOLUMNBLOCK-ERROR", "column '%s' has %d value(s), but column '%s' has %d "
+                "value(s); all columns must have the same number of values", hi.getKey(), (int)l->size(),
+                rv->priv->cols[0]->name.c_str(), (int)rv->size());
+            return nullptr;
+        }
+
+        const QoreEncoding* enc;
+        sql_column_type_e type = get_column_type(l, enc);
+        int col = rv->addColumn(hi.getKey(), type, enc, xsink);
+        if (col < 0)
+            return nullptr;
+        sql_column_block_column& c = *rv->priv->cols[col];
+        c.reserve(l->size());
+
+        ConstListIterator li(l);
+        while (li.next()) {
+            const QoreValue lv = li.getValue();
+            if (lv.getType() == NT_NULL) {
+                c.appendNull();
+                continue;
+            }
+            switch (type) {
+                case SQL_COL_INT:
+                    rv->appendInt(col, lv.getAsBigInt());
+                    break;
+                case SQL_COL_FLOAT:
+                    rv->appendFloat(col, lv.getAsFloat());
+                    break;
+                case SQL_COL_BOOL:
+                    rv->appendBool(col, lv.getAsBool());
+                    break;
+                case SQL_COL_DATE: {
+                    const DateTimeNode* d = lv.get<const DateTimeNode>();
+                    rv->appendDate(col, d->getEpochSecondsUTC(), d->getMicrosecond(), d->getZone());
+                    break;
+                }
+                case SQL_COL_STRING: {
+                    const QoreStringNode* str = lv.get<const QoreStringNode>();
+                    rv->appendString(col, str->c_str(), str->size());
+                    break;
+                }
+                case SQL_COL_ANY:
+                    rv->appendValue(col, lv.refSelf());
+                    break;
+            }
+        }
+    }
+
+    return rv.release();
+}
+
+int QoreSQLColumnBlock::check(ExceptionSink* xsink) const {
+    size_t rows = size();
+    for (auto& i : priv->cols) {
+        if (i->size() != rows) {
+            xsink->raiseException("DBI-FETCH-BLOCK-ERROR", "column '%s' has %d value(s), but column '%s' has %d "
+                "value(s); the DBI driver must return the same number of values for each column", i->name.c_str(),
+                (int)i->size(), priv->cols[0]->name.c_str(), (int)rows);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int QoreSQLColumnBlock::getColumnIndex(const char* name, ExceptionSink* xsink) const {
+    int rv = priv->find(name);
+    if (rv < 0)
+        xsink->raiseException("SQLCOLUMNBLOCK-ERROR", "column '%s' does not exist in the block", name);
+    return rv;
+}
+
+int QoreSQLColumnBlock::checkRow(int64 row, ExceptionSink* xsink) const {
+    if (row < 0 || (size_t)row >= size()) {
+        xsink->raiseException("SQLCOLUMNBLOCK-ERROR", "row " QLLD " is out of range; the block has %d row(s)", row,
+            (int)size());
+        return -1;
+    }
+    return 0;
+}
+
+QoreListNode* QoreSQLColumnBlock::getColumnNames() const {
+    QoreListNode* rv = new QoreListNode(stringTypeInfo);
+    for (auto& i : priv->cols) {
+        rv->push(new QoreStringNode(i->name), nullptr);
+    }
+    return rv;
+}
+
+QoreHashNode* QoreSQLColumnBlock::getColumnTypes() const {
+    QoreHashNode* rv = new QoreHashNode(autoTypeInfo);
+    qore_hash_private* ph = qore_hash_private::get(*rv);
+    for (auto& i : priv->cols) {
+        ph->setKeyValueIntern(i->name.c_str(), new QoreStringNode(getTypeName(i->type)));
+    }
+    return rv;
+}
+
+QoreListNode* QoreSQLColumnBlock::getColumn(const char* name, ExceptionSink* xsink) const {
+    int col = getColumnIndex(name, xsink);
+    return col < 0 ? nullptr : priv->cols[col]->getList();
+}
+
+QoreHashNode* QoreSQLColumnBlock::getColumns() const {
+    QoreHashNode* rv = new QoreHashNode(autoTypeInfo);
+    qore_hash_private* ph = qore_hash_private::get(*rv);
+    for (auto& i : priv->cols) {
+        ph->setKeyValueIntern(i->name.c_str(), i->getList());
+    }
+    return rv;
+}
+
+QoreValue QoreSQLColumnBlock::getValue(const char* name, int64 row, ExceptionSink* xsink) const {
+    int col = getColumnIndex(name, xsink);
+    if (col < 0 || checkRow(row, xsink))
+        return QoreValue();
+    return priv->cols[col]->get(row);
+}
+
+QoreHashNode* QoreSQLColumnBlock::getRow(int64 row, ExceptionSink* xsink) const {
+    if (checkRow(row, xsink))
+        return nullptr;
+    QoreHashNode* rv = new QoreHashNode(autoTypeInfo);
+    qore_hash_private* ph = qore_hash_private::get(*rv);
+    for (auto& i : priv->cols) {
+        ph->setKeyValueIntern(i->name.c_str(), i->get(row));
+    }
+    return rv;
+}
+
+QoreListNode* QoreSQLColumnBlock::getRowValues(int64 row, ExceptionSink* xsink) const {
+    if (checkRow(row, xsink))
+        return nullptr;
+    QoreListNode* rv = new QoreListNode(autoTypeInfo);
+    for (auto& i : priv->cols) {
+        rv->push(i->get(row), nullptr);
+    }
+    return rv;
+}
+
+const char* QoreSQLColumnBlock::getTypeName(sql_column_type_e type) {
+    switch (type) {
+        case SQL_COL_INT: return "int";
+        case SQL_COL_FLOAT: return "float";
+        case SQL_COL_BOOL: return "bool";
+        case SQL_COL_DATE: return "date";
+        case SQL_COL_STRING: return "string";
+        case SQL_COL_ANY: return "auto";
+    }
+    return "auto";
+}
@@ -35,6 +35,7 @@
 #include "qore/intern/QoreClassIntern.h"
 #include "qore/intern/qore_program_private.h"
 #include "qore/intern/QoreNamespaceIntern.h"
+#include "qore/intern/QoreBytecode.h"
 #include <qore/minitest.hpp>
 
 #include <stdio.h>
@@ -177,7 +178,9 @@ QoreValue StatementBlock::exec(ExceptionSink* xsink) {
     QoreValue return_value;
     ThreadLocalProgramData* tlpd = get_thread_local_program_data();
     tlpd->dbgFunctionEnter(this, xsink);
-    execImpl(return_value, xsink);
+    // bytecode is not used when a debugger is attached so that breakpoints and stepping work on statements
+    if (!bc || tlpd->dbgIsAttached() || bc->exec(return_value, xsink))
+        execImpl(return_value, xsink);
     tlpd->dbgFunctionExit(this, return_value, xsink);
     return return_value;
 }
@@ -205,6 +208,11 @@ void StatementBlock::del() {
         delete lvars;
         lvars = nullptr;
     }
+
+    if (bc) {
+        delete bc;
+        bc = nullptr;
+    }
 }
 
 int StatementBlock::execImpl(QoreValue& return_value, ExceptionSink* xsink) {
@@ -455,6 +463,7 @@ void StatementBlock::parseInit(UserVariantBase* uvb) {
    parseInitImpl(nullptr);
 
    parseCheckReturn();
+   parseCompileBytecode(uvb);
 }
 
 void StatementBlock::parseCheckReturn() {
@@ -470,6 +479,16 @@ void StatementBlock::parseCheckReturn() {
    }
 }
 
+void StatementBlock::parseCompileBytecode(UserVariantBase* uvb) {
+   assert(!bc);
+   if (!(pwo.parse_options & PO_COMPILE_BYTECODE) || (pwo.parse_options & (PO_BROKEN_INT_ASSIGNMENTS|PO_BROKEN_LOOP_STATEMENT))
+      || qore_program_private::get(*getProgram())->parseExceptionRaised())
+      return;
+
+   bc = QoreBytecode::compile(this, uvb);
+   //printd(5, "StatementBlock::parseCompileBytecode() this: %p bc: %p\n", this, bc);
+}
+
 void StatementBlock::parseInitMethod(const QoreTypeInfo* typeInfo, UserVariantBase* uvb) {
    QORE_TRACE("StatementBlock::parseInitMethod");
 
@@ -481,6 +500,7 @@ void StatementBlock::parseInitMethod(const QoreTypeInfo* typeInfo, UserVariantBa
    parseInitImpl(uvb->getUserSignature()->selfid);
 
    parseCheckReturn();
+   parseCompileBytecode(uvb);
 }
 
 void StatementBlock::parseInitConstructor(const QoreTypeInfo* typeInfo, UserVariantBase* uvb, BCAList* bcal, const QoreClass& cls) {
@@ -517,6 +537,7 @@ void StatementBlock::parseInitClosure(UserVariantBase* uvb, UserClosureFunction*
    // initialize code block
    parseInitImpl(uvb->getUserSignature()->selfid);
    parseCheckReturn();
+   parseCompileBytecode(uvb);
 }
 
 void TopLevelStatementBlock::parseInit(int64 po) {
@@ -32,6 +32,7 @@
 
 #include <qore/intern/qore_encoding_private.h>
 #include <qore/intern/qore_string_private.h>
+#include <qore/intern/IconvHelper.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -68,6 +69,7 @@ encoding_map_t QoreEncodingManager::emap;
 const_encoding_map_t QoreEncodingManager::amap;
 QoreThreadLock QoreEncodingManager::mutex;
 QoreEncodingManager QEM;
+IconvPool qore_iconv_pool;
 
 QoreEncoding::QoreEncoding(const char* n_code, const char* n_desc, unsigned char n_minwidth, unsigned char n_maxwidth, mbcs_length_t l, mbcs_end_t e, mbcs_pos_t p, mbcs_charlen_t c, mbcs_get_unicode_t gu, bool n_ascii_compat) : code(n_code), desc(n_desc ? n_desc : ""), flength(l), fend(e), fpos(p), fcharlen(c), maxwidth(n_maxwidth), priv(new qore_encoding_private(n_minwidth, gu, n_ascii_compat)) {
 }
@@ -748,3 +750,32 @@ qore_offset_t q_get_char_len(const QoreEncoding* enc, const char* p, qore_size_t
    }
    return rc;
 }
+
+IconvPool::~IconvPool() {
+   for (auto& i : pool) {
+      for (auto& c : i.second)
+         iconv_close(c);
+   }
+}
+
+iconv_t IconvPool::get(const QoreEncoding* to, const QoreEncoding* from) {
+   AutoLocker al(m);
+   iconv_map_t::iterator i = pool.find(std::make_pair(to, from));
+   if (i == pool.end() || i->second.empty())
+      return (iconv_t)-1;
+   iconv_t c = i->second.back();
+   i->second.pop_back();
+   return c;
+}
+
+void IconvPool::put(const QoreEncoding* to, const QoreEncoding* from, iconv_t c) {
+   {
+      AutoLocker al(m);
+      std::vector<iconv_t>& v = pool[std::make_pair(to, from)];
+      if (v.size() < QORE_ICONV_POOL_MAX) {
+         v.push_back(c);
+         return;
+      }
+   }
+   iconv_close(c);
+}
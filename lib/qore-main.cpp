@@ -35,6 +35,7 @@
 
 #include "qore/intern/QoreSignal.h"
 #include "qore/intern/ModuleInfo.h"
+#include "qore/intern/ThreadPool.h"
 
 #include <vector>
 
@@ -185,6 +186,9 @@ void qore_cleanup() {
     // set shutdown flag for external modules
     qore_shutdown.store(true, std::memory_order_relaxed);
 
+    // stop the shared pool used for parallel list evaluation
+    qore_stop_shared_thread_pool();
+
     // purge thread resources before deleting modules
     {
         ExceptionSink xsink;
@@ -101,6 +101,12 @@
 #include "QoreNet.cpp"
 #include "QoreURL.cpp"
 #include "QoreFile.cpp"
+#include "QoreSlabAllocator.cpp"
+#include "QoreSubstringSearch.cpp"
+#include "QoreBiasedRefs.cpp"
+#include "QoreBytecode.cpp"
+#include "QoreCsvTokenizer.cpp"
+#include "QoreMemoryMap.cpp"
 #include "QoreDir.cpp"
 #include "QoreSocket.cpp"
 #include "DateTime.cpp"
@@ -134,6 +140,7 @@
 #include "ManagedDatasource.cpp"
 #include "SQLStatement.cpp"
 #include "QoreSQLStatement.cpp"
+#include "SQLColumnBlock.cpp"
 #include "ExecArgList.cpp"
 #include "CallReferenceNode.cpp"
 #include "NamedScope.cpp"
@@ -147,6 +154,8 @@
 #include "QoreQueueHelper.cpp"
 #include "QoreRegex.cpp"
 #include "QoreRegexBase.cpp"
+#include "QoreRegexCache.cpp"
+#include "QoreSocketPoller.cpp"
 #include "QoreRegexSubst.cpp"
 #include "QoreTransliteration.cpp"
 #include "Sequence.cpp"
@@ -266,6 +275,7 @@
 #include "qc_errno.cpp"
 #include "qc_qore.cpp"
 #include "QC_Socket.cpp"
+#include "QC_SocketPoller.cpp"
 #include "QC_ProgramControl.cpp"
 #include "QC_Program.cpp"
 #include "QC_DebugProgram.cpp"
@@ -309,6 +319,7 @@
 #include "QC_Datasource.cpp"
 #include "QC_DatasourcePool.cpp"
 #include "QC_SQLStatement.cpp"
+#include "QC_SQLColumnBlock.cpp"
 #include "QC_Queue.cpp"
 #include "QC_Mutex.cpp"
 #include "QC_Condition.cpp"
@@ -316,6 +327,7 @@
 #include "QC_Gate.cpp"
 #include "QC_Sequence.cpp"
 #include "QC_Counter.cpp"
+#include "QC_CsvTokenizer.cpp"
 #include "QC_SSLCertificate.cpp"
 #include "QC_SSLPrivateKey.cpp"
 #include "QC_HTTPClient.cpp"
@@ -60,6 +60,7 @@
 #include <sys/time.h>
 #include <assert.h>
 
+#include <chrono>
 #include <vector>
 #include <map>
 #include <set>
@@ -447,10 +448,9 @@ public:
 
 static QoreThreadLocalStorage<ThreadData> thread_data;
 
-void ThreadEntry::allocate(tid_node* tn, int stat) {
+void ThreadEntry::allocate(int stat) {
    assert(status == QTS_AVAIL);
    status = stat;
-   tidnode = tn;
 #ifdef QORE_RUNTIME_THREAD_STACK_TRACE
    assert(!callStack);
    callStack = new CallStack;
@@ -572,30 +572,6 @@ public:
    }
 };
 
-// this constructor must only be called with the QoreThreadList lock held
-tid_node::tid_node(int ntid) {
-   tid = ntid;
-   next = 0;
-   prev = thread_list.tid_tail;
-   if (!thread_list.tid_head)
-      thread_list.tid_head = this;
-   else
-      thread_list.tid_tail->next = this;
-   thread_list.tid_tail = this;
-}
-
-// this destructor must only be called with the QoreThreadList lock held
-tid_node::~tid_node() {
-   if (prev)
-      prev->next = next;
-   else
-      thread_list.tid_head = next;
-   if (next)
-      next->prev = prev;
-   else
-      thread_list.tid_tail = prev;
-}
-
 class BGThreadParams {
 private:
     // call_obj: get and reference the current stack object, if any, for the new call stack
@@ -846,8 +822,8 @@ void thread_ref_remove(const lvalue_ref* r) {
    td->ref_set.erase(r);
 }
 
-LocalVarValue* thread_instantiate_lvar() {
-   return thread_data.get()->tlpd->lvstack.instantiate();
+LocalVarValue* thread_instantiate_lvar(int& slot) {
+   return thread_data.get()->tlpd->lvstack.instantiate(slot);
 }
 
 void thread_uninstantiate_lvar(ExceptionSink* xsink) {
@@ -860,9 +836,9 @@ void thread_uninstantiate_self() {
    td->tlpd->lvstack.uninstantiateSelf();
 }
 
-LocalVarValue* thread_find_lvar(const char* id) {
+LocalVarValue* thread_find_lvar(const char* id, int slot) {
    ThreadData* td = thread_data.get();
-   return td->tlpd->lvstack.find(id);
+   return td->tlpd->lvstack.find(id, slot);
 }
 
 ClosureVarValue* thread_instantiate_closure_var(const char* n_id, const QoreTypeInfo* typeInfo, QoreValue& nval, bool assign) {
@@ -1990,7 +1966,7 @@ int q_reserve_foreign_thread_id() {
 }
 
 int q_release_reserved_foreign_thread_id(int tid) {
-   if (tid < 0 || tid >= MAX_QORE_THREADS)
+   if (!thread_list.validTid(tid))
       return -1;
 
    // release the thread entry
@@ -1998,7 +1974,7 @@ int q_release_reserved_foreign_thread_id(int tid) {
 }
 
 int q_register_reserved_foreign_thread(int tid) {
-   if (tid < 0 || tid >= MAX_QORE_THREADS)
+   if (!thread_list.validTid(tid))
       return -1;
 
    return thread_list.activateReserved(tid);
@@ -2221,7 +2197,7 @@ QoreValue do_op_background(const QoreValue left, ExceptionSink* xsink) {
 
     // if can't start thread, then throw exception
     if (tid == -1) {
-        xsink->raiseException("THREAD-CREATION-FAILURE", "thread list is full with %d threads", MAX_QORE_THREADS);
+        xsink->raiseException("THREAD-CREATION-FAILURE", "thread list is full with %d threads", thread_list.getMaxThreads());
         return QoreValue();
     }
 
@@ -2263,7 +2239,7 @@ int q_start_thread(ExceptionSink* xsink, q_thread_t f, void* arg) {
 
    // if can't start thread, then throw exception
    if (tid == -1) {
-      xsink->raiseException("THREAD-CREATION-FAILURE", "thread list is full with %d threads", MAX_QORE_THREADS);
+      xsink->raiseException("THREAD-CREATION-FAILURE", "thread list is full with %d threads", thread_list.getMaxThreads());
       return -1;
    }
 
@@ -2527,8 +2503,8 @@ QoreHashNode* QoreThreadList::getAllCallStacks() {
 
    while (i.next()) {
       // get call stack
-      if (entry[*i].callStack) {
-         QoreListNode* l = entry[*i].callStack->getCallStack();
+      if (getEntry(*i).callStack) {
+         QoreListNode* l = getEntry(*i).callStack->getCallStack();
          if (!l->empty()) {
             // make hash entry
             str.clear();
@@ -2545,10 +2521,7 @@ QoreHashNode* QoreThreadList::getAllCallStacks() {
 #endif
 
 void ThreadEntry::cleanup() {
-   //printf("ThreadEntry::cleanup() TID %d\n", tidnode ? tidnode->tid : 0);
    assert(status != QTS_AVAIL);
-   // delete tidnode from tid_list
-   delete tidnode;
 
 #ifdef QORE_RUNTIME_THREAD_STACK_TRACE
    // delete call stack
@@ -2568,13 +2541,94 @@ void ThreadEntry::cleanup() {
    status = QTS_AVAIL;
 }
 
+QoreThreadList::QoreThreadList() : exiting(false) {
+   for (unsigned i = 0; i < QORE_THREAD_SEGMENTS; ++i)
+      segment[i] = nullptr;
+   // the first segment is always allocated; TID 0 is reserved for the signal handling thread
+   grow();
+}
+
+int QoreThreadList::grow() {
+   AutoLocker al(grow_lock);
+   int cap = capacity.load(std::memory_order_acquire);
+   // another thread has already added a segment with unused TIDs
+   if (current_tid.load(std::memory_order_acquire) < cap)
+      return 0;
+   if (cap >= MAX_QORE_THREADS)
+      return -1;
+
+   segment[cap >> QORE_THREAD_SEGMENT_BITS].store(new ThreadEntry[QORE_THREAD_SEGMENT_SIZE],
+      std::memory_order_release);
+   cap += QORE_THREAD_SEGMENT_SIZE;
+   if (cap > MAX_QORE_THREADS)
+      cap = MAX_QORE_THREADS;
+   capacity.store(cap, std::memory_order_release);
+   return 0;
+}
+
+int QoreThreadList::allocateTid() {
+   while (true) {
+      // issue a TID that has never been used from an allocated segment
+      int tid = current_tid.load(std::memory_order_relaxed);
+      while (tid < capacity.load(std::memory_order_acquire)) {
+         if (current_tid.compare_exchange_weak(tid, tid + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+            return tid;
+      }
+
+      // reuse a released TID
+      tid = popFree();
+      if (tid > 0)
+         return tid;
+
+      // allocate a new segment
+      if (grow())
+         return -1;
+   }
+}
+
+int QoreThreadList::get(int status) {
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   int tid = allocateTid();
+   if (tid == -1)
+      return -1;
+
+   getEntry(tid).allocate(status);
+
+   unsigned n = ++num_threads;
+   unsigned peak = peak_threads.load(std::memory_order_relaxed);
+   while (n > peak && !peak_threads.compare_exchange_weak(peak, n, std::memory_order_relaxed)) {
+   }
+
+   int64 ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()
+      - start).count();
+   ++allocations;
+   alloc_total_ns += ns;
+   int64 max = alloc_max_ns.load(std::memory_order_relaxed);
+   while (ns > max && !alloc_max_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+   }
+   //printf("t%d cs=0\n", tid);
+
+   return tid;
+}
+
+void QoreThreadList::getInfo(QoreThreadListInfo& info) const {
+   info.threads = num_threads;
+   info.peak = peak_threads;
+   info.capacity = capacity;
+   info.max = MAX_QORE_THREADS;
+   info.allocations = allocations;
+   info.alloc_total_ns = alloc_total_ns;
+   info.alloc_max_ns = alloc_max_ns;
+}
+
 void QoreThreadList::deleteData(int tid) {
    delete thread_data.get();
    thread_data.set(0);
 
 #ifdef DEBUG
    AutoLocker al(l);
-   entry[tid].thread_data = 0;
+   getEntry(tid).thread_data = 0;
 #endif
 }
 
@@ -2584,7 +2638,7 @@ void QoreThreadList::deleteDataRelease(int tid) {
 
    AutoLocker al(l);
 #ifdef DEBUG
-   entry[tid].thread_data = 0;
+   getEntry(tid).thread_data = 0;
 #endif
 
    releaseIntern(tid);
@@ -2608,13 +2662,13 @@ unsigned QoreThreadList::cancelAllActiveThreads() {
 
    while (i.next()) {
       if (*i != (unsigned)tid) {
-         //printf("QoreThreadList::cancelAllActiveThreads() canceling TID %d ptid: %p (this TID: %d)\n", *i, entry[*i].ptid, tid);
-         int trc = pthread_cancel(entry[*i].ptid);
+         //printf("QoreThreadList::cancelAllActiveThreads() canceling TID %d ptid: %p (this TID: %d)\n", *i, getEntry(*i).ptid, tid);
+         int trc = pthread_cancel(getEntry(*i).ptid);
          if (!trc)
             ++tcc;
 #ifdef DEBUG
          else
-            printd(0, "pthread_cancel() returned %d (%s) on tid %d (%p)\n", trc, strerror(trc), tid, entry[*i].ptid);
+            printd(0, "pthread_cancel() returned %d (%s) on tid %d (%p)\n", trc, strerror(trc), tid, getEntry(*i).ptid);
 #endif
       }
    }
@@ -2624,14 +2678,14 @@ unsigned QoreThreadList::cancelAllActiveThreads() {
 
 #ifdef QORE_RUNTIME_THREAD_STACK_TRACE
 void QoreThreadList::pushCall(CallNode* cn) {
-   entry[gettid()].callStack->push(cn);
+   getEntry(gettid()).callStack->push(cn);
 }
 
 void QoreThreadList::popCall(ExceptionSink* xsink) {
-   entry[gettid()].callStack->pop(xsink);
+   getEntry(gettid()).callStack->pop(xsink);
 }
 
 QoreListNode* QoreThreadList::getCallStackList() {
-   return entry[gettid()].callStack->getCallStack();
+   return getEntry(gettid()).callStack->getCallStack();
 }
 #endif
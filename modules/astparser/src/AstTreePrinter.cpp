@@ -801,6 +801,7 @@ void AstTreePrinter::printParseOptionString(std::ostream& os, ASTParseOption* po
         case APOK_BROKEN_LOOP_STATEMENT: os << "BROKEN_LOOP_STATEMENT"; break;
         case APOK_BROKEN_OPERATORS: os << "BROKEN_OPERATORS"; break;
         case APOK_BROKEN_REFERENCES: os << "BROKEN_REFERENCES"; break;
+        case APOK_COMPILE_BYTECODE: os << "COMPILE_BYTECODE"; break;
         case APOK_DEFINE: os << "DEFINE"; break;
         case APOK_DISABLE_ALL_WARNINGS: os << "DISABLE_ALL_WARNINGS"; break;
         case APOK_DISABLE_WARNING: os << "DISABLE_WARNING"; break;
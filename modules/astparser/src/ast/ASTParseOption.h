@@ -52,6 +52,7 @@ enum ASTParseOptionKind {
     APOK_BROKEN_LOOP_STATEMENT,
     APOK_BROKEN_OPERATORS,
     APOK_BROKEN_REFERENCES,
+    APOK_COMPILE_BYTECODE,
     APOK_CORRECT_INT_ASSIGNMENTS,
     APOK_CORRECT_LIST_PARSING,
     APOK_CORRECT_LOGIC_PRECEDENCE,